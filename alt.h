@@ -0,0 +1,188 @@
+#pragma once
+#include "line.h"
+#include "grid.h"
+
+/*  ALT: A*, LANDMARKS AND THE TRIANGLE INEQUALITY
+ *  For any tile L, d(n,goal) >= |d(L,goal) - d(L,n)|, so a table of the true distances from a few tiles (the
+ *  landmarks) to every other tile gives a lower bound that knows about walls, which Manhattan distance doesn't.
+ *  The bound is tightest for queries that head away from or towards a landmark, so the landmarks are spread
+ *  out to the far corners of the map: each one is the tile farthest from the landmarks picked before it.
+ */
+
+#define ALT_LANDMARKS 8 // landmarks per map; each one costs 2 bytes per tile
+#define ALT_UNREACHABLE 0xFFFF // distance from a landmark to a tile it can't reach
+#define ALT_FAR 0xFFFE // longer distances are stored as this; clamping keeps the bound a lower bound
+#define ALT_MAGIC 0x31544C41 // "ALT1", first 4 bytes of a saved table
+
+bool reserveLandmarks(Grid * grid, unsigned int count);
+void landmarkBFS(Grid * grid, size_t root, uint16_t * dist, unsigned int stride, int32_t * queue);
+int landmarkBound(Grid * grid, const uint16_t * goalDist, unsigned int x, unsigned int y);
+bool saveLandmarks(Grid * grid, const char * filename);
+bool loadLandmarks(Grid * grid, const char * filename);
+
+/*
+ * reserveLandmarks() - picks count landmarks and builds the ALT table of the grid if it isn't there yet; returns
+ *                      false if there isn't enough memory
+ *                    - the first landmark is the tile farthest from the first open tile, and every next one the
+ *                      tile farthest from all landmarks so far; a tile none of them can reach counts as farthest,
+ *                      so every part of a split map gets a landmark of its own as long as there are enough
+ *                    - one BFS over the map per landmark, so O(count * Width * Height)
+ */
+bool reserveLandmarks(Grid * grid, unsigned int count)
+{
+    size_t cells = (size_t)grid->Width * grid->Height;
+    size_t cell, far;
+    unsigned int k;
+    if (grid->Landmarks != NULL) return true;
+    grid->Landmarks = AllocateAligned(cells * count * sizeof(uint16_t));
+    int32_t * queue = malloc(cells * sizeof(int32_t));
+    uint16_t * nearest = malloc(cells * sizeof(uint16_t)); // distance from each tile to the closest landmark so far
+    if (grid->Landmarks == NULL || queue == NULL || nearest == NULL)
+    {
+        free(grid->Landmarks);
+        free(queue);
+        free(nearest);
+        grid->Landmarks = NULL;
+        return false;
+    }
+    grid->LandmarkCount = count;
+    far = 0;
+    while (far < cells && grid->Blocked[far]) far++; // First open tile
+    if (far == cells) // Nothing but walls; every bound is 0
+    {
+        memset(grid->Landmarks, 0xFF, cells * count * sizeof(uint16_t));
+        free(queue);
+        free(nearest);
+        return true;
+    }
+    landmarkBFS(grid, far, nearest, 1, queue);
+    for (cell = 0; cell < cells; cell++)
+    {
+        if (nearest[cell] != ALT_UNREACHABLE && nearest[cell] > nearest[far]) far = cell;
+    }
+    memset(nearest, 0xFF, cells * sizeof(uint16_t)); // No landmarks yet, so every tile is as far as can be
+    for (k = 0; k < count; k++)
+    {
+        landmarkBFS(grid, far, grid->Landmarks + k, count, queue);
+        for (cell = 0; cell < cells; cell++)
+        {
+            uint16_t d = grid->Landmarks[cell * count + k];
+            if (d < nearest[cell]) nearest[cell] = d;
+        }
+        // The next landmark goes to the open tile farthest from all of them (landmarks themselves are at 0)
+        for (cell = 0; cell < cells; cell++)
+        {
+            if (!grid->Blocked[cell] && nearest[cell] > nearest[far]) far = cell;
+        }
+    }
+    free(queue);
+    free(nearest);
+    return true;
+}
+
+/*
+ * landmarkBFS() - writes the distance from root to every tile into dist[cell * stride], ALT_UNREACHABLE for tiles
+ *                 it can't reach; queue must have room for every tile
+ */
+void landmarkBFS(Grid * grid, size_t root, uint16_t * dist, unsigned int stride, int32_t * queue)
+{
+    size_t cells = (size_t)grid->Width * grid->Height;
+    size_t head = 0, tail = 0, cell;
+    unsigned int W = grid->Width;
+    for (cell = 0; cell < cells; cell++)
+    {
+        dist[cell * stride] = ALT_UNREACHABLE;
+    }
+    dist[root * stride] = 0;
+    queue[tail++] = root;
+    while (head < tail)
+    {
+        size_t u = queue[head++];
+        unsigned int x = u % W;
+        uint16_t d = dist[u * stride];
+        uint16_t next = (d < ALT_FAR) ? d + 1 : ALT_FAR;
+        size_t v[4];
+        int n = 0, i;
+        if (x + 1 < W) v[n++] = u + 1;
+        if (x > 0) v[n++] = u - 1;
+        if (u >= W) v[n++] = u - W;
+        if (u + W < cells) v[n++] = u + W;
+        for (i = 0; i < n; i++)
+        {
+            if (grid->Blocked[v[i]] || dist[v[i] * stride] != ALT_UNREACHABLE) continue;
+            dist[v[i] * stride] = next;
+            queue[tail++] = v[i];
+        }
+    }
+}
+
+/*
+ * landmarkBound() - the best ALT lower bound on the distance from (x,y) to the tile whose row of the table is
+ *                   goalDist; landmarks that can't reach both tiles are skipped
+ */
+int landmarkBound(Grid * grid, const uint16_t * goalDist, unsigned int x, unsigned int y)
+{
+    const uint16_t * dist = grid->Landmarks + ((size_t)y * grid->Width + x) * grid->LandmarkCount;
+    int best = 0;
+    unsigned int k;
+    for (k = 0; k < grid->LandmarkCount; k++)
+    {
+        if (dist[k] == ALT_UNREACHABLE || goalDist[k] == ALT_UNREACHABLE) continue;
+        int bound = (int)dist[k] - (int)goalDist[k];
+        if (bound < 0) bound = -bound;
+        if (bound > best) best = bound;
+    }
+    return best;
+}
+
+/*
+ * saveLandmarks() - writes the grid's ALT table to a file, tagged with the map's hash so that loadLandmarks()
+ *                   can tell when the map has changed; returns false if the file couldn't be written
+ */
+bool saveLandmarks(Grid * grid, const char * filename)
+{
+    uint32_t header[4] = {ALT_MAGIC, grid->Width, grid->Height, grid->LandmarkCount};
+    uint64_t hash = HashGrid(grid);
+    size_t entries = (size_t)grid->Width * grid->Height * grid->LandmarkCount;
+    FILE * file = fopen(filename, "wb");
+    if (file == NULL) return false;
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1
+        && fwrite(&hash, sizeof(hash), 1, file) == 1
+        && fwrite(grid->Landmarks, sizeof(uint16_t), entries, file) == entries;
+    if (fclose(file) != 0) ok = false;
+    if (!ok) remove(filename); // Don't leave half a table behind
+    return ok;
+}
+
+/*
+ * loadLandmarks() - reads an ALT table saved by saveLandmarks() into the grid, if the grid doesn't have one yet
+ *                 - returns false, leaving the grid as it was, if the file can't be read or was saved for a
+ *                   different map
+ */
+bool loadLandmarks(Grid * grid, const char * filename)
+{
+    uint32_t header[4];
+    uint64_t hash;
+    if (grid->Landmarks != NULL) return true;
+    FILE * file = fopen(filename, "rb");
+    if (file == NULL) return false;
+    if (fread(header, sizeof(header), 1, file) != 1 || fread(&hash, sizeof(hash), 1, file) != 1
+        || header[0] != ALT_MAGIC || header[1] != grid->Width || header[2] != grid->Height || header[3] == 0
+        || hash != HashGrid(grid))
+    {
+        fclose(file);
+        return false;
+    }
+    size_t entries = (size_t)grid->Width * grid->Height * header[3];
+    uint16_t * table = AllocateAligned(entries * sizeof(uint16_t));
+    if (table == NULL || fread(table, sizeof(uint16_t), entries, file) != entries)
+    {
+        free(table);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    grid->Landmarks = table;
+    grid->LandmarkCount = header[3];
+    return true;
+}
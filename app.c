@@ -1,701 +1,1009 @@
+//#define DEBUG
+//#define PROFILE // Phase timings, fringe counters and --trace; see profile.h
 #include "cardinal.h"
 #include "polygon.h"
-#include "queue.h"
-#include "stack.h"
-#include "slist.h"
+#include "raster.h"
+#include "grid.h"
+#include "search.h"
+#include "executor.h"
+#include "pbfs.h"
+#include "mapfile.h"
+#include "scanner.h"
 #include <time.h> // clock_t, clock(), CLOCKS_PER_SEC
+#include <unistd.h> // sysconf()
 
-#define H 200
-#define W 400
-//#define DEBUG
-
-// Tile states
-#define BLOCKED 1
-#define CURRENT 2
-#define EXPLORED 3
-#define QUEUED 4
-#define UNEXPLORED 5
-#define GOAL 6
-#define INSIDE_PATH 7
-
-// Search strategies
-#define STRAT_BFS 1
-#define STRAT_DFS 2
-#define STRAT_ASTAR 3
+#define RASTER_MODE RASTER_OUTLINE // RASTER_FILLED also blocks the inside of each polygon
 
 #define STRINGMAX 100
 
 // Error codes
 #define ERR_INPUTFILE_CANNOTOPEN 404
-
-// Global variables
-int grid[H][W];
-coordinate pred[H][W]; // Used to keep track of the traversal
-//pred[i][j] = (x,y) means that (i,j) comes after (x,y) in our path
-int f_n[H][W]; // For A* search only - keeps track of f(n) values
-
-void setTile(unsigned int x, unsigned int y, unsigned int s);
-unsigned int getTile(unsigned int x, unsigned int y);
-void setPred(unsigned int x, unsigned int y, unsigned int px, unsigned int py);
-coordinate getPred(unsigned int x, unsigned int y);
-void setF(unsigned int x, unsigned int y, int f);
-int getF(unsigned int x, unsigned int y);
-coordinate teleport(coordinate current, coordinate target);
-void drawGrid();
-int absval(int x);
-void BFS(Queue * fringe, coordinate current);
-void DFS(Stack * fringe, coordinate current);
-int h(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
-void Astar(SortedList * fringe, coordinate current, unsigned int g, coordinate goal);
-
-int main()
+#define ERR_INPUTFILE_BADFORMAT 400
+#define ERR_OUTOFMEMORY 507
+#define ERR_USAGE 422 // Unknown option, or an option without its value
+
+// Output formats of a single query (--format)
+#define FORMAT_TEXT 0 // The report, as in interactive mode
+#define FORMAT_CSV 1 // A header line, then one line with the result and the path
+#define FORMAT_JSON 2 // One object with the result and the path
+
+Grid * loadMap(FILE * inputFile, const char * inputFilename, coordinate * start, coordinate * goal, bool echo,
+    double * readRate);
+Grid * loadCompiledMap(FILE * inputFile, const char * inputFilename, coordinate * start, coordinate * goal, bool echo);
+uint64_t mapSourceHash(FILE * inputFile);
+int compileMap(const char * mapFilename, const char * outputFilename, bool landmarks);
+bool insideGrid(Grid * grid, coordinate c);
+int parseFormat(const char * name);
+void printReport(SearchContext * ctx, int strategy, coordinate start, coordinate goal, SearchResult * result, uint64_t nanoseconds);
+void printRecord(int format, const char * mapFilename, int strategy, int fringeType, coordinate start, coordinate goal,
+    SearchResult * result, uint64_t nanoseconds, double readRate);
+void printQuoted(const char * s, int format);
+int runBatch(const char * mapFilename, const char * queryFilename, unsigned int threads, unsigned int scaling,
+    const char * traceFilename);
+char * siblingFilename(const char * filename, const char * suffix);
+bool sameFile(const char * a, const char * b);
+void prepareLandmarks(Grid * grid, const char * mapFilename, FILE * log);
+void prepareHierarchy(Grid * grid, FILE * log);
+void prepareVisibility(Grid * grid, FILE * log);
+void reportSuboptimality(Grid * grid, BatchQuery * queries, unsigned int count, unsigned int threads);
+void reportProfile(const char * traceFilename, FILE * log);
+void usageError(const char * program, const char * argument);
+
+int main(int argc, char * argv[])
 {
-    printf("\n=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+\n");
-	printf("    2D Path Finding w/ Search || CS 180 Machine Problem 1\n");
-	printf(" Vincent Paul F. Fiestada | 201369155 | vffiestada@up.edu.ph\n");
-	printf("=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+\n");
-    #ifdef DEBUG
-        printf("\n\n ------- DEBUG Mode ------\n\n");
-    #endif
-
-    // Declare iterators
-    unsigned int i,j,k;
-
-    // Create grid
-    for (i = 0; i < H; i++)
+    // Batch mode: app --batch map.txt [queries.txt] [--threads N] [--scaling N] [--trace trace.json]
+    if (argc >= 3 && strcmp(argv[1], "--batch") == 0)
     {
-        for (j = 0; j < W; j++)
+        const char * queryFilename = NULL;
+        const char * traceFilename = NULL;
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        unsigned int threads = (cores > 0) ? cores : 1; // every core by default
+        unsigned int scaling = 0;
+        int a;
+        for (a = 3; a < argc; a++)
         {
-            grid[i][j] = UNEXPLORED;
-            // Set all predecessors to (-1,-1) (i.e., not part of the discovered path)
-            setPred(j, i, -1, -1);
+            if (strcmp(argv[a], "--threads") == 0 && a + 1 < argc) threads = atoi(argv[++a]);
+            else if (strcmp(argv[a], "--scaling") == 0 && a + 1 < argc) scaling = atoi(argv[++a]);
+            else if (strcmp(argv[a], "--trace") == 0 && a + 1 < argc) traceFilename = argv[++a];
+            else if (strncmp(argv[a], "--", 2) != 0 && queryFilename == NULL) queryFilename = argv[a];
+            else usageError(argv[0], argv[a]);
         }
+        return runBatch(argv[2], queryFilename, (threads > 0) ? threads : 1, scaling, traceFilename);
     }
+    // Compile mode: app --compile map.txt [map.bin] [--landmarks]
+    if (argc >= 3 && strcmp(argv[1], "--compile") == 0)
+    {
+        const char * outputFilename = NULL;
+        bool landmarks = false;
+        int a;
+        for (a = 3; a < argc; a++)
+        {
+            if (strcmp(argv[a], "--landmarks") == 0) landmarks = true;
+            else if (strncmp(argv[a], "--", 2) != 0 && outputFilename == NULL) outputFilename = argv[a];
+            else usageError(argv[0], argv[a]);
+        }
+        return compileMap(argv[2], outputFilename, landmarks);
+    }
+
+    // Single query: app --map map.txt [--strategy N] [--fringe N] [--format text|csv|json] [--trace trace.json];
+    // without --map, the map, strategy and fringe are asked for
+    const char * mapFilename = NULL;
+    const char * traceFilename = NULL;
+    int strategy = STRAT_ASTAR; // 'Other' in the menu
+    int fringeType = FRINGE_BUCKET;
+    int format = FORMAT_TEXT;
+    int a;
+    for (a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--map") == 0 && a + 1 < argc) mapFilename = argv[++a];
+        else if (strcmp(argv[a], "--strategy") == 0 && a + 1 < argc) strategy = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--fringe") == 0 && a + 1 < argc) fringeType = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--format") == 0 && a + 1 < argc && (format = parseFormat(argv[++a])) >= 0) continue;
+        else if (strcmp(argv[a], "--trace") == 0 && a + 1 < argc) traceFilename = argv[++a];
+        else usageError(argv[0], argv[a]);
+    }
+    bool interactive = (mapFilename == NULL);
+    bool text = (format == FORMAT_TEXT);
+    FILE * log = text ? stdout : stderr; // What the strategies print while they get ready
+
+    if (interactive)
+    {
+        printf("\n=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+\n");
+        printf("    2D Path Finding w/ Search || CS 180 Machine Problem 1\n");
+        printf(" Vincent Paul F. Fiestada | 201369155 | vffiestada@up.edu.ph\n");
+        printf("=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+\n");
+    }
+    #ifdef DEBUG
+        printf("\n\n ------- DEBUG Mode ------\n\n");
+    #endif
 
     // Open and parse input file
-    // Get input file's filename
     char inputFilename[STRINGMAX] = "";
-    printf("\nInput Filename (Max %d characters): ", STRINGMAX - 1);
-    scanf("%s", &inputFilename);
-    printf("\nOpening file '%s'...", inputFilename);
-    printf("\n--------------------------------\n");
+    if (interactive)
+    {
+        // Get input file's filename
+        char filenameFormat[16];
+        snprintf(filenameFormat, sizeof(filenameFormat), "%%%ds", STRINGMAX - 1); // "%99s"; the rest is left unread
+        printf("\nInput Filename (Max %d characters): ", STRINGMAX - 1);
+        scanf(filenameFormat, inputFilename);
+        mapFilename = inputFilename;
+    }
+    if (text)
+    {
+        printf("\nOpening file '%s'...", mapFilename);
+        printf("\n--------------------------------\n");
+    }
 
-    FILE * inputFile = fopen(inputFilename, "r");
+    FILE * inputFile = fopen(mapFilename, "r");
     if (inputFile == NULL) // If inputFile is null, then the stream couldn't be opened; report error
 	{
-		fprintf(stderr,"\nFATAL ERROR!\nFailed to open '%s'. ", inputFilename);
+		fprintf(stderr,"\nFATAL ERROR!\nFailed to open '%s'. ", mapFilename);
 		exit(ERR_INPUTFILE_CANNOTOPEN); // exit with appropriate error code
 	}
     // Set starting point and goal
     coordinate current;
     coordinate goal;
-
-    fscanf(inputFile, "%d %d %d %d", &(current.x), &(current.y), &(goal.x), &(goal.y));
-    setTile(current.x, current.y, CURRENT);
-    setTile(goal.x, goal.y, GOAL);
-
-    printf("\nFind Path from (%d, %d) to (%d, %d).", current.x, current.y, goal.x, goal.y);
-    printf("\nObstacles:\n");
-    unsigned int tempInt;
-    while (fscanf(inputFile, "%d", &tempInt) > 0) // Number of vertices for this polygon
+    double readRate;
+    Grid * grid = loadMap(inputFile, mapFilename, &current, &goal, text, &readRate);
+    // Create the state of the search on the map
+    SearchContext * ctx = createSearchContext(grid);
+    if (ctx == NULL)
     {
-        /*  FORMAT OF POLYGONS
-         *  number_of_vertices x1 y1 x2 y2 ...
-         */
-         // Get coordinates of vertices
-        coordinate vertices[tempInt];
-        for (i = 0; i < tempInt; i++)
-        {
-            fscanf(inputFile, "%d %d", &(vertices[i].x), &(vertices[i].y));
-        }
-        /* >>>>>>>>> Create Polyon >>>>>>>> */
-        // Determines lines/edges
-        line e[tempInt];
-        for (i = 0; i < tempInt; i++)
-        {
-            coordinate nv; // Get next vertex
-            if (i < tempInt - 1)
-            {
-                nv.x = vertices[i+1].x;
-                nv.y = vertices[i+1].y;
-            }
-            else
-            {
-                nv.x = vertices[0].x;
-                nv.y = vertices[0].y;
-            }
-            e[i].m = getSlope(vertices[i], nv);
-            e[i].b = getYIntercept(vertices[i], e[i].m);
-            e[i].x = -1; // The line is NOT vertical
-            // if the line is vertical, store the constant X because slope-intercept won't work
-            if (nv.x == vertices[i].x)
-            {
-                e[i].x = nv.x;
-            }
-            e[i].one.x = vertices[i].x;
-            e[i].one.y = vertices[i].y;
-            e[i].two.x = nv.x;
-            e[i].two.y = nv.y;
-        }
-        // Create new polygon
-        polygon p;
-        p.edges = e;
-        // >>  Set blocked tiles <<
-        // For each point,
-        for (i = 0; i < H; i++)
-        {
-            for (j = 0; j < W; j++)
-            {
-                // For each edge of the polygon
-                for (k = 0; k < tempInt; k++)
-                {
-                    coordinate c;
-                    c.x = j;
-                    c.y = i;
-                    line e = p.edges[k];
-                    if (inLine(c, &(e)))
-                    {
-                        grid[i][j] = BLOCKED;
-                        break;
-                    }
-                }
-            }
-        }
-        // Print obstacle vertices
-        for (i = 0; i < tempInt; i++)
-        {
-            printf("(%d %d) ", vertices[i].x, vertices[i].y);
-        }
-        printf("\n");
+        fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for a %u x %u map. ", grid->Width, grid->Height);
+        exit(ERR_OUTOFMEMORY);
     }
 
-    // Close input file
-    fclose(inputFile);
-
     #ifdef DEBUG
-        drawGrid();
+        beginSearch(ctx, current, goal);
+        drawGrid(ctx);
     #endif
 
-    int strategy;
-    printf("\nChoose a Search Strategy\n1 - BFS\n2 - DFS\nOther - A* Search\n>>> Enter Choice: ");
-    scanf("%d", &strategy);
-
-    printf("\nStarting Search...\n");
-    int expanded_count = 0; // Count expanded nodes
-    clock_t t = clock(); // For keeping track of running time
-    if (strategy == STRAT_BFS)
+    if (interactive)
     {
-        // Create fringe queue
-        Queue * fringe = CreateNewQueue();
-        do
-        {
-            // Check if we've found the goal
-            if (getTile(current.x, current.y) == GOAL)
-            {
-                break;
-            }
-            BFS(fringe, current);
-            expanded_count++; // Expanded 1 more node
-            // If fringe is nonempty, advance to next tile in the fringe queue
-            if (fringe->Head != NULL)
-            {
-                // We're gonna move from current to the target tile
-                coordinate target = Dequeue(fringe);
-                current = teleport(current, target);
-            }
-            else
-            {
-                printf("\n\n <!> No solution path found.");
-                break;
-            }
-        } while(1);
-
-        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-           CLEAN UP: Delete dynamically allocated objs
-          <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< */
-
-        AnnihilateQueue(fringe);
-
+        printf("\nChoose a Search Strategy\n1 - BFS\n2 - DFS\n4 - Jump Point Search\n5 - JPS+ (precomputed jumps)\n6 - Bidirectional BFS\n7 - Bidirectional A*\n8 - A* with landmarks (ALT)\n9 - Hierarchical A* (HPA*)\n10 - Visibility graph (any-angle waypoints)\nOther - A* Search\n>>> Enter Choice: ");
+        scanf("%d", &strategy);
     }
-    else if (strategy == STRAT_DFS)
+    if (strategy == STRAT_JPS)
     {
-        // Create fringe stack
-        Stack * fringe = CreateNewStack();
-        do
+        PROFILE_START(prepared);
+        if (!reserveOpenBits(grid))
         {
-            // Check if we've found the goal
-            if (getTile(current.x, current.y) == GOAL)
-            {
-                break;
-            }
-            DFS(fringe, current);
-            expanded_count++; // Expanded 1 more node
-            // If fringe is not empty, move to next node in stack
-            if (fringe->Top != NULL)
-            {
-                coordinate target = PopFromStack(fringe);
-                current = teleport(current, target);
-            }
-            else
-            {
-                printf("\n\n <!> No solution path found.");
-                break;
-            }
-        } while(1);
-
-        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-           CLEAN UP: Delete dynamically allocated objs
-          <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< */
-
-        AnnihilateStack(fringe);
+            fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for JPS on a %u x %u map. ", grid->Width, grid->Height);
+            exit(ERR_OUTOFMEMORY);
+        }
+        PROFILE_STOP(prepared, PROFILE_PREPARE);
     }
-    else // Use A* as default strategy
+    if (strategy == STRAT_JPS_PLUS)
     {
-        // Create fringe sorted doubly linked list
-        SortedList * fringe = CreateNewSortedList();
-        do
+        clock_t jt = clock();
+        PROFILE_START(prepared);
+        if (!reserveJumpTable(grid))
         {
-            // Check if we've found the goal
-            if (getTile(current.x, current.y) == GOAL)
-            {
-                break;
-            }
-            // Get A* search successors (automagically sorted)
-            // i = current level - 1 = g(n)
-            Astar(fringe, current, i, goal);
-            expanded_count++;
-            // If fringe is nonempty, advance to next tile in the fringe
-            #ifdef DEBUG
-                Node * n = fringe->Head;
-                printf("\n\n$ Fringe: ");
-                while(n != NULL)
-                {
-                    printf("(%d %d) ", n->Data.x, n->Data.y);
-                    n = n->Next;
-                }
-            #endif
-
-            if (fringe->Head != NULL)
-            {
-                // We're gonna move from current to the target tile
-                // Get new level (pop will discard everything except the coordinates)
-                i = fringe->Head->g;
-                coordinate target = PopFromSortedList(fringe);
-                current = teleport(current, target);
-            }
-            else
-            {
-                printf("\n\n <!> No solution path found.");
-                break;
-            }
-        } while(1);
-
-        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-           CLEAN UP: Delete dynamically allocated objs
-          <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< */
-
-        AnnihilateSortedList(fringe);
-
+            fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for JPS+ on a %u x %u map. ", grid->Width, grid->Height);
+            exit(ERR_OUTOFMEMORY);
+        }
+        PROFILE_STOP(prepared, PROFILE_PREPARE);
+        fprintf(log, "\nJump table built in %f s\n", ((float)(clock() - jt))/CLOCKS_PER_SEC);
     }
-    // Build the path by tracing back our footsteps
-    Stack * path = CreateNewStack();
-    // Push into the stack the final tile, which is the goal (also the current) tile
-    PushToStack(path, current.x, current.y);
-    while(1)
+    if (strategy == STRAT_ALT)
     {
-        // Get predecessor of current top of stack
-        coordinate p = getPred(path->Top->Data.x, path->Top->Data.y);
-        if (p.x == -1 || p.y == -1) break;
-        PushToStack(path, p.x, p.y);
+        fprintf(log, "\n");
+        prepareLandmarks(grid, mapFilename, log);
     }
-    // Get number of clock ticks since last check to detection of final soln
-    t = clock() - t;
-    #ifdef DEBUG
-        drawGrid();
-    #endif
-    printf("\n--------------------------------------------------\n");
-    printf("Final Location is (%d, %d)", current.x, current.y);
-    if (getTile(current.x, current.y) == GOAL) printf(" which is a GOAL point.");
-    printf("\n\n");
-    printf("Traced Path ");
-    switch(strategy)
-    {
-        case STRAT_BFS:
-            printf("(BFS): ");
-            break;
-        case STRAT_DFS:
-            printf("(DFS): ");
-            break;
-        default:
-            printf("(A*): ");
+    if (strategy == STRAT_HPA)
+    {
+        fprintf(log, "\n");
+        prepareHierarchy(grid, log);
     }
-    PrintStack(path);
-    printf("\n\n*Includes initial and final positions.");
+    if (strategy == STRAT_VISIBILITY)
+    {
+        fprintf(log, "\n");
+        prepareVisibility(grid, log);
+    }
+    if (!reserveStrategy(ctx, strategy))
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for %s on a %u x %u map. ", strategyName(strategy), grid->Width, grid->Height);
+        exit(ERR_OUTOFMEMORY);
+    }
+    if (interactive && strategy != STRAT_BFS && strategy != STRAT_DFS && strategy != STRAT_BIBFS && strategy != STRAT_VISIBILITY)
+    {
+        printf("\nChoose an A* Fringe\n1 - Sorted List\n2 - %d-ary Heap\nOther - Bucket Queue\n>>> Enter Choice: ", HEAP_ARITY);
+        scanf("%d", &fringeType);
+    }
+
+    if (text) printf("\nStarting Search...\n");
+    uint64_t t = wallNanoseconds(); // For keeping track of running time; clock() ticks are too coarse for small maps
+    PROFILE_START(began);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    SearchResult result;
+    if (strategy == STRAT_BFS && cores > 1 && (size_t)grid->Width * grid->Height >= PBFS_MIN_CELLS)
+    {
+        // Big map: expand a level at a time on every core; the result is the same as runSearch()'s
+        fprintf(log, "(level-synchronous, on %ld threads)\n", cores);
+        result = parallelBFS(ctx, cores, PBFS_AUTO, current, goal);
+    }
+    else result = runSearch(ctx, strategy, fringeType, current, goal);
+    PROFILE_STOP(began, PROFILE_SEARCH);
+    // Get number of nanoseconds since last check to detection of final soln
+    t = wallNanoseconds() - t;
     #ifdef DEBUG
-        // >>>>>>>>> Draw path <<<<<<<<<<
-        // First, clear the grid
-        for (i = 0; i < H; i++)
-        {
-            for (j = 0; j < W; j++)
-            {
-                if (grid[i][j] != BLOCKED)
-                grid[i][j] = UNEXPLORED;
-            }
-        }
-        // Now, mark each point in the solution path
-        StackNode * n = path->Top;
-        while(n != NULL)
-        {
-            setTile(n->Data.x, n->Data.y, INSIDE_PATH);
-            n = n->Next;
-        }
-        // Finally, redraw the grid
-        drawGrid();
+        drawGrid(ctx);
     #endif
-    printf("\n\n----------------------------------------\nNumber of expanded nodes: %d", expanded_count);
-    printf("\nSolution cost: %d (Cost is 1 per step)", path->Depth - 1);
-    printf("\nRunning time: %f s (for the search part only)\n\n", ((float)t)/CLOCKS_PER_SEC);
+    if (text) printReport(ctx, strategy, current, goal, &result, t);
+    else printRecord(format, mapFilename, strategy, fringeType, current, goal, &result, t, readRate);
+    reportProfile(traceFilename, log);
 
     /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
        CLEAN UP: Delete dynamically allocated objs
       <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< */
 
-    AnnihilateStack(path);
+    destroySearchContext(ctx); // frees the fringe and the path in one go
+    AnnihilateGrid(grid);
 
     return 0;
 }
 
 /*
- * setTile() - Set coordinates (x,y) to status s
- */
-void setTile(unsigned int x, unsigned int y, unsigned int s)
-{
-    grid[y][x] = s;
-}
-
-/*
- * getTile() - Get status of tile at coordinates (x,y)
+ * parseFormat() - the FORMAT_* named by --format; -1 if there's none of that name
  */
-unsigned int getTile(unsigned int x, unsigned int y)
+int parseFormat(const char * name)
 {
-    return grid[y][x];
+    if (strcmp(name, "text") == 0) return FORMAT_TEXT;
+    if (strcmp(name, "csv") == 0) return FORMAT_CSV;
+    if (strcmp(name, "json") == 0) return FORMAT_JSON;
+    return -1;
 }
 
 /*
- * setPred() - Set the tile visited before, i.e., predecessor to a tile with coordinates (x,y)
+ * printReport() - prints the result of a search in full, the way interactive mode always has
  */
-void setPred(unsigned int x, unsigned int y, unsigned int px, unsigned int py)
+void printReport(SearchContext * ctx, int strategy, coordinate start, coordinate goal, SearchResult * result, uint64_t nanoseconds)
 {
-    pred[y][x].x = px;
-    pred[y][x].y = py;
-}
-
-/*
- * getPred() - Get the tile visited before, i.e., predecessor to a tile with coordinates (x,y)
- *             Returns the coordinate
- */
-coordinate getPred(unsigned int x, unsigned int y)
-{
-    return pred[y][x];
+    #ifdef DEBUG
+        unsigned int i;
+    #endif
+    if (result->Unreachable) printf("\n\n <!> No solution path found (the goal is in another region of the map).");
+    else if (!result->Found) printf("\n\n <!> No solution path found.");
+    Stack * path = result->Path;
+    printf("\n--------------------------------------------------\n");
+    printf("Final Location is (%d, %d)", result->Final.x, result->Final.y);
+    if (result->Found) printf(" which is a GOAL point.");
+    printf("\n\n");
+    printf("Traced Path (%s): ", strategyName(strategy));
+    PrintStack(path);
+    printf("\n\n*Includes initial and final positions.");
+    #ifdef DEBUG
+        // >>>>>>>>> Draw path <<<<<<<<<<
+        // First, clear the grid
+        clearTiles(ctx);
+        // Now, mark each point in the solution path
+        for (i = 0; i < path->Depth; i++)
+        {
+            setTile(ctx, path->Data[i].x, path->Data[i].y, INSIDE_PATH);
+        }
+        // Finally, redraw the grid
+        drawGrid(ctx);
+    #endif
+    printf("\n\n----------------------------------------\nNumber of expanded nodes: %d", result->Expanded);
+    printf("\nPeak fringe size: %u", result->PeakFringe);
+    printf("\nArena: %lu allocations, %lu bytes high-water, %lu heap calls", ctx->Pool->Allocations, (unsigned long)ctx->Pool->HighWater, ctx->Pool->HeapCalls);
+    if (strategy == STRAT_VISIBILITY) printf("\nSolution length: %.2f (straight lines between the waypoints)", pathLength(path));
+    else printf("\nSolution cost: %d (Cost is 1 per step)", path->Depth - 1);
+    if (strategy == STRAT_HPA && result->Found)
+    {
+        // HPA* trades optimality for speed; find out how much with a plain A* search
+        BatchQuery optimal = {.Start = start, .Goal = goal, .Strategy = STRAT_ASTAR, .FringeType = FRINGE_BUCKET};
+        if (runQueries(ctx->Map, &optimal, 1, 1))
+        {
+            printf("\nOptimal cost: %d (%s path is %.2f%% longer)", optimal.Cost, strategyName(strategy),
+                (optimal.Cost > 0) ? 100.0 * (path->Depth - 1 - optimal.Cost) / optimal.Cost : 0.0);
+        }
+    }
+    printf("\nRunning time: %.6f ms (for the search part only)\n\n", nanoseconds / 1e6);
 }
 
 /*
- * setF() - Set the f(n) value of a point/tile
+ * printRecord() - prints the result of a search as CSV or JSON, for scripts: the query, whether a path was found,
+ *                 its cost (-1 if none; the straight-line length for the visibility graph), the nodes expanded, the
+ *                 peak fringe size, the search time, how fast the map was parsed (0 if it was compiled) and the path
  */
-void setF(unsigned int x, unsigned int y, int f)
+void printRecord(int format, const char * mapFilename, int strategy, int fringeType, coordinate start, coordinate goal,
+    SearchResult * result, uint64_t nanoseconds, double readRate)
 {
-    f_n[y][x] = f;
+    unsigned int i;
+    Stack * path = result->Path;
+    double cost = !result->Found ? -1 : (strategy == STRAT_VISIBILITY) ? pathLength(path) : path->Depth - 1;
+    if (format == FORMAT_CSV)
+    {
+        printf("map,strategy,fringe,start_x,start_y,goal_x,goal_y,found,cost,expanded,peak_fringe,search_ns,read_mb_s,path\n");
+        printQuoted(mapFilename, format);
+        printf(",%d,%d,%d,%d,%d,%d,%d,%.2f,%d,%u,%llu,%.1f,", strategy, fringeType, start.x, start.y, goal.x, goal.y,
+            result->Found, cost, result->Expanded, result->PeakFringe, (unsigned long long)nanoseconds, readRate);
+        for (i = path->Depth; i > 0; i--) // From the top, like PrintStack()
+        {
+            printf("%s%d %d", (i < path->Depth) ? ";" : "", path->Data[i - 1].x, path->Data[i - 1].y); // 'x y' per step
+        }
+        printf("\n");
+        return;
+    }
+    printf("{\"map\": ");
+    printQuoted(mapFilename, format);
+    printf(", \"strategy\": %d, \"strategy_name\": ", strategy);
+    printQuoted(strategyName(strategy), format);
+    printf(", \"fringe\": %d, \"start\": [%d, %d], \"goal\": [%d, %d], \"found\": %s, \"unreachable\": %s, "
+        "\"cost\": %.2f, \"expanded\": %d, \"peak_fringe\": %u, \"search_ns\": %llu, \"read_mb_s\": %.1f, \"path\": [",
+        fringeType, start.x, start.y, goal.x, goal.y, result->Found ? "true" : "false",
+        result->Unreachable ? "true" : "false", cost, result->Expanded, result->PeakFringe,
+        (unsigned long long)nanoseconds, readRate);
+    for (i = path->Depth; i > 0; i--)
+    {
+        printf("%s[%d, %d]", (i < path->Depth) ? ", " : "", path->Data[i - 1].x, path->Data[i - 1].y);
+    }
+    printf("]}\n");
 }
 
 /*
- * getF() - Get f(n) of a point/tile
+ * printQuoted() - prints a string as a CSV field or a JSON string, quoted and escaped
  */
-int getF(unsigned int x, unsigned int y)
+void printQuoted(const char * s, int format)
 {
-    return f_n[y][x];
+    putchar('"');
+    for (; *s != '\0'; s++)
+    {
+        if (format == FORMAT_CSV && *s == '"') printf("\"\"");
+        else if (format == FORMAT_JSON && (*s == '"' || *s == '\\')) printf("\\%c", *s);
+        else if (format == FORMAT_JSON && (unsigned char)*s < 0x20) printf("\\u%04x", *s);
+        else putchar(*s);
+    }
+    putchar('"');
 }
 
 /*
- * teleport() - Move into the given coordinates (x,y)
- *  returns new current coordinate
+ * loadMap() - reads the size, start and goal, and obstacles from an open input file, closes it,
+ *             and returns the rasterized obstacle map, with its connected regions labelled
+ *           - echo prints the start, goal and obstacles as they are read, and how long the map took to build
+ *           - readRate, if not NULL, is set to how fast the text was parsed, in MB/s (0 for a compiled map)
+ *           - exits with the appropriate error code if the file is malformed or the map doesn't fit in memory
  */
-coordinate teleport(coordinate current, coordinate target)
+Grid * loadMap(FILE * inputFile, const char * inputFilename, coordinate * start, coordinate * goal, bool echo,
+    double * readRate)
 {
-    setTile(current.x, current.y, EXPLORED);
-    if (getTile(target.x, target.y) != GOAL) // Status GOAL MUST supercede CURRENT
+    unsigned int i;
+    if (readRate != NULL) *readRate = 0;
+    PROFILE_START(parsed);
+    // A map compiled by --compile is mapped instead of parsed
+    Grid * compiled = loadCompiledMap(inputFile, inputFilename, start, goal, echo);
+    if (compiled != NULL)
     {
-        setTile(target.x, target.y, CURRENT);
+        PROFILE_STOP(parsed, PROFILE_PARSE);
+        return compiled;
+    }
+    clock_t read_time = clock(); // Time spent parsing, less the time spent rasterizing
+    Scanner * scanner = createScanner(inputFile);
+    if (scanner == NULL)
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nNot enough memory to read '%s'. ", inputFilename);
+        exit(ERR_OUTOFMEMORY);
+    }
+    // Get map size from the optional 'size width height' line
+    int width = GRID_DEFAULT_WIDTH;
+    int height = GRID_DEFAULT_HEIGHT;
+    if (scanKeyword(scanner, "size")
+        && (scanInt(scanner, &width) != SCAN_OK || scanInt(scanner, &height) != SCAN_OK || width <= 0 || height <= 0))
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nMap size in '%s' must be a width and a height above 0. ", inputFilename);
+        exit(ERR_INPUTFILE_BADFORMAT);
     }
-    return target;
-}
 
-/*
- * drawGrid() - draw the grid with coordinates (Recommended only for W = 40 on most resolutions)
- */
-void drawGrid()
-{
-    int i, j;
-    printf("\n");
-    for (i = 0; i < H; i++)
+    // Create the obstacle map
+    Grid * grid = CreateNewGrid(width, height);
+    if (grid == NULL)
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for a %d x %d map. ", width, height);
+        exit(ERR_OUTOFMEMORY);
+    }
+    if (scanInt(scanner, &(start->x)) != SCAN_OK || scanInt(scanner, &(start->y)) != SCAN_OK
+        || scanInt(scanner, &(goal->x)) != SCAN_OK || scanInt(scanner, &(goal->y)) != SCAN_OK
+        || !insideGrid(grid, *start) || !insideGrid(grid, *goal))
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nStart and goal in '%s' must be inside the %u x %u map. ", inputFilename, grid->Width, grid->Height);
+        exit(ERR_INPUTFILE_BADFORMAT);
+    }
+    if (echo)
+    {
+        printf("\nFind Path from (%d, %d) to (%d, %d) on a %u x %u map.", start->x, start->y, goal->x, goal->y, grid->Width, grid->Height);
+        printf("\nObstacles:\n");
+    }
+    int tempInt;
+    int scanned; // SCAN_* of the last number read
+    unsigned int capacity = 0;
+    coordinate * vertices = NULL; // Grown as vertices come, not by the count in the file, and kept for the next polygon
+    clock_t build_time = 0; // Time spent rasterizing obstacles
+    while ((scanned = scanInt(scanner, &tempInt)) == SCAN_OK) // Number of vertices for this polygon
     {
-        for (j = 0; j < W; j++)
+        /*  FORMAT OF POLYGONS
+         *  number_of_vertices x1 y1 x2 y2 ...
+         */
+        if (tempInt < 0)
         {
-            switch(grid[i][j])
+            fprintf(stderr,"\nFATAL ERROR!\nA polygon in '%s' has %d vertices. ", inputFilename, tempInt);
+            exit(ERR_INPUTFILE_BADFORMAT);
+        }
+         // Get coordinates of vertices
+        for (i = 0; i < (unsigned int)tempInt; i++)
+        {
+            if (i == capacity)
+            {
+                capacity = (capacity > 0) ? capacity * 2 : 64;
+                vertices = realloc(vertices, capacity * sizeof(coordinate));
+                if (vertices == NULL)
+                {
+                    fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for a polygon of %d vertices. ", tempInt);
+                    exit(ERR_OUTOFMEMORY);
+                }
+            }
+            scanned = scanInt(scanner, &(vertices[i].x));
+            if (scanned == SCAN_OK) scanned = scanInt(scanner, &(vertices[i].y));
+            if (scanned == SCAN_END) break; // Cut short
+            if (scanned == SCAN_BAD)
             {
-                case GOAL:
-                    printf("X");
-                    break;
-                case EXPLORED:
-                    printf(":");
-                    break;
-                case BLOCKED:
-                    printf("@");
-                    break;
-                case CURRENT:
-                    printf("^");
-                    break;
-                case QUEUED:
-                    printf(".");
-                    break;
-                case INSIDE_PATH:
-                    printf("+");
-                    break;
-                default:
-                    printf(" ");
+                fprintf(stderr,"\nFATAL ERROR!\nVertex %u of a polygon in '%s' isn't two numbers that fit in an int. ", i + 1, inputFilename);
+                exit(ERR_INPUTFILE_BADFORMAT);
             }
         }
+        /* >>>>>>>>> Create Polyon >>>>>>>> */
+        // >>  Set blocked tiles (only the cells around each edge are visited) <<
+        clock_t rt = clock();
+        PROFILE_START(rasterized);
+        rasterizePolygon(vertices, i, RASTER_MODE, grid->Blocked, grid->Width, grid->Height, 1);
+        PROFILE_STOP(rasterized, PROFILE_RASTERIZE);
+        build_time += clock() - rt;
+        AddGridPolygon(grid, vertices, i); // Kept for the visibility graph
+        if (!echo) continue;
+        // Print obstacle vertices
+        unsigned int n = i;
+        for (i = 0; i < n; i++)
+        {
+            printf("(%d %d) ", vertices[i].x, vertices[i].y);
+        }
         printf("\n");
     }
+    if (scanned == SCAN_BAD) // Not the end of the file, so not the end of the map either
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nA polygon in '%s' doesn't start with a vertex count that fits in an int. ", inputFilename);
+        exit(ERR_INPUTFILE_BADFORMAT);
+    }
+    free(vertices);
+    read_time = clock() - read_time - build_time;
+    double megabytes = scanner->Bytes / 1e6;
+    destroyScanner(scanner);
+
+    // Close input file
+    fclose(inputFile);
+    PROFILE_STOP(parsed, PROFILE_PARSE);
+    double rate = (read_time > 0) ? megabytes / (((double)read_time)/CLOCKS_PER_SEC) : 0.0;
+    if (readRate != NULL) *readRate = rate;
+    // One pass over the map, so that every search can turn down a goal it could never reach in O(1)
+    clock_t label_time = clock();
+    PROFILE_START(labelled);
+    if (!LabelGridComponents(grid))
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for a %u x %u map. ", grid->Width, grid->Height);
+        exit(ERR_OUTOFMEMORY);
+    }
+    PROFILE_STOP(labelled, PROFILE_LABEL);
+    label_time = clock() - label_time;
+    if (echo)
+    {
+        printf("\nMap built in %f s (%u regions labelled in %f s), read in %f s (%.2f MB at %.1f MB/s)\n",
+            ((float)build_time)/CLOCKS_PER_SEC, grid->Components->Count, ((float)label_time)/CLOCKS_PER_SEC,
+            ((float)read_time)/CLOCKS_PER_SEC, megabytes, rate);
+    }
+    return grid;
 }
 
 /*
- * BFS() - "Breadth-First": Enqueue the BFS successors of the current coordinate
+ * loadCompiledMap() - if the input file is a compiled map, or a compiled map of it is saved next to it as
+ *                     'inputFilename.bin' and was compiled from the very same text, closes the input file and
+ *                     returns the compiled map; otherwise returns NULL and leaves the input file as it was
+ *                   - only a regular input file is looked at; a pipe is left unread for the scanner, since what is
+ *                     read from it can't be read again
+ *                   - echo prints the same as loadMap() does, but how long the map took to map instead of to build
+ *                   - exits with the appropriate error code if the input file is a compiled map that can't be used
  */
-void BFS(Queue * fringe, coordinate current)
+Grid * loadCompiledMap(FILE * inputFile, const char * inputFilename, coordinate * start, coordinate * goal, bool echo)
 {
-    // Assume BFS relative order to be: Right, Left, Up, Down
-    // Check if RIGHT successor is viable
-    if (current.x < W - 1 && getTile(current.x + 1, current.y) >= UNEXPLORED)
+    char * compiledFilename = NULL;
+    uint32_t magic = 0;
+    unsigned int i, p;
+    double t = wallTime();
+    Grid * grid = NULL;
+    if (!regularFile(inputFile)) return NULL; // Nothing to map, and no text it could have been compiled from
+    bool direct = fread(&magic, sizeof(magic), 1, inputFile) == 1 && magic == MAPFILE_MAGIC;
+    rewind(inputFile);
+    if (direct)
     {
-        Enqueue(fringe, current.x + 1, current.y);
-        if(getTile(current.x + 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
+        grid = openCompiledMap(inputFilename, MAPFILE_ANY_SOURCE, start, goal);
+        if (grid == NULL)
         {
-            setTile(current.x + 1, current.y, QUEUED);
+            fprintf(stderr,"\nFATAL ERROR!\n'%s' is damaged, or was compiled by another version. ", inputFilename);
+            exit(ERR_INPUTFILE_BADFORMAT);
         }
-        // We MIGHT move from current tile to this tile
-        // Set tile's predecessor to the current tile
-        setPred(current.x + 1, current.y, current.x, current.y);
     }
-    // Check LEFT
-    if (current.x > 0 && getTile(current.x - 1, current.y) >= UNEXPLORED)
+    else
     {
-        Enqueue(fringe, current.x - 1, current.y);
-        if(getTile(current.x - 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
+        compiledFilename = siblingFilename(inputFilename, ".bin");
+        if (compiledFilename == NULL)
         {
-            setTile(current.x - 1, current.y, QUEUED);
+            fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for the name of '%s.bin'. ", inputFilename);
+            exit(ERR_OUTOFMEMORY);
         }
-        // Set tile's predecessor to the current tile
-        setPred(current.x - 1, current.y, current.x, current.y);
-    }
-    // Check UP (but remember, in our grid system, up means lower y)
-    if (current.y > 0 && getTile(current.x, current.y - 1) >= UNEXPLORED)
-    {
-        Enqueue(fringe, current.x, current.y - 1);
-        if(getTile(current.x, current.y - 1) != GOAL) // GOAL Must supercede other QUEUED
+        if (access(compiledFilename, R_OK) != 0) // Never compiled
         {
-            setTile(current.x, current.y - 1, QUEUED);
+            free(compiledFilename);
+            return NULL;
         }
-        // Set tile's predecessor to the current tile
-        setPred(current.x, current.y - 1, current.x, current.y);
+        grid = openCompiledMap(compiledFilename, mapSourceHash(inputFile), start, goal);
+        if (grid == NULL)
+        {
+            if (echo) printf("\n'%s' is out of date; reading the map instead.", compiledFilename);
+            free(compiledFilename);
+            return NULL;
+        }
+    }
+    fclose(inputFile);
+    t = wallTime() - t;
+    if (!insideGrid(grid, *start) || !insideGrid(grid, *goal))
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nStart and goal in '%s' must be inside the %u x %u map. ", inputFilename, grid->Width, grid->Height);
+        exit(ERR_INPUTFILE_BADFORMAT);
     }
-    // Check DOWN
-    if (current.y < H - 1 && getTile(current.x, current.y + 1) >= UNEXPLORED)
+    if (!echo)
+    {
+        free(compiledFilename);
+        return grid;
+    }
+    printf("\nFind Path from (%d, %d) to (%d, %d) on a %u x %u map.", start->x, start->y, goal->x, goal->y, grid->Width, grid->Height);
+    printf("\nObstacles:\n");
+    for (p = 0; p < grid->PolygonCount; p++)
     {
-        Enqueue(fringe, current.x, current.y + 1);
-        if(getTile(current.x, current.y + 1) != GOAL) // GOAL Must supercede other QUEUED
+        for (i = (p > 0) ? grid->PolygonEnds[p - 1] : 0; i < grid->PolygonEnds[p]; i++)
         {
-            setTile(current.x, current.y + 1, QUEUED);
+            printf("(%d %d) ", grid->Vertices[i].x, grid->Vertices[i].y);
         }
-        // Set tile's predecessor to the current tile
-        setPred(current.x, current.y + 1, current.x, current.y);
+        printf("\n");
     }
-    return;
+    printf("\nMap mapped from '%s' in %f s (%u regions labelled)\n", direct ? inputFilename : compiledFilename, t,
+        grid->Components->Count);
+    free(compiledFilename);
+    return grid;
 }
 
 /*
- * DFS() - "Depth-First": Push into the stack the DFS successors of the current coordinate
+ * mapSourceHash() - the hash a compiled map keeps of the text it was compiled from: the rest of the input file,
+ *                   and how the polygons are rasterized, since that changes the map too
  */
-void DFS(Stack * fringe, coordinate current)
+uint64_t mapSourceHash(FILE * inputFile)
 {
-    // Assume DFS relative order to be: Right, Left, Up, Down
-    // But then we have to push them into the stack in reverse order (i.e., Down, up, left, right)
-    // Check DOWN successor
-    if (current.y < H - 1 && getTile(current.x, current.y + 1) >= UNEXPLORED)
+    return (hashMapSource(inputFile) ^ RASTER_MODE) * 1099511628211ULL; // FNV prime
+}
+
+/*
+ * compileMap() - reads a map, labels its regions and, with landmarks, gives it its ALT table, then saves it all as a
+ *                compiled map to outputFilename ('mapFilename.bin' if NULL), where later runs on the map find it
+ *              - prints what it wrote, and how long reading the map took against mapping the compiled one, to stderr
+ *              - refuses to write over the map itself, or to compile a stream such as a pipe
+ */
+int compileMap(const char * mapFilename, const char * outputFilename, bool landmarks)
+{
+    char * compiledFilename = NULL;
+    coordinate start, goal;
+    if (outputFilename == NULL)
     {
-        PushToStack(fringe, current.x, current.y + 1);
-        if(getTile(current.x, current.y + 1) != GOAL) // GOAL Must supercede other QUEUED
+        compiledFilename = siblingFilename(mapFilename, ".bin");
+        if (compiledFilename == NULL)
         {
-            setTile(current.x, current.y + 1, QUEUED);
+            fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for the name of '%s.bin'. ", mapFilename);
+            exit(ERR_OUTOFMEMORY);
         }
-        // We MIGHT move from current tile to this tile
-        // Set tile's predecessor to the current tile
-        setPred(current.x, current.y + 1, current.x, current.y);
+        outputFilename = compiledFilename;
     }
-    // Check UP (but remember, in our grid system, up means lower y)
-    if (current.y > 0 && getTile(current.x, current.y - 1) >= UNEXPLORED)
+    if (sameFile(mapFilename, outputFilename))
     {
-        PushToStack(fringe, current.x, current.y - 1);
-        if(getTile(current.x, current.y - 1) != GOAL) // GOAL Must supercede other QUEUED
-        {
-            setTile(current.x, current.y - 1, QUEUED);
-        }
-        // Set tile's predecessor to the current tile
-        setPred(current.x, current.y - 1, current.x, current.y);
+        fprintf(stderr,"\nFATAL ERROR!\nThe compiled map would replace '%s' itself. ", mapFilename);
+        exit(ERR_USAGE);
     }
-    // Check LEFT
-    if (current.x > 0 && getTile(current.x - 1, current.y) >= UNEXPLORED)
+    FILE * inputFile = fopen(mapFilename, "r");
+    if (inputFile == NULL)
     {
-        PushToStack(fringe, current.x - 1, current.y);
-        if(getTile(current.x - 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
-        {
-            setTile(current.x - 1, current.y, QUEUED);
-        }
-        // Set tile's predecessor to the current tile
-        setPred(current.x - 1, current.y, current.x, current.y);
+        fprintf(stderr,"\nFATAL ERROR!\nFailed to open '%s'. ", mapFilename);
+        exit(ERR_INPUTFILE_CANNOTOPEN);
     }
-    // Check if RIGHT successor is viable
-    if (current.x < W - 1 && getTile(current.x + 1, current.y) >= UNEXPLORED)
+    if (!regularFile(inputFile)) // Its text couldn't be hashed and then read, nor found again by later runs
     {
-        PushToStack(fringe, current.x + 1, current.y);
-        if(getTile(current.x + 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
-        {
-            setTile(current.x + 1, current.y, QUEUED);
-        }
-        // Set tile's predecessor to the current tile
-        setPred(current.x + 1, current.y, current.x, current.y);
+        fprintf(stderr,"\nFATAL ERROR!\n'%s' isn't a regular file; only a map file can be compiled. ", mapFilename);
+        exit(ERR_USAGE);
     }
-    return;
-}
-
-/*
- * absval() - Returns the absolute value of a function
- */
-int absval(int x)
-{
-    return (x < 0) ? -1 * x : x;
+    uint32_t magic = 0;
+    if (fread(&magic, sizeof(magic), 1, inputFile) == 1 && magic == MAPFILE_MAGIC)
+    {
+        fprintf(stderr,"\nFATAL ERROR!\n'%s' is compiled already. ", mapFilename);
+        exit(ERR_INPUTFILE_BADFORMAT);
+    }
+    rewind(inputFile);
+    uint64_t sourceHash = mapSourceHash(inputFile);
+    // The old compiled map goes first: loadMap() would map it instead of reading the text, and it mustn't be
+    // rewritten while it's mapped
+    if (access(outputFilename, F_OK) == 0 && remove(outputFilename) != 0)
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nFailed to replace '%s'. ", outputFilename);
+        exit(ERR_INPUTFILE_CANNOTOPEN);
+    }
+    double t = wallTime();
+    double readRate;
+    Grid * grid = loadMap(inputFile, mapFilename, &start, &goal, false, &readRate);
+    double readTime = wallTime() - t;
+    if (landmarks) prepareLandmarks(grid, mapFilename, stderr);
+    if (!saveCompiledMap(grid, start, goal, sourceHash, outputFilename))
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nFailed to write '%s'. ", outputFilename);
+        exit(ERR_INPUTFILE_CANNOTOPEN);
+    }
+    AnnihilateGrid(grid);
+    t = wallTime();
+    grid = openCompiledMap(outputFilename, sourceHash, &start, &goal);
+    double mapTime = wallTime() - t;
+    if (grid == NULL)
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nFailed to read back '%s'. ", outputFilename);
+        exit(ERR_INPUTFILE_BADFORMAT);
+    }
+    fprintf(stderr, "Compiled '%s' (%u x %u, %u polygons, %u regions%s) to '%s'\n", mapFilename, grid->Width,
+        grid->Height, grid->PolygonCount, grid->Components->Count, (grid->Landmarks != NULL) ? ", ALT table" : "",
+        outputFilename);
+    fprintf(stderr, "Reading the map took %f s (parsed at %.1f MB/s); mapping the compiled one takes %f s\n", readTime,
+        readRate, mapTime);
+    AnnihilateGrid(grid);
+    free(compiledFilename);
+    return 0;
 }
 
 /*
- * h() - Returns the estimated distance of a point alpha to the goal
- *                      - Uses the (optimistic) Manhattan distance as the heuristic
+ * insideGrid() - true if coordinate c is a tile of the grid
  */
-int h(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
+bool insideGrid(Grid * grid, coordinate c)
 {
-    return absval(x2 - x1) + absval(y2 - y1);
+    return c.x >= 0 && c.y >= 0 && c.x < (int)grid->Width && c.y < (int)grid->Height;
 }
 
 /*
- * Astar() - "A* Search": Enqueue the A* successors of the current coordinate (sorted upon insertion)
- *         - arguments: fringe (SortedList) to insert successors into, current position of robot, and g(n) or the current *           level - 1, goal (coordinate), which is needed to compute h(n)
+ * runBatch() - loads a map once, then answers every query read from queryFilename (stdin if NULL)
+ *            - a query is a line 'start_x start_y goal_x goal_y [strategy [fringe]]'; blank lines and lines
+ *              starting with '#' are skipped, and the strategy defaults to A* with a bucket queue; a query off
+ *              the map, or with a strategy or fringe that doesn't exist, is skipped with a warning
+ *            - the queries are spread over the given number of threads; with scaling > 0, they are instead
+ *              run once for each thread count from 1 to scaling and only the timings are printed
+ *            - prints one line per query to stdout, in input order, and the throughput to stderr
+ *            - with PROFILE, prints the phase timings and fringe counters to stderr, and writes a trace of every
+ *              query to traceFilename if it isn't NULL
  */
-void Astar(SortedList * fringe, coordinate current, unsigned int g, coordinate goal)
+int runBatch(const char * mapFilename, const char * queryFilename, unsigned int threads, unsigned int scaling,
+    const char * traceFilename)
 {
-    // Order doesn't matter
-    // Check if RIGHT successor is viable
-    bool cont = true;
-    if (current.x < W - 1 && getTile(current.x + 1, current.y) >= QUEUED)
+    FILE * inputFile = fopen(mapFilename, "r");
+    if (inputFile == NULL)
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nFailed to open '%s'. ", mapFilename);
+        exit(ERR_INPUTFILE_CANNOTOPEN);
+    }
+    FILE * queryFile = stdin;
+    if (queryFilename != NULL)
     {
-        float f = g + h(current.x + 1, current.y, goal.x, goal.y);
-        if (getTile(current.x + 1, current.y) == QUEUED)
+        queryFile = fopen(queryFilename, "r");
+        if (queryFile == NULL)
         {
-            // If queued, check to see if f from this current node is less than the stored f
-            // Find successor in List
-            if (getF(current.x + 1, current.y) <= f) cont = false;
+            fprintf(stderr,"\nFATAL ERROR!\nFailed to open '%s'. ", queryFilename);
+            exit(ERR_INPUTFILE_CANNOTOPEN);
         }
-        if (cont)
+    }
+    coordinate start, goal; // the map file's own query; only the map is used
+    double t = wallTime();
+    double readRate;
+    Grid * grid = loadMap(inputFile, mapFilename, &start, &goal, false, &readRate);
+    fprintf(stderr, "Map '%s' (%u x %u) loaded in %f s", mapFilename, grid->Width, grid->Height, wallTime() - t);
+    if (readRate > 0) fprintf(stderr, " (parsed at %.1f MB/s)", readRate);
+    fprintf(stderr, "\n");
+
+    // Read every query up front so that the workers can split them up
+    char line[STRINGMAX];
+    unsigned int count = 0, capacity = 256, lineNumber = 0, i;
+    BatchQuery * queries = malloc(capacity * sizeof(BatchQuery));
+    if (queries == NULL)
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for %u queries. ", capacity);
+        exit(ERR_OUTOFMEMORY);
+    }
+    while (fgets(line, STRINGMAX, queryFile) != NULL)
+    {
+        BatchQuery q;
+        lineNumber++;
+        char * first = line + strspn(line, " \t\r\n");
+        if (*first == '\0' || *first == '#') continue; // Blank line or comment
+        q.Strategy = STRAT_ASTAR;
+        q.FringeType = FRINGE_BUCKET;
+        int n = sscanf(line, "%d %d %d %d %d %d", &(q.Start.x), &(q.Start.y), &(q.Goal.x), &(q.Goal.y), &(q.Strategy), &(q.FringeType));
+        if (n < 4 || !insideGrid(grid, q.Start) || !insideGrid(grid, q.Goal) || q.Strategy < STRAT_BFS
+            || q.Strategy > STRAT_VISIBILITY || q.FringeType < FRINGE_LIST || q.FringeType > FRINGE_BUCKET)
+        {
+            line[strcspn(line, "\r\n")] = '\0';
+            fprintf(stderr, "Skipping bad query on line %u: %s\n", lineNumber, line);
+            continue;
+        }
+        if (count == capacity)
         {
-            InsertToSortedList(fringe, current.x + 1, current.y, f, g + 1);
-            setF(current.x + 1, current.y, f);
-            if(getTile(current.x + 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
+            capacity *= 2;
+            BatchQuery * grown = realloc(queries, capacity * sizeof(BatchQuery));
+            if (grown == NULL)
             {
-                setTile(current.x + 1, current.y, QUEUED);
+                fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for %u queries. ", capacity);
+                exit(ERR_OUTOFMEMORY);
             }
-            // We MIGHT move from current tile to this tile
-            // Set tile's predecessor to the current tile
-            setPred(current.x + 1, current.y, current.x, current.y);
+            queries = grown;
         }
+        queries[count++] = q;
     }
-    cont = true;
-    // Check LEFT
-    if (current.x > 0 && getTile(current.x - 1, current.y) >= QUEUED)
+    if (queryFile != stdin) fclose(queryFile);
+    // The free-tile bits and the jump and landmark tables are shared by every worker, so they have to be built
+    // before they start
+    for (i = 0; i < count; i++)
     {
-        float f = g + h(current.x - 1, current.y, goal.x, goal.y);
-        if (getTile(current.x - 1, current.y) == QUEUED)
+        if (queries[i].Strategy == STRAT_JPS && grid->OpenBits == NULL)
         {
-            // If queued, check to see if f from this current node is less than the stored f
-            // Find successor in List
-            if (getF(current.x - 1, current.y) <= f) cont = false;
+            PROFILE_START(prepared);
+            if (!reserveOpenBits(grid))
+            {
+                fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for JPS on a %u x %u map. ", grid->Width, grid->Height);
+                exit(ERR_OUTOFMEMORY);
+            }
+            PROFILE_STOP(prepared, PROFILE_PREPARE);
         }
-        if (cont)
+        if (queries[i].Strategy == STRAT_JPS_PLUS && grid->Jumps == NULL)
         {
-            InsertToSortedList(fringe, current.x - 1, current.y, f, g + 1);
-            setF(current.x - 1, current.y, f);
-            if(getTile(current.x - 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
+            PROFILE_START(prepared);
+            if (!reserveJumpTable(grid))
             {
-                setTile(current.x - 1, current.y, QUEUED);
+                fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for JPS+ on a %u x %u map. ", grid->Width, grid->Height);
+                exit(ERR_OUTOFMEMORY);
             }
-            // We MIGHT move from current tile to this tile
-            // Set tile's predecessor to the current tile
-            setPred(current.x - 1, current.y, current.x, current.y);
+            PROFILE_STOP(prepared, PROFILE_PREPARE);
         }
+        if (queries[i].Strategy == STRAT_ALT) prepareLandmarks(grid, mapFilename, stderr);
+        if (queries[i].Strategy == STRAT_HPA) prepareHierarchy(grid, stderr);
+        if (queries[i].Strategy == STRAT_VISIBILITY) prepareVisibility(grid, stderr);
     }
-    cont = true;
-    // Check UP (but remember, in our grid system, up means lower y)
-    if (current.y > 0 && getTile(current.x, current.y - 1) >= QUEUED)
+
+    if (scaling > 0)
     {
-        float f = g + h(current.x, current.y - 1, goal.x, goal.y);
-        if (getTile(current.x, current.y - 1) == QUEUED)
+        // Run the whole batch once per thread count; every run must give the same answers as the first
+        BatchQuery * reference = malloc((count > 0 ? count : 1) * sizeof(BatchQuery));
+        double base = 0;
+        printf("threads seconds queries/sec speedup efficiency mismatches\n");
+        for (threads = 1; threads <= scaling; threads++)
         {
-            // If queued, check to see if f from this current node is less than the stored f
-            // Find successor in List
-            if (getF(current.x, current.y - 1) <= f) cont = false;
-        }
-        if (cont)
-        {
-            InsertToSortedList(fringe, current.x, current.y - 1, f, g + 1);
-            setF(current.x, current.y - 1, f);
-            if(getTile(current.x, current.y - 1) != GOAL) // GOAL Must supercede other QUEUED
+            unsigned int mismatches = 0;
+            t = wallTime();
+            if (!runQueries(grid, queries, count, threads))
+            {
+                fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for %u searches on a %u x %u map. ", threads, grid->Width, grid->Height);
+                exit(ERR_OUTOFMEMORY);
+            }
+            t = wallTime() - t;
+            if (threads == 1)
+            {
+                base = t;
+                memcpy(reference, queries, count * sizeof(BatchQuery));
+            }
+            for (i = 0; i < count; i++)
             {
-                setTile(current.x, current.y - 1, QUEUED);
+                if (queries[i].Cost != reference[i].Cost || queries[i].Expanded != reference[i].Expanded) mismatches++;
             }
-            // We MIGHT move from current tile to this tile
-            // Set tile's predecessor to the current tile
-            setPred(current.x, current.y - 1, current.x, current.y);
+            printf("%7u %7.4f %11.1f %7.2f %10.2f %10u\n", threads, t, (t > 0) ? count / t : 0.0,
+                (t > 0) ? base / t : 0.0, (t > 0) ? base / t / threads : 0.0, mismatches);
         }
+        free(reference);
     }
-    // Check DOWN
-    cont = true;
-    if (current.y < H - 1 && getTile(current.x, current.y + 1) >= QUEUED)
+    else
     {
-        float f = g + h(current.x, current.y + 1, goal.x, goal.y);
-        if (getTile(current.x, current.y + 1) == QUEUED)
+        t = wallTime(); // Only the queries count towards the throughput
+        if (!runQueries(grid, queries, count, threads))
         {
-            // If queued, check to see if f from this current node is less than the stored f
-            // Find successor in List
-            if (getF(current.x, current.y + 1) <= f) cont = false;
+            fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for %u searches on a %u x %u map. ", threads, grid->Width, grid->Height);
+            exit(ERR_OUTOFMEMORY);
         }
-        if (cont)
+        t = wallTime() - t;
+        printf("# start_x start_y goal_x goal_y strategy cost expanded\n");
+        for (i = 0; i < count; i++)
         {
-            InsertToSortedList(fringe, current.x, current.y + 1, f, g + 1);
-            setF(current.x, current.y + 1, f);
-            if(getTile(current.x, current.y + 1) != GOAL) // GOAL Must supercede other QUEUED
+            BatchQuery * q = &queries[i];
+            if (q->Strategy == STRAT_VISIBILITY && q->Found) // Any-angle paths have a fractional length
             {
-                setTile(current.x, current.y + 1, QUEUED);
+                printf("%d %d %d %d %s %.2f %d\n", q->Start.x, q->Start.y, q->Goal.x, q->Goal.y, strategyName(q->Strategy), q->Length, q->Expanded);
             }
-            // We MIGHT move from current tile to this tile
-            // Set tile's predecessor to the current tile
-            setPred(current.x, current.y + 1, current.x, current.y);
+            else printf("%d %d %d %d %s %d %d\n", q->Start.x, q->Start.y, q->Goal.x, q->Goal.y, strategyName(q->Strategy), q->Cost, q->Expanded);
+        }
+        fprintf(stderr, "%u queries on %u threads in %f s (%.1f queries/sec)\n", count, threads, t, (t > 0) ? count / t : 0.0);
+        reportSuboptimality(grid, queries, count, threads);
+    }
+    reportProfile(traceFilename, stderr);
+
+    free(queries);
+    AnnihilateGrid(grid);
+    return 0;
+}
+
+/*
+ * siblingFilename() - a new string of filename with suffix appended, e.g. 'map.txt.alt' for the table kept next to
+ *                     'map.txt'; sized to fit, so that a long name is never cut back to the file it was made from
+ *                   - the caller frees it; NULL if there isn't enough memory
+ */
+char * siblingFilename(const char * filename, const char * suffix)
+{
+    size_t size = strlen(filename) + strlen(suffix) + 1;
+    char * sibling = malloc(size);
+    if (sibling == NULL) return NULL;
+    if ((size_t)snprintf(sibling, size, "%s%s", filename, suffix) >= size) // Never, unless the size above is wrong
+    {
+        free(sibling);
+        return NULL;
+    }
+    return sibling;
+}
+
+/*
+ * sameFile() - true if both names are the same, or lead to the same existing file (through links or another path)
+ */
+bool sameFile(const char * a, const char * b)
+{
+    struct stat sa, sb;
+    if (strcmp(a, b) == 0) return true;
+    return stat(a, &sa) == 0 && stat(b, &sb) == 0 && sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+}
+
+/*
+ * prepareLandmarks() - gives the map its ALT table: loaded from 'mapFilename.alt' if it was saved there for this
+ *                      very map, otherwise built and saved there, so that the preprocessing is paid only once
+ *                    - says which it was, and how long it took, on log
+ *                    - exits if there isn't enough memory for the table; a table that can't be saved is still used
+ */
+void prepareLandmarks(Grid * grid, const char * mapFilename, FILE * log)
+{
+    if (grid->Landmarks != NULL) return;
+    char * tableFilename = siblingFilename(mapFilename, ".alt");
+    if (tableFilename == NULL)
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for the name of '%s.alt'. ", mapFilename);
+        exit(ERR_OUTOFMEMORY);
+    }
+    double t = wallTime();
+    PROFILE_START(prepared);
+    if (loadLandmarks(grid, tableFilename))
+    {
+        PROFILE_STOP(prepared, PROFILE_PREPARE);
+        fprintf(log, "Landmarks loaded from '%s' in %f s\n", tableFilename, wallTime() - t);
+        free(tableFilename);
+        return;
+    }
+    if (!reserveLandmarks(grid, ALT_LANDMARKS))
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for ALT on a %u x %u map. ", grid->Width, grid->Height);
+        exit(ERR_OUTOFMEMORY);
+    }
+    PROFILE_STOP(prepared, PROFILE_PREPARE);
+    fprintf(log, "%u landmarks built in %f s", grid->LandmarkCount, wallTime() - t);
+    if (saveLandmarks(grid, tableFilename)) fprintf(log, " and saved to '%s'\n", tableFilename);
+    else fprintf(log, " (couldn't save them to '%s')\n", tableFilename);
+    free(tableFilename);
+}
+
+/*
+ * prepareHierarchy() - gives the map its HPA* abstract graph, and says how long that took and how big it is on log
+ *                    - exits if there isn't enough memory for it
+ */
+void prepareHierarchy(Grid * grid, FILE * log)
+{
+    if (grid->Hierarchy != NULL) return;
+    double t = wallTime();
+    PROFILE_START(prepared);
+    if (!reserveHierarchy(grid, HPA_CLUSTER_SIZE))
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for HPA* on a %u x %u map. ", grid->Width, grid->Height);
+        exit(ERR_OUTOFMEMORY);
+    }
+    PROFILE_STOP(prepared, PROFILE_PREPARE);
+    fprintf(log, "Abstract graph built in %f s (%u x %u clusters, %u nodes, %u edges)\n", wallTime() - t,
+        grid->Hierarchy->ClustersX, grid->Hierarchy->ClustersY, grid->Hierarchy->NodeCount, grid->Hierarchy->EdgeCount);
+}
+
+/*
+ * prepareVisibility() - gives the map the visibility graph of its polygons, and says how long that took and how big it
+ *                       is on log
+ *                     - exits if there isn't enough memory for it
+ */
+void prepareVisibility(Grid * grid, FILE * log)
+{
+    if (grid->Visibility != NULL) return;
+    double t = wallTime();
+    PROFILE_START(prepared);
+    if (!reserveVisibility(grid))
+    {
+        fprintf(stderr,"\nFATAL ERROR!\nNot enough memory for the visibility graph of %u polygons. ", grid->PolygonCount);
+        exit(ERR_OUTOFMEMORY);
+    }
+    PROFILE_STOP(prepared, PROFILE_PREPARE);
+    fprintf(log, "Visibility graph built in %f s (%u corners, %u nodes, %u edges)\n", wallTime() - t,
+        grid->Visibility->VertexCount, grid->Visibility->NodeCount, grid->Visibility->EdgeCount);
+}
+
+/*
+ * reportSuboptimality() - answers every HPA* query that found a path again with plain A*, and prints to stderr how
+ *                         much longer the HPA* paths are than the shortest ones, on average and at worst
+ */
+void reportSuboptimality(Grid * grid, BatchQuery * queries, unsigned int count, unsigned int threads)
+{
+    unsigned int i, n = 0, optimal = 0;
+    double total = 0, worst = 0;
+    BatchQuery * reference = malloc((count > 0 ? count : 1) * sizeof(BatchQuery));
+    for (i = 0; i < count; i++)
+    {
+        if (queries[i].Strategy != STRAT_HPA || !queries[i].Found) continue;
+        reference[n] = queries[i];
+        reference[n].Strategy = STRAT_ASTAR;
+        reference[n++].FringeType = FRINGE_BUCKET;
+    }
+    if (n > 0 && runQueries(grid, reference, n, threads))
+    {
+        unsigned int k = 0;
+        for (i = 0; i < count; i++)
+        {
+            if (queries[i].Strategy != STRAT_HPA || !queries[i].Found) continue;
+            int best = reference[k++].Cost;
+            double excess = (best > 0) ? 100.0 * (queries[i].Cost - best) / best : 0.0;
+            if (queries[i].Cost == best) optimal++;
+            total += excess;
+            if (excess > worst) worst = excess;
         }
+        fprintf(stderr, "HPA*: %u of %u paths optimal; %.2f%% longer than optimal on average, %.2f%% at worst\n",
+            optimal, n, total / n, worst);
     }
-    return;
+    free(reference);
+}
+
+/*
+ * reportProfile() - with PROFILE, prints how long each phase took and the fringe counters on log, and writes the
+ *                   Chrome trace of the run to traceFilename if it isn't NULL
+ *                 - without it, there is nothing to report; a trace asked for is only said to be missing
+ */
+void reportProfile(const char * traceFilename, FILE * log)
+{
+    #ifdef PROFILE
+        profileReport(log);
+        if (traceFilename == NULL) return;
+        if (profileWriteTrace(traceFilename)) fprintf(log, "Trace written to '%s'\n", traceFilename);
+        else fprintf(stderr, "Failed to write the trace to '%s'\n", traceFilename);
+    #else
+        (void)log;
+        if (traceFilename != NULL) fprintf(stderr, "No trace written to '%s': built without PROFILE\n", traceFilename);
+    #endif
+}
+
+/*
+ * usageError() - says which argument wasn't understood, prints how the app is used, and exits
+ */
+void usageError(const char * program, const char * argument)
+{
+    fprintf(stderr, "Unknown option or missing value: '%s'\n", argument);
+    fprintf(stderr, "Usage: %s [--map map.txt [--strategy N] [--fringe N] [--format text|csv|json]] [--trace trace.json]\n"
+        "       %s --batch map.txt [queries.txt] [--threads N] [--scaling N] [--trace trace.json]\n"
+        "       %s --compile map.txt [map.bin] [--landmarks]\n", program, program, program);
+    exit(ERR_USAGE);
 }
@@ -0,0 +1,192 @@
+/****************************************************************************
+'arena.h' - implements functions that perform operations or manipulations
+            on Arenas, i.e., bump allocators that hand out memory for the
+            duration of one search and take all of it back in one go
+          - Programmer: Vincent Paul Fiestada
+*****************************************************************************/
+
+#pragma once
+#include "cardinal.h"
+
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGNMENT 16
+
+typedef struct ArenaBlock
+{
+	struct ArenaBlock * Next;
+	size_t Size; // bytes available in this block
+	size_t Used; // bytes handed out from this block
+	unsigned char * Data;
+} ArenaBlock;
+
+typedef struct
+{
+	ArenaBlock * First;
+	ArenaBlock * Current; // block that allocations are currently carved from
+	void * Last; // most recent allocation; only this one can be grown in place
+	size_t BlockSize; // minimum size of a new block
+	size_t Used; // bytes handed out since the last reset
+	size_t HighWater; // most bytes ever in use at once
+	unsigned long Allocations; // number of allocations since the last reset
+	unsigned long HeapCalls; // number of times the arena itself had to call malloc
+} Arena;
+
+
+Arena * CreateNewArena(size_t blockSize);
+void AnnihilateArena(Arena * targetArena);
+void ArenaReset(Arena * targetArena);
+void * ArenaAlloc(Arena * targetArena, size_t size);
+void * ArenaGrow(Arena * targetArena, void * p, size_t oldSize, size_t newSize);
+void ArenaFree(Arena * targetArena, void * p);
+size_t ArenaRound(size_t size);
+
+// <summary>
+// CreateNewArena - allocates space for a new empty Arena whose blocks are at least blockSize bytes
+//                - no block is allocated until the first ArenaAlloc
+//				  - The creator has the implicit responsibility of freeing up the Arena later
+//                  using the AnnihilateArena(..) function
+//                - returns NULL if there isn't enough memory
+// </summary>
+Arena * CreateNewArena(size_t blockSize)
+{
+	Arena * a = malloc(sizeof(Arena));
+	if (a == NULL) return NULL;
+	a->First = NULL;
+	a->Current = NULL;
+	a->Last = NULL;
+	a->BlockSize = (blockSize > 0) ? blockSize : ARENA_DEFAULT_BLOCK_SIZE;
+	a->Used = 0;
+	a->HighWater = 0;
+	a->Allocations = 0;
+	a->HeapCalls = 0;
+	return a;
+}
+
+// <summary>
+// AnnihilateArena - frees up every block of the Arena and the Arena itself
+//                 - anything allocated from the Arena is gone after this; a NULL Arena is ignored
+// </summary>
+void AnnihilateArena(Arena * targetArena)
+{
+	if (targetArena == NULL) return;
+	ArenaBlock * b = targetArena->First;
+	while (b != NULL)
+	{
+		ArenaBlock * next = b->Next;
+		free(b);
+		b = next;
+	}
+	free(targetArena);
+	return;
+}
+
+// <summary>
+// ArenaReset - takes back everything allocated from the Arena in O(blocks)
+//            - blocks are kept, so a search that needs no more than the previous one makes no heap calls
+//            - a NULL Arena is ignored
+// </summary>
+void ArenaReset(Arena * targetArena)
+{
+	if (targetArena == NULL) return;
+	ArenaBlock * b;
+	for (b = targetArena->First; b != NULL; b = b->Next)
+	{
+		b->Used = 0;
+	}
+	targetArena->Current = targetArena->First;
+	targetArena->Last = NULL;
+	targetArena->Used = 0;
+	targetArena->Allocations = 0;
+}
+
+// <summary>
+// ArenaAlloc - hands out size bytes, aligned to ARENA_ALIGNMENT
+//            - if targetArena is NULL, falls back to malloc so containers work with or without an Arena
+//            - returns NULL if a new block is needed and there isn't enough memory for it
+// </summary>
+void * ArenaAlloc(Arena * targetArena, size_t size)
+{
+	if (targetArena == NULL) return malloc(size);
+	size = ArenaRound(size);
+	// Look for a block with enough room, starting with the current one
+	while (targetArena->Current != NULL && targetArena->Current->Size - targetArena->Current->Used < size)
+	{
+		targetArena->Current = targetArena->Current->Next;
+	}
+	if (targetArena->Current == NULL)
+	{
+		// Out of blocks; request a new one and append it to the list
+		size_t blockSize = (size > targetArena->BlockSize) ? size : targetArena->BlockSize;
+		ArenaBlock * b = malloc(sizeof(ArenaBlock) + ARENA_ALIGNMENT + blockSize);
+		if (b == NULL) return NULL;
+		b->Next = NULL;
+		b->Size = blockSize;
+		b->Used = 0;
+		b->Data = (unsigned char *)ArenaRound((size_t)(b + 1)); // first aligned address after the header
+		if (targetArena->First == NULL)
+		{
+			targetArena->First = b;
+		}
+		else
+		{
+			ArenaBlock * tail = targetArena->First;
+			while (tail->Next != NULL) tail = tail->Next;
+			tail->Next = b;
+		}
+		targetArena->Current = b;
+		targetArena->HeapCalls++;
+	}
+	void * p = targetArena->Current->Data + targetArena->Current->Used;
+	targetArena->Current->Used += size;
+	targetArena->Last = p;
+	targetArena->Used += size;
+	if (targetArena->Used > targetArena->HighWater) targetArena->HighWater = targetArena->Used;
+	targetArena->Allocations++;
+	return p;
+}
+
+// <summary>
+// ArenaGrow - the Arena's realloc: returns a block of newSize bytes holding the first oldSize bytes of p
+//           - the most recent allocation is extended in place if its block has room; otherwise the
+//             contents are copied into a fresh allocation and the old one is abandoned until the next reset
+//           - if targetArena is NULL, falls back to realloc
+//           - returns NULL, leaving p as it was, if there isn't enough memory
+// </summary>
+void * ArenaGrow(Arena * targetArena, void * p, size_t oldSize, size_t newSize)
+{
+	if (targetArena == NULL) return realloc(p, newSize);
+	if (p == NULL) return ArenaAlloc(targetArena, newSize);
+	oldSize = ArenaRound(oldSize);
+	newSize = ArenaRound(newSize);
+	if (newSize <= oldSize) return p;
+	ArenaBlock * b = targetArena->Current;
+	if (p == targetArena->Last && b != NULL && b->Size - b->Used >= newSize - oldSize)
+	{
+		b->Used += newSize - oldSize;
+		targetArena->Used += newSize - oldSize;
+		if (targetArena->Used > targetArena->HighWater) targetArena->HighWater = targetArena->Used;
+		return p;
+	}
+	void * q = ArenaAlloc(targetArena, newSize);
+	if (q == NULL) return NULL;
+	memcpy(q, p, oldSize);
+	return q;
+}
+
+// <summary>
+// ArenaFree - gives back memory from ArenaAlloc/ArenaGrow
+//           - a no-op for Arena memory (it comes back on the next reset); calls free if targetArena is NULL
+// </summary>
+void ArenaFree(Arena * targetArena, void * p)
+{
+	if (targetArena == NULL) free(p);
+	return;
+}
+
+// <summary>
+// ArenaRound - rounds size up to a multiple of ARENA_ALIGNMENT
+// </summary>
+size_t ArenaRound(size_t size)
+{
+	return (size + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1);
+}
@@ -0,0 +1,23 @@
+#!/bin/sh
+# 'batch_scaling.sh' - runs the same random queries on every map in input/ with 1..N threads
+#                    - Build: gcc -O2 -pthread -o app app.c -lm
+#                    - Usage: bench/batch_scaling.sh [threads] [queries per map] [strategy]
+#                    - Run from the repository root; threads defaults to the number of cores
+
+THREADS=${1:-$(getconf _NPROCESSORS_ONLN)}
+QUERIES=${2:-1000}
+STRATEGY=${3:-3}
+QUERYFILE=$(mktemp)
+trap 'rm -f "$QUERYFILE"' EXIT
+
+for MAP in input/*.txt; do
+    # Maps without a 'size' line are 400 x 200
+    SIZE=$(awk '$1 == "size" { print $2, $3; exit } { print 400, 200; exit }' "$MAP")
+    echo "$SIZE" | awk -v n="$QUERIES" -v s="$STRATEGY" -v seed=1 '{
+        srand(seed);
+        for (i = 0; i < n; i++)
+            printf "%d %d %d %d %d\n", int(rand() * $1), int(rand() * $2), int(rand() * $1), int(rand() * $2), s;
+    }' > "$QUERYFILE"
+    echo "== $MAP ($QUERIES queries, strategy $STRATEGY)"
+    ./app --batch "$MAP" "$QUERYFILE" --scaling "$THREADS" 2>/dev/null
+done
@@ -0,0 +1,109 @@
+#pragma once
+#include "../cardinal.h"
+#include "../polygon.h"
+#include "../raster.h"
+#include "../grid.h"
+#include "../search.h"
+#include "../executor.h" // wallTime(), wallNanoseconds()
+#include "../scanner.h"
+
+/*  BENCH HELPERS
+ *  What every bench needs: a clock (wallTime() and wallNanoseconds() from executor.h), a random number generator
+ *  that gives the same numbers on every run, and a map read the way the app reads it, through the scanner, with
+ *  the same checks: a bad size, a negative vertex count, or a number that doesn't fit in an int makes the map
+ *  unreadable instead of being read as something else.
+ */
+
+uint32_t nextRandom(uint32_t * state);
+Grid * readMap(const char * filename, coordinate * start, coordinate * goal);
+Grid * scanMap(Scanner * scanner, coordinate * start, coordinate * goal);
+
+/*
+ * nextRandom() - xorshift32; the same seed gives the same numbers on every run
+ */
+uint32_t nextRandom(uint32_t * state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/*
+ * readMap() - reads the size, start, goal and polygons of a map file and returns the rasterized map, with its
+ *             polygons kept, the way the app does; start and goal may be NULL if the map's own query isn't needed
+ *           - the regions aren't labelled, so that a bench can time that itself
+ *           - says so on stderr and returns NULL if the file can't be read, is malformed, or the map doesn't fit in
+ *             memory; a file that ends partway through a polygon keeps the vertices read so far
+ */
+Grid * readMap(const char * filename, coordinate * start, coordinate * goal)
+{
+    FILE * f = fopen(filename, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "Failed to open '%s'\n", filename);
+        return NULL;
+    }
+    Scanner * scanner = createScanner(f);
+    Grid * grid = (scanner != NULL) ? scanMap(scanner, start, goal) : NULL;
+    destroyScanner(scanner);
+    fclose(f);
+    if (grid == NULL) fprintf(stderr, "Failed to read '%s': malformed, or too big for memory\n", filename);
+    return grid;
+}
+
+/*
+ * scanMap() - readMap() from the scanner of an open map file; NULL if it's malformed or doesn't fit in memory
+ */
+Grid * scanMap(Scanner * scanner, coordinate * start, coordinate * goal)
+{
+    int width = GRID_DEFAULT_WIDTH, height = GRID_DEFAULT_HEIGHT, n, scanned;
+    unsigned int i, capacity = 0;
+    coordinate from, to;
+    if (scanKeyword(scanner, "size")
+        && (scanInt(scanner, &width) != SCAN_OK || scanInt(scanner, &height) != SCAN_OK || width <= 0 || height <= 0))
+    {
+        return NULL;
+    }
+    Grid * grid = CreateNewGrid(width, height);
+    if (grid == NULL) return NULL;
+    if (scanInt(scanner, &from.x) != SCAN_OK || scanInt(scanner, &from.y) != SCAN_OK
+        || scanInt(scanner, &to.x) != SCAN_OK || scanInt(scanner, &to.y) != SCAN_OK)
+    {
+        AnnihilateGrid(grid);
+        return NULL;
+    }
+    coordinate * vertices = NULL; // Grown as vertices come, not by the count in the file
+    bool ok = true;
+    while (ok && (scanned = scanInt(scanner, &n)) == SCAN_OK)
+    {
+        ok = (n >= 0);
+        for (i = 0; ok && i < (unsigned int)n; i++)
+        {
+            if (i == capacity)
+            {
+                capacity = (capacity > 0) ? capacity * 2 : 64;
+                coordinate * grown = realloc(vertices, capacity * sizeof(coordinate));
+                ok = (grown != NULL);
+                if (!ok) break;
+                vertices = grown;
+            }
+            scanned = scanInt(scanner, &(vertices[i].x));
+            if (scanned == SCAN_OK) scanned = scanInt(scanner, &(vertices[i].y));
+            if (scanned == SCAN_BAD) ok = false;
+            if (scanned != SCAN_OK) break; // Cut short at the end of the file
+        }
+        if (!ok) break;
+        rasterizePolygon(vertices, i, RASTER_OUTLINE, grid->Blocked, grid->Width, grid->Height, 1);
+        AddGridPolygon(grid, vertices, i);
+    }
+    free(vertices);
+    if (!ok || scanned == SCAN_BAD) // Not the end of the file, so not the end of the map either
+    {
+        AnnihilateGrid(grid);
+        return NULL;
+    }
+    if (start != NULL) *start = from;
+    if (goal != NULL) *goal = to;
+    return grid;
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+'bitboard_bench.c' - times the distance fields and the reachability of
+                     the bitboard BFS in bitbfs.h against landmarkBFS()
+                     from the same random tiles, and checks that every
+                     distance matches and that both reach exactly the tiles
+                     of the root's region
+                   - Build: gcc -O2 -pthread -o bitboard_bench bench/bitboard_bench.c -lm
+                            (add -mavx2 to let the row loop use AVX2)
+                   - Usage: ./bitboard_bench [roots] input/1.txt input/6.txt ...
+*****************************************************************************/
+
+#include "bench.h"
+
+void benchFile(const char * filename, int roots);
+
+int main(int argc, char * argv[])
+{
+    int roots = 20;
+    int first = 1;
+    int i;
+    if (argc > 1 && atoi(argv[1]) > 0)
+    {
+        roots = atoi(argv[1]);
+        first = 2;
+    }
+    if (first >= argc)
+    {
+        fprintf(stderr, "Usage: %s [roots] map.txt ...\n", argv[0]);
+        return 1;
+    }
+    printf("%-10s %11s %8s %11s %11s %8s %11s %8s %9s\n", "map", "board (ms)", "roots", "queue (ms)", "bits (ms)",
+        "speedup", "reach (ms)", "speedup", "mismatch");
+    for (i = first; i < argc; i++)
+    {
+        benchFile(argv[i], roots);
+    }
+    return 0;
+}
+
+/*
+ * benchFile() - builds the map's bitboard, then fills a distance field from each of a number of random open tiles
+ *               with landmarkBFS() and with bitDistances(), and finds the tiles they reach with bitReach()
+ *             - prints the total time of each, and the number of roots for which the fields differ anywhere, or
+ *               either bitboard search doesn't reach exactly the tiles of the field or as many as the root's region
+ *               has according to the map's component labels
+ */
+void benchFile(const char * filename, int roots)
+{
+    Grid * grid = readMap(filename, NULL, NULL);
+    if (grid == NULL) return;
+    size_t cells = (size_t)grid->Width * grid->Height;
+    uint16_t * expected = malloc(cells * sizeof(uint16_t));
+    uint16_t * actual = malloc(cells * sizeof(uint16_t));
+    int32_t * queue = malloc(cells * sizeof(int32_t));
+    double t = wallTime();
+    BitBoard * board = createBitBoard(grid);
+    double boardTime = wallTime() - t;
+    if (expected == NULL || actual == NULL || queue == NULL || board == NULL || !LabelGridComponents(grid))
+    {
+        fprintf(stderr, "Not enough memory for '%s'\n", filename);
+        return;
+    }
+    uint32_t seed = 2463534242u;
+    double queueTime = 0, bitsTime = 0, reachTime = 0;
+    int i, mismatch = 0;
+    for (i = 0; i < roots; i++)
+    {
+        size_t root;
+        do
+        {
+            root = nextRandom(&seed) % cells;
+        } while (grid->Blocked[root]); // landmarkBFS() would start from a blocked one anyway
+        t = wallTime();
+        landmarkBFS(grid, root, expected, 1, queue);
+        queueTime += wallTime() - t;
+        t = wallTime();
+        size_t reached = bitDistances(board, root, actual, 1);
+        bitsTime += wallTime() - t;
+        size_t region = grid->Components->Size[grid->Components->Label[root]];
+        bool same = memcmp(expected, actual, cells * sizeof(uint16_t)) == 0 && reached == region;
+        t = wallTime();
+        reached = bitReach(board, root);
+        reachTime += wallTime() - t;
+        size_t c;
+        for (c = 0; c < cells && same; c++)
+        {
+            same = bitReached(board, c % grid->Width, c / grid->Width) == (expected[c] != BITBFS_UNREACHABLE);
+        }
+        if (!same || reached != region) mismatch++;
+    }
+    const char * base = strrchr(filename, '/');
+    base = (base != NULL) ? base + 1 : filename;
+    printf("%-10s %11.3f %8d %11.2f %11.2f %7.2fx %11.2f %7.2fx %9d\n", base, boardTime * 1000.0, roots,
+        queueTime * 1000.0, bitsTime * 1000.0, (bitsTime > 0) ? queueTime / bitsTime : 0.0, reachTime * 1000.0,
+        (reachTime > 0) ? queueTime / reachTime : 0.0, mismatch);
+    destroyBitBoard(board);
+    free(expected);
+    free(actual);
+    free(queue);
+    AnnihilateGrid(grid);
+}
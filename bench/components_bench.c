@@ -0,0 +1,153 @@
+/****************************************************************************
+'components_bench.c' - times the connected-component labels in components.h:
+                       labelling a map, turning down unreachable queries
+                       with them against the bitboard sweep searches fall
+                       back on without them (see searchConnected()), and
+                       keeping them up to date as random tiles are blocked
+                       and freed against labelling from scratch
+                     - Build: gcc -O2 -pthread -o components_bench bench/components_bench.c -lm
+                     - Usage: ./components_bench [updates] input/1.txt input/6.txt ...
+*****************************************************************************/
+
+#include "bench.h"
+
+#define BENCH_QUERIES 50 // unreachable queries per map; without the labels, each new start region costs a sweep
+
+bool sameRegions(ComponentLabels * a, ComponentLabels * b, uint32_t * seen);
+void benchFile(const char * filename, int updates);
+
+int main(int argc, char * argv[])
+{
+    int updates = 10000;
+    int first = 1;
+    int i;
+    if (argc > 1 && atoi(argv[1]) > 0)
+    {
+        updates = atoi(argv[1]);
+        first = 2;
+    }
+    if (first >= argc)
+    {
+        fprintf(stderr, "Usage: %s [updates] map.txt ...\n", argv[0]);
+        return 1;
+    }
+    printf("%-10s %8s %11s %8s %15s %13s %8s %10s %10s %9s\n", "map", "regions", "label (ms)", "queries", "unlabelled (us)",
+        "labelled (us)", "updates", "update (us)", "relabel (us)", "mismatch");
+    for (i = first; i < argc; i++)
+    {
+        benchFile(argv[i], updates);
+    }
+    return 0;
+}
+
+/*
+ * sameRegions() - true if two labellings of the same map split its free tiles into the same regions, whatever
+ *                 the numbers they gave them; seen needs 2 entries per label either of them can hand out
+ */
+bool sameRegions(ComponentLabels * a, ComponentLabels * b, uint32_t * seen)
+{
+    size_t cells = (size_t)a->Width * a->Height;
+    size_t labels = cells + COMPONENT_SEEDS + 1;
+    size_t i;
+    memset(seen, 0, 2 * labels * sizeof(uint32_t));
+    for (i = 0; i < cells; i++)
+    {
+        uint32_t la = a->Label[i], lb = b->Label[i];
+        if ((la == 0) != (lb == 0)) return false;
+        if (la == 0) continue;
+        // Each label of a must always meet the same label of b, and the other way around
+        if (seen[la] == 0) seen[la] = lb;
+        if (seen[labels + lb] == 0) seen[labels + lb] = la;
+        if (seen[la] != lb || seen[labels + lb] != la) return false;
+    }
+    return true;
+}
+
+/*
+ * benchFile() - labels the map, then answers random queries whose goal is in another region than the start with
+ *               A*, with and without the labels (where the context's bitboard turns them down); then blocks and frees random tiles, in turn, and after each one
+ *               checks the updated labels against a labelling from scratch
+ *             - prints the mean times per query and per update, and the number of updates after which the two
+ *               labellings disagree
+ */
+void benchFile(const char * filename, int updates)
+{
+    Grid * grid = readMap(filename, NULL, NULL);
+    if (grid == NULL) return;
+    size_t cells = (size_t)grid->Width * grid->Height;
+    SearchContext * ctx = createSearchContext(grid);
+    uint32_t * seen = malloc(2 * (cells + COMPONENT_SEEDS + 1) * sizeof(uint32_t));
+    double t = wallTime();
+    if (ctx == NULL || seen == NULL || !LabelGridComponents(grid) || !reserveStrategy(ctx, STRAT_ASTAR))
+    {
+        fprintf(stderr, "Not enough memory for '%s'\n", filename);
+        return;
+    }
+    double labelTime = wallTime() - t;
+    uint32_t regions = grid->Components->Count;
+    uint32_t seed = 2463534242u;
+    coordinate ends[2 * BENCH_QUERIES];
+    int queries = 0, i;
+    // Pairs of free tiles in different regions; a map with a single region has none
+    for (i = 0; i < 100000 && queries < BENCH_QUERIES && regions > 1; i++)
+    {
+        coordinate a = {nextRandom(&seed) % grid->Width, nextRandom(&seed) % grid->Height};
+        coordinate b = {nextRandom(&seed) % grid->Width, nextRandom(&seed) % grid->Height};
+        if (grid->Blocked[(size_t)a.y * grid->Width + a.x] || grid->Blocked[(size_t)b.y * grid->Width + b.x]) continue;
+        if (GridConnected(grid, a, b)) continue;
+        ends[2 * queries] = a;
+        ends[2 * queries + 1] = b;
+        queries++;
+    }
+    double searchTime = 0, labelledTime = 0;
+    ComponentLabels * labels = grid->Components;
+    int wrong = 0;
+    for (i = 0; i < queries; i++)
+    {
+        grid->Components = NULL; // Search without the labels
+        t = wallTime();
+        SearchResult result = runSearch(ctx, STRAT_ASTAR, FRINGE_BUCKET, ends[2 * i], ends[2 * i + 1]);
+        searchTime += wallTime() - t;
+        if (result.Found) wrong++;
+        grid->Components = labels;
+        t = wallTime();
+        result = runSearch(ctx, STRAT_ASTAR, FRINGE_BUCKET, ends[2 * i], ends[2 * i + 1]);
+        labelledTime += wallTime() - t;
+        if (!result.Unreachable) wrong++;
+    }
+    // Updates: block a random free tile, then free a random blocked one, and so on
+    ComponentLabels * fresh = CreateComponentLabels(grid->Blocked, grid->Width, grid->Height);
+    double updateTime = 0, relabelTime = 0;
+    int mismatch = 0;
+    for (i = 0; i < updates && fresh != NULL; i++)
+    {
+        unsigned int x, y;
+        do
+        {
+            x = nextRandom(&seed) % grid->Width;
+            y = nextRandom(&seed) % grid->Height;
+        } while (grid->Blocked[(size_t)y * grid->Width + x] != (i % 2));
+        t = wallTime();
+        SetGridCell(grid, x, y, !(i % 2));
+        updateTime += wallTime() - t;
+        if (grid->Components == NULL) break; // Out of memory
+        size_t c;
+        for (c = 0; c < cells; c++) // Only blocked or not matters to the relabelling
+        {
+            fresh->Label[c] = !grid->Blocked[c];
+        }
+        t = wallTime();
+        RelabelComponents(fresh);
+        relabelTime += wallTime() - t;
+        if (!sameRegions(grid->Components, fresh, seen)) mismatch++;
+    }
+    const char * base = strrchr(filename, '/');
+    base = (base != NULL) ? base + 1 : filename;
+    printf("%-10s %8u %11.3f %8d %15.2f %13.3f %8d %10.3f %10.2f %9d\n", base, regions, labelTime * 1000.0, queries,
+        (queries > 0) ? searchTime * 1e6 / queries : 0.0, (queries > 0) ? labelledTime * 1e6 / queries : 0.0, i,
+        (i > 0) ? updateTime * 1e6 / i : 0.0, (i > 0) ? relabelTime * 1e6 / i : 0.0, mismatch + wrong);
+    if (fresh != NULL) AnnihilateComponentLabels(fresh);
+    free(seen);
+    destroySearchContext(ctx);
+    AnnihilateGrid(grid);
+}
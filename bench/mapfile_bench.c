@@ -0,0 +1,152 @@
+/****************************************************************************
+'mapfile_bench.c' - times reading a map from its text (parsing, rasterizing
+                    and labelling its regions) against mapping its compiled
+                    map from mapfile.h, and checks that both give the same
+                    grid, and that the mapped one can still be changed
+                  - Build: gcc -O2 -pthread -o mapfile_bench bench/mapfile_bench.c -lm
+                  - Usage: ./mapfile_bench [runs] input/1.txt input/6.txt ...
+                           (writes and removes /tmp/mapfile_bench.bin)
+*****************************************************************************/
+
+#include "bench.h"
+#include "../mapfile.h"
+
+#define BENCH_COMPILED "/tmp/mapfile_bench.bin"
+#define BENCH_UPDATES 1000 // tiles blocked and freed on the mapped grid
+
+Grid * readLabelledMap(const char * filename, coordinate * start, coordinate * goal, uint64_t * sourceHash);
+bool sameGrid(Grid * a, Grid * b);
+void benchFile(const char * filename, int runs);
+
+int main(int argc, char * argv[])
+{
+    int runs = 20;
+    int first = 1;
+    int i;
+    if (argc > 1 && atoi(argv[1]) > 0)
+    {
+        runs = atoi(argv[1]);
+        first = 2;
+    }
+    if (first >= argc)
+    {
+        fprintf(stderr, "Usage: %s [runs] map.txt ...\n", argv[0]);
+        return 1;
+    }
+    printf("%-10s %10s %8s %10s %10s %8s %9s\n", "map", "size (KB)", "runs", "read (ms)", "map (ms)", "speedup",
+        "mismatch");
+    for (i = first; i < argc; i++)
+    {
+        benchFile(argv[i], runs);
+    }
+    return 0;
+}
+
+/*
+ * readLabelledMap() - reads a map file the way the app does when there's no compiled map: scanMap(), then the
+ *                     regions labelled; sets sourceHash to the hash of its text; NULL if the file can't be read
+ */
+Grid * readLabelledMap(const char * filename, coordinate * start, coordinate * goal, uint64_t * sourceHash)
+{
+    FILE * f = fopen(filename, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "Failed to open '%s'\n", filename);
+        return NULL;
+    }
+    *sourceHash = hashMapSource(f);
+    Scanner * scanner = createScanner(f);
+    Grid * grid = (scanner != NULL) ? scanMap(scanner, start, goal) : NULL;
+    destroyScanner(scanner);
+    fclose(f);
+    if (grid != NULL && !LabelGridComponents(grid))
+    {
+        AnnihilateGrid(grid);
+        grid = NULL;
+    }
+    if (grid == NULL) fprintf(stderr, "Failed to read '%s': malformed, or too big for memory\n", filename);
+    return grid;
+}
+
+/*
+ * sameGrid() - true if two grids have the same obstacles, polygons and component labels
+ */
+bool sameGrid(Grid * a, Grid * b)
+{
+    size_t cells = (size_t)a->Width * a->Height;
+    if (a->Width != b->Width || a->Height != b->Height || a->PolygonCount != b->PolygonCount) return false;
+    if (memcmp(a->Blocked, b->Blocked, cells) != 0) return false;
+    if (a->PolygonCount > 0)
+    {
+        unsigned int vertices = a->PolygonEnds[a->PolygonCount - 1];
+        if (memcmp(a->PolygonEnds, b->PolygonEnds, a->PolygonCount * sizeof(unsigned int)) != 0) return false;
+        if (memcmp(a->Vertices, b->Vertices, vertices * sizeof(coordinate)) != 0) return false;
+    }
+    if (a->Components->Count != b->Components->Count) return false;
+    return memcmp(a->Components->Label, b->Components->Label, cells * sizeof(uint32_t)) == 0;
+}
+
+/*
+ * benchFile() - compiles the map, then reads it from its text and maps the compiled one, a number of times each,
+ *               and compares the grids; then blocks and frees random tiles of a mapped grid and of a read one
+ *             - prints the size of the compiled map, the mean time of each way, and the number of mapped grids that
+ *               didn't match the read one, before and after the updates
+ */
+void benchFile(const char * filename, int runs)
+{
+    coordinate start, goal, s, g;
+    uint64_t sourceHash;
+    Grid * grid = readLabelledMap(filename, &start, &goal, &sourceHash);
+    if (grid == NULL) return;
+    if (!saveCompiledMap(grid, start, goal, sourceHash, BENCH_COMPILED))
+    {
+        fprintf(stderr, "Failed to write '%s'\n", BENCH_COMPILED);
+        AnnihilateGrid(grid);
+        return;
+    }
+    double readTime = 0, mapTime = 0, t;
+    int i, mismatch = 0;
+    for (i = 0; i < runs; i++)
+    {
+        uint64_t hash;
+        t = wallTime();
+        Grid * read = readLabelledMap(filename, &s, &g, &hash);
+        readTime += wallTime() - t;
+        AnnihilateGrid(read);
+        t = wallTime();
+        Grid * mapped = openCompiledMap(BENCH_COMPILED, sourceHash, &s, &g);
+        mapTime += wallTime() - t;
+        if (mapped == NULL || !sameGrid(grid, mapped) || s.x != start.x || s.y != start.y || g.x != goal.x
+            || g.y != goal.y)
+        {
+            mismatch++;
+        }
+        if (mapped != NULL) AnnihilateGrid(mapped);
+    }
+    // The mapped labels are updated in place, in the private copy of the mapping
+    Grid * mapped = openCompiledMap(BENCH_COMPILED, sourceHash, &s, &g);
+    uint32_t seed = 2463534242u;
+    for (i = 0; i < BENCH_UPDATES && mapped != NULL; i++)
+    {
+        unsigned int x = nextRandom(&seed) % grid->Width, y = nextRandom(&seed) % grid->Height;
+        uint8_t blocked = !grid->Blocked[(size_t)y * grid->Width + x];
+        SetGridCell(grid, x, y, blocked);
+        SetGridCell(mapped, x, y, blocked);
+    }
+    if (mapped == NULL || grid->Components == NULL || mapped->Components == NULL
+        || grid->Components->Count != mapped->Components->Count
+        || memcmp(grid->Components->Label, mapped->Components->Label,
+            (size_t)grid->Width * grid->Height * sizeof(uint32_t)) != 0)
+    {
+        mismatch++;
+    }
+    struct stat info;
+    stat(BENCH_COMPILED, &info);
+    const char * base = strrchr(filename, '/');
+    base = (base != NULL) ? base + 1 : filename;
+    printf("%-10s %10.1f %8d %10.3f %10.3f %7.2fx %9d\n", base, info.st_size / 1024.0, runs, readTime * 1000.0 / runs,
+        mapTime * 1000.0 / runs, (mapTime > 0) ? readTime / mapTime : 0.0, mismatch);
+    if (mapped != NULL) AnnihilateGrid(mapped);
+    AnnihilateGrid(grid);
+    remove(BENCH_COMPILED);
+}
@@ -0,0 +1,119 @@
+/****************************************************************************
+'parallel_bfs_bench.c' - times the level-synchronous BFS in pbfs.h against
+                         BFS() on the same random queries, for each way of
+                         expanding the levels, and checks that both leave
+                         the same path, tile states and predecessors
+                       - Build: gcc -O2 -pthread -o parallel_bfs_bench bench/parallel_bfs_bench.c -lm
+                       - Usage: ./parallel_bfs_bench [threads] input/1.txt input/6.txt ...
+*****************************************************************************/
+
+#include "bench.h"
+#include "../pbfs.h"
+#include <unistd.h> // sysconf()
+
+#define BENCH_QUERIES 20 // the map's own query, then random ones; some of them have no path
+
+bool sameSearch(SearchContext * a, SearchResult * ra, SearchContext * b, SearchResult * rb);
+void benchFile(const char * filename, unsigned int threads, int mode);
+
+int main(int argc, char * argv[])
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int threads = (cores > 0) ? cores : 1;
+    int first = 1;
+    int i, mode;
+    if (argc > 1 && atoi(argv[1]) > 0)
+    {
+        threads = atoi(argv[1]);
+        first = 2;
+    }
+    if (first >= argc)
+    {
+        fprintf(stderr, "Usage: %s [threads] map.txt ...\n", argv[0]);
+        return 1;
+    }
+    printf("%-10s %8s %-10s %8s %10s %10s %8s %9s\n", "map", "threads", "levels", "queries", "BFS (ms)",
+        "level (ms)", "speedup", "mismatch");
+    for (i = first; i < argc; i++)
+    {
+        for (mode = PBFS_AUTO; mode <= PBFS_BOTTOM_UP; mode++)
+        {
+            benchFile(argv[i], threads, mode);
+        }
+    }
+    return 0;
+}
+
+/*
+ * sameSearch() - true if two searches on the same map found the same thing: result, path, the state of every
+ *                tile, and the predecessor of every tile they reached
+ */
+bool sameSearch(SearchContext * a, SearchResult * ra, SearchContext * b, SearchResult * rb)
+{
+    unsigned int x, y, i;
+    if (ra->Found != rb->Found || ra->Expanded != rb->Expanded || ra->Path->Depth != rb->Path->Depth) return false;
+    if (ra->Final.x != rb->Final.x || ra->Final.y != rb->Final.y) return false;
+    for (i = 0; i < ra->Path->Depth; i++)
+    {
+        if (ra->Path->Data[i].x != rb->Path->Data[i].x || ra->Path->Data[i].y != rb->Path->Data[i].y) return false;
+    }
+    for (y = 0; y < a->Map->Height; y++)
+    {
+        for (x = 0; x < a->Map->Width; x++)
+        {
+            unsigned int state = getTile(a, x, y);
+            if (state != getTile(b, x, y)) return false;
+            if (state == UNEXPLORED || state == BLOCKED) continue;
+            coordinate pa = getPred(a, x, y), pb = getPred(b, x, y);
+            if (pa.x != pb.x || pa.y != pb.y) return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * benchFile() - answers the same queries with BFS() and with the level-synchronous BFS, on separate contexts, and
+ *               compares every search
+ *             - prints the total time of each, and the number of queries on which they disagree
+ */
+void benchFile(const char * filename, unsigned int threads, int mode)
+{
+    static const char * modes[] = {"auto", "top-down", "bottom-up"};
+    coordinate start, goal;
+    Grid * grid = readMap(filename, &start, &goal);
+    if (grid == NULL) return;
+    SearchContext * serial = createSearchContext(grid);
+    SearchContext * levels = createSearchContext(grid);
+    if (serial == NULL || levels == NULL)
+    {
+        fprintf(stderr, "Not enough memory for '%s'\n", filename);
+        return;
+    }
+    uint32_t seed = 2463534242u;
+    double serialTime = 0, levelTime = 0;
+    int i, mismatch = 0;
+    for (i = 0; i < BENCH_QUERIES; i++)
+    {
+        if (i > 0)
+        {
+            start.x = nextRandom(&seed) % grid->Width;
+            start.y = nextRandom(&seed) % grid->Height;
+            goal.x = nextRandom(&seed) % grid->Width;
+            goal.y = nextRandom(&seed) % grid->Height;
+        }
+        double t = wallTime();
+        SearchResult a = runSearch(serial, STRAT_BFS, FRINGE_BUCKET, start, goal);
+        serialTime += wallTime() - t;
+        t = wallTime();
+        SearchResult b = parallelBFS(levels, threads, mode, start, goal);
+        levelTime += wallTime() - t;
+        if (!sameSearch(serial, &a, levels, &b)) mismatch++;
+    }
+    const char * base = strrchr(filename, '/');
+    base = (base != NULL) ? base + 1 : filename;
+    printf("%-10s %8u %-10s %8d %10.2f %10.2f %7.2fx %9d\n", base, threads, modes[mode], BENCH_QUERIES,
+        serialTime * 1000.0, levelTime * 1000.0, (levelTime > 0) ? serialTime / levelTime : 0.0, mismatch);
+    destroySearchContext(serial);
+    destroySearchContext(levels);
+    AnnihilateGrid(grid);
+}
@@ -0,0 +1,170 @@
+/****************************************************************************
+'raster_bench.c' - times the map-building step: the old per-pixel inLine()
+                   loop against the scanline rasterizer in raster.h
+                 - Build: gcc -O2 -o raster_bench bench/raster_bench.c -lm
+                 - Usage: ./raster_bench [repeats] input/1.txt input/5.txt ...
+*****************************************************************************/
+
+#include "../cardinal.h"
+#include "../polygon.h"
+#include "../raster.h"
+#include <time.h> // clock_gettime(), CLOCK_MONOTONIC
+
+#define H 200
+#define W 400
+
+uint8_t legacyGrid[H][W];
+uint8_t scanGrid[H][W];
+
+double now();
+void rasterizeLegacy(coordinate * vertices, unsigned int n, uint8_t * cells);
+void benchFile(const char * filename, int repeats);
+
+int main(int argc, char * argv[])
+{
+    int repeats = 20;
+    int first = 1;
+    int i;
+    if (argc > 1 && atoi(argv[1]) > 0)
+    {
+        repeats = atoi(argv[1]);
+        first = 2;
+    }
+    if (first >= argc)
+    {
+        fprintf(stderr, "Usage: %s [repeats] map.txt ...\n", argv[0]);
+        return 1;
+    }
+    printf("%-16s %14s %14s %14s %8s %10s\n", "map", "legacy (ms)", "outline (ms)", "filled (ms)", "speedup", "mismatch");
+    for (i = first; i < argc; i++)
+    {
+        benchFile(argv[i], repeats);
+    }
+    return 0;
+}
+
+/*
+ * now() - monotonic wall-clock time in seconds
+ */
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * rasterizeLegacy() - the map-building loop main() used before raster.h: builds the polygon's edges and then
+ *                     tests every cell of the grid against every edge with inLine()
+ */
+void rasterizeLegacy(coordinate * vertices, unsigned int n, uint8_t * cells)
+{
+    unsigned int i, j, k;
+    line * e = malloc(n * sizeof(line));
+    for (i = 0; i < n; i++)
+    {
+        coordinate nv = vertices[(i + 1) % n]; // Get next vertex
+        e[i].m = getSlope(vertices[i], nv);
+        e[i].b = getYIntercept(vertices[i], e[i].m);
+        e[i].x = (nv.x == vertices[i].x) ? nv.x : -1;
+        e[i].one = vertices[i];
+        e[i].two = nv;
+    }
+    polygon p;
+    p.edges = e;
+    for (i = 0; i < H; i++)
+    {
+        for (j = 0; j < W; j++)
+        {
+            for (k = 0; k < n; k++)
+            {
+                coordinate c;
+                c.x = j;
+                c.y = i;
+                if (inLine(c, &(p.edges[k])))
+                {
+                    cells[i * W + j] = 1;
+                    break;
+                }
+            }
+        }
+    }
+    free(e);
+}
+
+/*
+ * benchFile() - reads every polygon of a map file, then rasterizes all of them 'repeats' times with each method
+ *             - prints the mean time per map build and the number of cells on which the two outlines disagree
+ */
+void benchFile(const char * filename, int repeats)
+{
+    FILE * f = fopen(filename, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "Failed to open '%s'\n", filename);
+        return;
+    }
+    int sx, sy, gx, gy;
+    if (fscanf(f, "%d %d %d %d", &sx, &sy, &gx, &gy) != 4)
+    {
+        fclose(f);
+        return;
+    }
+    // Read all polygons into one vertex array; counts[p] = number of vertices of polygon p
+    unsigned int total = 0, polygons = 0, capacity = 64, countCapacity = 16, n, i;
+    coordinate * vertices = malloc(capacity * sizeof(coordinate));
+    unsigned int * counts = malloc(countCapacity * sizeof(unsigned int));
+    while (fscanf(f, "%u", &n) > 0)
+    {
+        if (polygons == countCapacity)
+        {
+            countCapacity *= 2;
+            counts = realloc(counts, countCapacity * sizeof(unsigned int));
+        }
+        counts[polygons++] = n;
+        for (i = 0; i < n; i++)
+        {
+            if (total == capacity)
+            {
+                capacity *= 2;
+                vertices = realloc(vertices, capacity * sizeof(coordinate));
+            }
+            if (fscanf(f, "%d %d", &(vertices[total].x), &(vertices[total].y)) != 2) break;
+            total++;
+        }
+    }
+    fclose(f);
+
+    double times[3];
+    int mode, r;
+    unsigned int p, offset, c;
+    unsigned int mismatch = 0;
+    for (mode = 0; mode < 3; mode++)
+    {
+        double t = now();
+        for (r = 0; r < repeats; r++)
+        {
+            uint8_t * cells = (mode == 0) ? &legacyGrid[0][0] : &scanGrid[0][0];
+            memset(cells, 0, H * W);
+            for (p = 0, offset = 0; p < polygons; offset += counts[p], p++)
+            {
+                if (mode == 0) rasterizeLegacy(vertices + offset, counts[p], cells);
+                else rasterizePolygon(vertices + offset, counts[p], (mode == 1) ? RASTER_OUTLINE : RASTER_FILLED, cells, W, H, 1);
+            }
+        }
+        times[mode] = (now() - t) * 1000.0 / repeats;
+        if (mode == 1)
+        {
+            // Compare outlines now, before the filled run overwrites scanGrid
+            for (c = 0; c < H * W; c++)
+            {
+                if ((&legacyGrid[0][0])[c] != (&scanGrid[0][0])[c]) mismatch++;
+            }
+        }
+    }
+    const char * base = strrchr(filename, '/');
+    base = (base != NULL) ? base + 1 : filename;
+    printf("%-16s %14.4f %14.4f %14.4f %7.0fx %10u\n", base, times[0], times[1], times[2], times[0] / times[1], mismatch);
+    free(vertices);
+    free(counts);
+}
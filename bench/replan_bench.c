@@ -0,0 +1,104 @@
+/****************************************************************************
+'replan_bench.c' - times replanning after obstacles appear: the D* Lite
+                   repair in dstar.h against a fresh A* search on the
+                   changed map, over a sequence of random insertions
+                 - Build: gcc -O2 -pthread -o replan_bench bench/replan_bench.c -lm
+                 - Usage: ./replan_bench [insertions] input/1.txt input/6.txt ...
+*****************************************************************************/
+
+#include "bench.h"
+#include "../dstar.h"
+
+#define ON_PATH 0 // every new obstacle lands on the current path, so every one forces a repair
+#define ANYWHERE 1 // new obstacles land on random open tiles, most of them nowhere near the path
+
+void benchFile(const char * filename, int insertions, int placement);
+
+int main(int argc, char * argv[])
+{
+    int insertions = 100;
+    int first = 1;
+    int i;
+    if (argc > 1 && atoi(argv[1]) > 0)
+    {
+        insertions = atoi(argv[1]);
+        first = 2;
+    }
+    if (first >= argc)
+    {
+        fprintf(stderr, "Usage: %s [insertions] map.txt ...\n", argv[0]);
+        return 1;
+    }
+    printf("%-10s %-8s %6s %11s %11s %13s %12s %8s %9s\n", "map", "blocks", "runs", "first (ms)", "A* (ms)",
+        "replan (ms)", "A* expanded", "D* exp.", "mismatch");
+    for (i = first; i < argc; i++)
+    {
+        benchFile(argv[i], insertions, ON_PATH);
+        benchFile(argv[i], insertions, ANYWHERE);
+    }
+    return 0;
+}
+
+/*
+ * benchFile() - plans the map's own query once with D* Lite, then blocks one tile at a time and after each one
+ *               repairs the plan and also searches the changed map from scratch with A*
+ *             - prints the time of the first plan, the mean times and expansions per obstacle, and the number of
+ *               obstacles after which the two disagree on the cost
+ */
+void benchFile(const char * filename, int insertions, int placement)
+{
+    coordinate start, goal;
+    Grid * grid = readMap(filename, &start, &goal);
+    if (grid == NULL) return;
+    SearchContext * ctx = createSearchContext(grid);
+    Replanner * r = createReplanner(grid, start, goal);
+    Stack * path = CreateNewStack();
+    if (ctx == NULL || r == NULL || !reserveStrategy(ctx, STRAT_ASTAR))
+    {
+        fprintf(stderr, "Not enough memory for '%s'\n", filename);
+        return;
+    }
+    uint32_t seed = 2463534242u;
+    int expanded, runs, mismatch = 0;
+    double replanTime = 0, astarTime = 0;
+    long replanExpanded = 0, astarExpanded = 0;
+    double t = wallTime();
+    replan(r, &expanded);
+    double firstTime = wallTime() - t;
+    for (runs = 0; runs < insertions; runs++)
+    {
+        coordinate block;
+        path->Depth = 0;
+        if (placement == ON_PATH && replannedPath(r, path) && path->Depth > 2)
+        {
+            block = path->Data[1 + nextRandom(&seed) % (path->Depth - 2)]; // Anything but the start and the goal
+        }
+        else
+        {
+            do
+            {
+                block.x = nextRandom(&seed) % grid->Width;
+                block.y = nextRandom(&seed) % grid->Height;
+            } while ((block.x == start.x && block.y == start.y) || (block.x == goal.x && block.y == goal.y));
+        }
+        replanCells(r, &block, 1, 1);
+        t = wallTime();
+        int cost = replan(r, &expanded);
+        replanTime += wallTime() - t;
+        replanExpanded += expanded;
+        t = wallTime();
+        SearchResult result = runSearch(ctx, STRAT_ASTAR, FRINGE_BUCKET, start, goal);
+        astarTime += wallTime() - t;
+        astarExpanded += result.Expanded;
+        if (cost != (result.Found ? (int)result.Path->Depth - 1 : -1)) mismatch++;
+    }
+    const char * base = strrchr(filename, '/');
+    base = (base != NULL) ? base + 1 : filename;
+    printf("%-10s %-8s %6d %11.4f %11.4f %13.4f %12ld %8ld %9d\n", base, (placement == ON_PATH) ? "on path" : "anywhere",
+        runs, firstTime * 1000.0, astarTime * 1000.0 / runs, replanTime * 1000.0 / runs, astarExpanded / runs,
+        replanExpanded / runs, mismatch);
+    AnnihilateStack(path);
+    destroyReplanner(r);
+    destroySearchContext(ctx);
+    AnnihilateGrid(grid);
+}
@@ -0,0 +1,396 @@
+/****************************************************************************
+'strategy_bench.c' - runs every strategy on every map given and on a few
+                     generated ones, the same queries a number of times
+                     each, and reports per map and strategy the median and
+                     99th percentile search time, expansions per second,
+                     peak fringe size and peak RSS; as a table, and as CSV
+                     and JSON files to compare versions with
+                   - Build: gcc -O2 -pthread -o strategy_bench bench/strategy_bench.c -lm
+                   - Usage: ./strategy_bench [--trials N] [--queries N] [--strategy N]... [--label name]
+                                             [--csv out.csv] [--json out.json] [--timeout s] [--no-generated]
+                                             input/1.txt input/6.txt ...
+                            (--strategy may be given more than once; every strategy by default)
+*****************************************************************************/
+
+#include "bench.h"
+#include <sys/resource.h> // getrusage()
+#include <sys/wait.h> // waitpid()
+#include <unistd.h> // fork(), pipe(), alarm()
+#include <signal.h> // SIGALRM
+
+#define BENCH_STRATEGIES 10 // STRAT_BFS to STRAT_VISIBILITY
+#define BENCH_NAME 48 // longest map name kept
+
+// Maps made up on the spot, so that every version is measured on the same bigger maps
+#define GEN_ROOMS 1 // random rectangles
+#define GEN_SERPENTINE 2 // walls across the map with a gap at alternate ends; one long way through
+
+typedef struct
+{
+    const char * Name;
+    int Kind; // GEN_*
+    unsigned int Size; // the map is Size x Size
+    unsigned int Count; // rectangles, or walls
+} Generated;
+
+static const Generated generated[] = {
+    {"rooms-512", GEN_ROOMS, 512, 150},
+    {"rooms-2048", GEN_ROOMS, 2048, 1500},
+    {"serpentine-1024", GEN_SERPENTINE, 1024, 31},
+};
+
+typedef struct
+{
+    char Map[BENCH_NAME];
+    int Strategy;
+    unsigned int Width;
+    unsigned int Height;
+    unsigned int Queries;
+    unsigned int Trials;
+    unsigned int Found; // queries with a path
+    double PrepareMs; // building the strategy's table or graph, if it has one
+    uint64_t MedianNs; // of every search
+    uint64_t P99Ns;
+    uint64_t MeanNs;
+    double ExpansionsPerSecond;
+    unsigned int PeakFringe; // largest of any search
+    long PeakRssKb; // of the process that ran the row, map included
+    const char * Status; // "ok", "timeout", "failed"
+} BenchRow;
+
+Grid * generateMap(const Generated * spec);
+void addRectangle(Grid * grid, int x0, int y0, int x1, int y1);
+bool prepareStrategy(Grid * grid, int strategy);
+unsigned int pickQueries(Grid * grid, bool own, coordinate start, coordinate goal, unsigned int count, coordinate * ends);
+int compareNs(const void * a, const void * b);
+void benchRow(const char * filename, const Generated * spec, int strategy, unsigned int queries, unsigned int trials,
+    BenchRow * row);
+void runRow(const char * name, const char * filename, const Generated * spec, int strategy, unsigned int queries,
+    unsigned int trials, unsigned int timeout, BenchRow * row);
+void printRow(BenchRow * row);
+void writeCsv(const char * filename, const char * label, BenchRow * rows, unsigned int count);
+void writeJson(const char * filename, const char * label, BenchRow * rows, unsigned int count);
+
+int main(int argc, char * argv[])
+{
+    unsigned int trials = 5, queries = 20, timeout = 300, count = 0, strategyCount = 0, mapCount = 0;
+    const char * csvFilename = NULL;
+    const char * jsonFilename = NULL;
+    const char * label = "";
+    bool withGenerated = true;
+    int strategies[BENCH_STRATEGIES];
+    const char ** maps = malloc(argc * sizeof(char *));
+    int a, s;
+    unsigned int m, g;
+    for (a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--trials") == 0 && a + 1 < argc) trials = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--queries") == 0 && a + 1 < argc) queries = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--timeout") == 0 && a + 1 < argc) timeout = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--csv") == 0 && a + 1 < argc) csvFilename = argv[++a];
+        else if (strcmp(argv[a], "--json") == 0 && a + 1 < argc) jsonFilename = argv[++a];
+        else if (strcmp(argv[a], "--label") == 0 && a + 1 < argc) label = argv[++a];
+        else if (strcmp(argv[a], "--no-generated") == 0) withGenerated = false;
+        else if (strcmp(argv[a], "--strategy") == 0 && a + 1 < argc)
+        {
+            s = atoi(argv[++a]);
+            if (s >= STRAT_BFS && s <= STRAT_VISIBILITY && strategyCount < BENCH_STRATEGIES) strategies[strategyCount++] = s;
+        }
+        else if (argv[a][0] == '-')
+        {
+            fprintf(stderr, "Unknown option '%s'\n", argv[a]);
+            return 1;
+        }
+        else maps[mapCount++] = argv[a];
+    }
+    if (trials == 0 || queries == 0 || (mapCount == 0 && !withGenerated))
+    {
+        fprintf(stderr, "Usage: %s [--trials N] [--queries N] [--strategy N]... [--label name] [--csv out.csv] "
+            "[--json out.json] [--timeout s] [--no-generated] map.txt ...\n", argv[0]);
+        return 1;
+    }
+    if (strategyCount == 0)
+    {
+        for (s = STRAT_BFS; s <= STRAT_VISIBILITY; s++) strategies[strategyCount++] = s;
+    }
+    unsigned int generatedCount = withGenerated ? sizeof(generated) / sizeof(generated[0]) : 0;
+    BenchRow * rows = malloc((mapCount + generatedCount) * strategyCount * sizeof(BenchRow));
+    printf("%-16s %-12s %11s %7s %7s %10s %12s %12s %14s %11s %11s %8s\n", "map", "strategy", "size", "found",
+        "runs", "prep (ms)", "median (ns)", "p99 (ns)", "expanded/s", "peak fringe", "peak RSS KB", "status");
+    for (m = 0; m < mapCount + generatedCount; m++)
+    {
+        const char * filename = (m < mapCount) ? maps[m] : NULL;
+        const Generated * spec = (m < mapCount) ? NULL : &generated[m - mapCount];
+        const char * name = spec != NULL ? spec->Name : strrchr(filename, '/') != NULL ? strrchr(filename, '/') + 1 : filename;
+        for (g = 0; g < strategyCount; g++)
+        {
+            runRow(name, filename, spec, strategies[g], queries, trials, timeout, &rows[count]);
+            printRow(&rows[count++]);
+        }
+    }
+    if (csvFilename != NULL) writeCsv(csvFilename, label, rows, count);
+    if (jsonFilename != NULL) writeJson(jsonFilename, label, rows, count);
+    free(rows);
+    free(maps);
+    return 0;
+}
+
+/*
+ * generateMap() - makes up the map a Generated describes, with the regions labelled; NULL if it doesn't fit in
+ *                 memory
+ */
+Grid * generateMap(const Generated * spec)
+{
+    Grid * grid = CreateNewGrid(spec->Size, spec->Size);
+    if (grid == NULL) return NULL;
+    int size = spec->Size;
+    unsigned int i;
+    uint32_t seed = 2463534242u;
+    for (i = 0; i < spec->Count; i++)
+    {
+        if (spec->Kind == GEN_ROOMS)
+        {
+            int w = 4 + nextRandom(&seed) % (size / 16), h = 4 + nextRandom(&seed) % (size / 16);
+            int x = 1 + nextRandom(&seed) % (size - w - 2), y = 1 + nextRandom(&seed) % (size - h - 2);
+            addRectangle(grid, x, y, x + w, y + h);
+        }
+        else
+        {
+            int x = (i + 1) * size / (spec->Count + 1);
+            if (i % 2 == 0) addRectangle(grid, x, 0, x + 1, size - 8); // gap at the bottom
+            else addRectangle(grid, x, 7, x + 1, size - 1); // gap at the top
+        }
+    }
+    if (!LabelGridComponents(grid))
+    {
+        AnnihilateGrid(grid);
+        return NULL;
+    }
+    return grid;
+}
+
+/*
+ * addRectangle() - adds the polygon of a rectangle to the grid, blocking its outline like the app does
+ */
+void addRectangle(Grid * grid, int x0, int y0, int x1, int y1)
+{
+    coordinate corners[4] = {{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+    rasterizePolygon(corners, 4, RASTER_OUTLINE, grid->Blocked, grid->Width, grid->Height, 1);
+    AddGridPolygon(grid, corners, 4);
+}
+
+/*
+ * prepareStrategy() - builds the table or graph the strategy needs on the map, like the app does before a query;
+ *                     false if there isn't enough memory for it
+ */
+bool prepareStrategy(Grid * grid, int strategy)
+{
+    if (strategy == STRAT_JPS) return reserveOpenBits(grid);
+    if (strategy == STRAT_JPS_PLUS) return reserveJumpTable(grid);
+    if (strategy == STRAT_ALT) return reserveLandmarks(grid, ALT_LANDMARKS);
+    if (strategy == STRAT_HPA) return reserveHierarchy(grid, HPA_CLUSTER_SIZE);
+    if (strategy == STRAT_VISIBILITY) return reserveVisibility(grid);
+    return true;
+}
+
+/*
+ * pickQueries() - fills ends with count start and goal pairs: the map's own query first if own, then random open
+ *                 tiles in the same region, so that every query has a path to find; returns how many it found
+ */
+unsigned int pickQueries(Grid * grid, bool own, coordinate start, coordinate goal, unsigned int count, coordinate * ends)
+{
+    size_t cells = (size_t)grid->Width * grid->Height;
+    uint32_t seed = 2463534242u;
+    unsigned int n = 0, tries = 0;
+    if (own && count > 0)
+    {
+        ends[0] = start;
+        ends[1] = goal;
+        n = 1;
+    }
+    while (n < count && tries++ < 1000 * count)
+    {
+        size_t a = nextRandom(&seed) % cells, b = nextRandom(&seed) % cells;
+        if (grid->Blocked[a] || grid->Blocked[b] || grid->Components->Label[a] != grid->Components->Label[b]) continue;
+        ends[2 * n].x = a % grid->Width;
+        ends[2 * n].y = a / grid->Width;
+        ends[2 * n + 1].x = b % grid->Width;
+        ends[2 * n + 1].y = b / grid->Width;
+        n++;
+    }
+    return n;
+}
+
+/*
+ * compareNs() - qsort() order of search times
+ */
+int compareNs(const void * a, const void * b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * benchRow() - loads or makes up the map, builds what the strategy needs, then answers every query once to warm up
+ *              and trials more times timed; fills in the row
+ */
+void benchRow(const char * filename, const Generated * spec, int strategy, unsigned int queries, unsigned int trials,
+    BenchRow * row)
+{
+    coordinate start = {0, 0}, goal = {0, 0};
+    unsigned int i, t;
+    row->Status = "failed";
+    Grid * grid = (spec != NULL) ? generateMap(spec) : readMap(filename, &start, &goal);
+    if (grid == NULL) return;
+    if (!LabelGridComponents(grid)) // The generated maps are labelled already
+    {
+        AnnihilateGrid(grid);
+        return;
+    }
+    row->Width = grid->Width;
+    row->Height = grid->Height;
+    uint64_t began = wallNanoseconds();
+    if (!prepareStrategy(grid, strategy)) return;
+    row->PrepareMs = (wallNanoseconds() - began) / 1e6;
+    SearchContext * ctx = createSearchContext(grid);
+    coordinate * ends = malloc(2 * queries * sizeof(coordinate));
+    if (ctx == NULL || ends == NULL || !reserveStrategy(ctx, strategy)) return;
+    queries = pickQueries(grid, spec == NULL, start, goal, queries, ends);
+    uint64_t * times = malloc((size_t)queries * trials * sizeof(uint64_t));
+    if (queries == 0 || times == NULL) return;
+    uint64_t total = 0, expanded = 0;
+    for (i = 0; i < queries; i++)
+    {
+        SearchResult result = runSearch(ctx, strategy, FRINGE_BUCKET, ends[2 * i], ends[2 * i + 1]);
+        row->Found += result.Found;
+        if (result.PeakFringe > row->PeakFringe) row->PeakFringe = result.PeakFringe;
+    }
+    for (t = 0; t < trials; t++)
+    {
+        for (i = 0; i < queries; i++)
+        {
+            uint64_t before = wallNanoseconds();
+            SearchResult result = runSearch(ctx, strategy, FRINGE_BUCKET, ends[2 * i], ends[2 * i + 1]);
+            uint64_t ns = wallNanoseconds() - before;
+            times[t * queries + i] = ns;
+            total += ns;
+            expanded += result.Expanded;
+        }
+    }
+    size_t runs = (size_t)queries * trials;
+    qsort(times, runs, sizeof(uint64_t), compareNs);
+    row->Queries = queries;
+    row->MedianNs = times[(runs - 1) / 2];
+    row->P99Ns = times[(runs * 99 + 99) / 100 - 1]; // nearest rank
+    row->MeanNs = total / runs;
+    row->ExpansionsPerSecond = (total > 0) ? expanded * 1e9 / total : 0.0;
+    row->Status = "ok";
+    free(times);
+    free(ends);
+    destroySearchContext(ctx);
+    AnnihilateGrid(grid);
+}
+
+/*
+ * runRow() - runs benchRow() in a child process, so that the peak RSS is the row's own and a crash or a timeout
+ *            costs only that row; the child sends the row back through a pipe
+ */
+void runRow(const char * name, const char * filename, const Generated * spec, int strategy, unsigned int queries,
+    unsigned int trials, unsigned int timeout, BenchRow * row)
+{
+    int channel[2], status = 0;
+    memset(row, 0, sizeof(BenchRow));
+    snprintf(row->Map, BENCH_NAME, "%s", name);
+    row->Strategy = strategy;
+    row->Trials = trials;
+    row->Status = "failed";
+    fflush(stdout);
+    if (pipe(channel) != 0) return;
+    pid_t child = fork();
+    if (child < 0) return;
+    if (child == 0)
+    {
+        struct rusage usage;
+        close(channel[0]);
+        alarm(timeout);
+        benchRow(filename, spec, strategy, queries, trials, row);
+        getrusage(RUSAGE_SELF, &usage);
+        row->PeakRssKb = usage.ru_maxrss; // KB on Linux
+        write(channel[1], row, sizeof(BenchRow)); // Status points into the string constants, the same in both
+        _exit(0);
+    }
+    close(channel[1]);
+    BenchRow result;
+    bool got = read(channel[0], &result, sizeof(BenchRow)) == sizeof(BenchRow);
+    close(channel[0]);
+    waitpid(child, &status, 0);
+    if (got) *row = result;
+    else if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) row->Status = "timeout";
+}
+
+/*
+ * printRow() - prints one line of the table
+ */
+void printRow(BenchRow * row)
+{
+    char size[24];
+    snprintf(size, sizeof(size), "%ux%u", row->Width, row->Height);
+    printf("%-16s %-12s %11s %7u %7u %10.2f %12llu %12llu %14.0f %11u %11ld %8s\n", row->Map,
+        strategyName(row->Strategy), size, row->Found, row->Queries * row->Trials, row->PrepareMs,
+        (unsigned long long)row->MedianNs, (unsigned long long)row->P99Ns, row->ExpansionsPerSecond, row->PeakFringe,
+        row->PeakRssKb, row->Status);
+    fflush(stdout);
+}
+
+/*
+ * writeCsv() - writes the rows as CSV, a header line first
+ */
+void writeCsv(const char * filename, const char * label, BenchRow * rows, unsigned int count)
+{
+    unsigned int i;
+    FILE * f = fopen(filename, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "Failed to write '%s'\n", filename);
+        return;
+    }
+    fprintf(f, "label,map,width,height,strategy,strategy_name,queries,trials,found,prepare_ms,median_ns,p99_ns,"
+        "mean_ns,expansions_per_s,peak_fringe,peak_rss_kb,status\n");
+    for (i = 0; i < count; i++)
+    {
+        BenchRow * r = &rows[i];
+        fprintf(f, "%s,%s,%u,%u,%d,%s,%u,%u,%u,%.3f,%llu,%llu,%llu,%.0f,%u,%ld,%s\n", label, r->Map, r->Width,
+            r->Height, r->Strategy, strategyName(r->Strategy), r->Queries, r->Trials, r->Found, r->PrepareMs,
+            (unsigned long long)r->MedianNs, (unsigned long long)r->P99Ns, (unsigned long long)r->MeanNs,
+            r->ExpansionsPerSecond, r->PeakFringe, r->PeakRssKb, r->Status);
+    }
+    fclose(f);
+}
+
+/*
+ * writeJson() - writes the rows as one JSON object: the label, then an array of one object per row
+ */
+void writeJson(const char * filename, const char * label, BenchRow * rows, unsigned int count)
+{
+    unsigned int i;
+    FILE * f = fopen(filename, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "Failed to write '%s'\n", filename);
+        return;
+    }
+    fprintf(f, "{\"label\": \"%s\", \"rows\": [\n", label);
+    for (i = 0; i < count; i++)
+    {
+        BenchRow * r = &rows[i];
+        fprintf(f, "  {\"map\": \"%s\", \"width\": %u, \"height\": %u, \"strategy\": %d, \"strategy_name\": \"%s\", "
+            "\"queries\": %u, \"trials\": %u, \"found\": %u, \"prepare_ms\": %.3f, \"median_ns\": %llu, "
+            "\"p99_ns\": %llu, \"mean_ns\": %llu, \"expansions_per_s\": %.0f, \"peak_fringe\": %u, "
+            "\"peak_rss_kb\": %ld, \"status\": \"%s\"}%s\n", r->Map, r->Width, r->Height, r->Strategy,
+            strategyName(r->Strategy), r->Queries, r->Trials, r->Found, r->PrepareMs, (unsigned long long)r->MedianNs,
+            (unsigned long long)r->P99Ns, (unsigned long long)r->MeanNs, r->ExpansionsPerSecond, r->PeakFringe,
+            r->PeakRssKb, r->Status, (i + 1 < count) ? "," : "");
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+}
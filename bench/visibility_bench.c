@@ -0,0 +1,213 @@
+/****************************************************************************
+'visibility_bench.c' - times any-angle queries on the visibility graph in
+                       vis.h against grid A* on the same random queries,
+                       and checks that no path it finds, the map's own
+                       query's included, goes through a polygon
+                     - Build: gcc -O2 -pthread -o visibility_bench bench/visibility_bench.c -lm
+                     - Usage: ./visibility_bench [queries] input/1.txt input/6.txt ...
+*****************************************************************************/
+
+#include "bench.h"
+
+bool benchFile(const char * filename, int queries);
+bool pathClear(Grid * grid, Stack * path);
+bool legClear(Grid * grid, unsigned int p, coordinate a, coordinate b);
+bool insidePolygon(Grid * grid, unsigned int p, double x, double y);
+
+int main(int argc, char * argv[])
+{
+    int queries = 1000;
+    int first = 1;
+    int i;
+    bool clear = true;
+    if (argc > 1 && atoi(argv[1]) > 0)
+    {
+        queries = atoi(argv[1]);
+        first = 2;
+    }
+    if (first >= argc)
+    {
+        fprintf(stderr, "Usage: %s [queries] map.txt ...\n", argv[0]);
+        return 1;
+    }
+    printf("%-10s %6s %6s %11s %8s %10s %10s %8s %10s %10s %10s %9s\n", "map", "nodes", "edges", "build (ms)", "queries",
+        "A* (us)", "vis (us)", "speedup", "A* exp.", "vis exp.", "grid/vis", "crossing");
+    for (i = first; i < argc; i++)
+    {
+        if (!benchFile(argv[i], queries)) clear = false;
+    }
+    return clear ? 0 : 1;
+}
+
+/*
+ * benchFile() - builds the map's visibility graph, then answers the same random queries between open tiles with
+ *               grid A* and with the visibility graph
+ *             - prints the mean time and expansions per query, and how much longer the 4-connected grid paths are
+ *               than the any-angle ones, over the queries both answered
+ *             - then answers them again, and the map's own query, and counts the paths that go through a polygon;
+ *               returns false if there are any, or the map can't be read
+ */
+bool benchFile(const char * filename, int queries)
+{
+    coordinate start, goal;
+    Grid * grid = readMap(filename, &start, &goal);
+    if (grid == NULL) return false;
+    SearchContext * ctx = createSearchContext(grid);
+    double t = wallTime();
+    if (ctx == NULL || !reserveVisibility(grid) || !reserveStrategy(ctx, STRAT_ASTAR))
+    {
+        fprintf(stderr, "Not enough memory for '%s'\n", filename);
+        return false;
+    }
+    double buildTime = wallTime() - t;
+    coordinate * ends = malloc(2 * queries * sizeof(coordinate));
+    uint32_t seed = 2463534242u;
+    int i, both = 0;
+    long astarExpanded = 0, visExpanded = 0;
+    double ratio = 0;
+    for (i = 0; i < 2 * queries; i++)
+    {
+        do
+        {
+            ends[i].x = nextRandom(&seed) % grid->Width;
+            ends[i].y = nextRandom(&seed) % grid->Height;
+        } while (grid->Blocked[(size_t)ends[i].y * grid->Width + ends[i].x]);
+    }
+    int * astarCost = malloc(queries * sizeof(int));
+    t = wallTime();
+    for (i = 0; i < queries; i++)
+    {
+        SearchResult result = runSearch(ctx, STRAT_ASTAR, FRINGE_BUCKET, ends[2 * i], ends[2 * i + 1]);
+        astarCost[i] = result.Found ? (int)result.Path->Depth - 1 : -1;
+        astarExpanded += result.Expanded;
+    }
+    double astarTime = wallTime() - t;
+    t = wallTime();
+    for (i = 0; i < queries; i++)
+    {
+        SearchResult result = runSearch(ctx, STRAT_VISIBILITY, FRINGE_HEAP, ends[2 * i], ends[2 * i + 1]);
+        visExpanded += result.Expanded;
+        if (!result.Found || astarCost[i] < 0) continue;
+        double length = pathLength(result.Path);
+        ratio += (length > 0) ? astarCost[i] / length : 1.0;
+        both++;
+    }
+    double visTime = wallTime() - t;
+    int crossing = 0;
+    for (i = -1; i < queries; i++)
+    {
+        coordinate from = (i < 0) ? start : ends[2 * i];
+        coordinate to = (i < 0) ? goal : ends[2 * i + 1];
+        if (from.x < 0 || from.y < 0 || to.x < 0 || to.y < 0 || from.x >= (int)grid->Width || to.x >= (int)grid->Width
+            || from.y >= (int)grid->Height || to.y >= (int)grid->Height) continue;
+        SearchResult result = runSearch(ctx, STRAT_VISIBILITY, FRINGE_HEAP, from, to);
+        if (!result.Found || pathClear(grid, result.Path)) continue;
+        fprintf(stderr, "%s: the path from (%d,%d) to (%d,%d) goes through a polygon\n", filename, from.x, from.y,
+            to.x, to.y);
+        crossing++;
+    }
+    const char * base = strrchr(filename, '/');
+    base = (base != NULL) ? base + 1 : filename;
+    printf("%-10s %6u %6u %11.3f %8d %10.2f %10.2f %7.0fx %10ld %10ld %10.3f %9d\n", base, grid->Visibility->NodeCount,
+        grid->Visibility->EdgeCount, buildTime * 1000.0, queries, astarTime * 1e6 / queries, visTime * 1e6 / queries,
+        (visTime > 0) ? astarTime / visTime : 0.0, astarExpanded / queries, visExpanded / queries,
+        (both > 0) ? ratio / both : 0.0, crossing);
+    free(ends);
+    free(astarCost);
+    destroySearchContext(ctx);
+    AnnihilateGrid(grid);
+    return crossing == 0;
+}
+
+/*
+ * pathClear() - true if no leg of a visibility path goes through the inside of a polygon, except one that both ends
+ *               of the path are inside of
+ */
+bool pathClear(Grid * grid, Stack * path)
+{
+    coordinate start = path->Data[path->Depth - 1], goal = path->Data[0];
+    unsigned int p, i;
+    for (p = 0; p < grid->PolygonCount; p++)
+    {
+        if (insidePolygon(grid, p, start.x, start.y) && insidePolygon(grid, p, goal.x, goal.y)) continue;
+        for (i = 1; i < path->Depth; i++)
+        {
+            if (!legClear(grid, p, path->Data[i], path->Data[i - 1])) return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * legClear() - true if the line from a to b stays out of the inside of polygon p
+ *            - cuts the line where it meets the outline, and checks the middle of every piece; a piece is either
+ *              all inside or all outside
+ */
+bool legClear(Grid * grid, unsigned int p, coordinate a, coordinate b)
+{
+    unsigned int first = (p > 0) ? grid->PolygonEnds[p - 1] : 0, end = grid->PolygonEnds[p];
+    double * cut = malloc((2 * (end - first) + 2) * sizeof(double));
+    double ux = b.x - a.x, uy = b.y - a.y, length2 = ux * ux + uy * uy;
+    unsigned int v, n = 0, i, j;
+    bool clear = true;
+    if (cut == NULL || length2 == 0)
+    {
+        free(cut);
+        return true;
+    }
+    cut[n++] = 0;
+    cut[n++] = 1;
+    for (v = first; v < end; v++)
+    {
+        coordinate c = grid->Vertices[v], d = grid->Vertices[(v + 1 < end) ? v + 1 : first];
+        double vx = d.x - c.x, vy = d.y - c.y, wx = c.x - a.x, wy = c.y - a.y;
+        double denominator = ux * vy - uy * vx;
+        if (denominator != 0)
+        {
+            double t = (wx * vy - wy * vx) / denominator, s = (wx * uy - wy * ux) / denominator;
+            if (t > 0 && t < 1 && s >= 0 && s <= 1) cut[n++] = t;
+        }
+        else
+        {
+            // Parallel: where its ends fall along the line, if they are on it
+            double t = (wx * ux + wy * uy) / length2;
+            if (t > 0 && t < 1) cut[n++] = t;
+            t = ((d.x - a.x) * ux + (d.y - a.y) * uy) / length2;
+            if (t > 0 && t < 1) cut[n++] = t;
+        }
+    }
+    for (i = 1; i < n; i++) // Insertion sort; a polygon has few edges
+    {
+        double t = cut[i];
+        for (j = i; j > 0 && cut[j - 1] > t; j--) cut[j] = cut[j - 1];
+        cut[j] = t;
+    }
+    for (i = 1; i < n && clear; i++)
+    {
+        double t = (cut[i - 1] + cut[i]) / 2;
+        if (cut[i] - cut[i - 1] > 1e-9 && insidePolygon(grid, p, a.x + t * ux, a.y + t * uy)) clear = false;
+    }
+    free(cut);
+    return clear;
+}
+
+/*
+ * insidePolygon() - true if (x,y) is strictly inside polygon p, by the number of its edges a ray to the right
+ *                   crosses; a point on its outline, or on a flat polygon, isn't
+ */
+bool insidePolygon(Grid * grid, unsigned int p, double x, double y)
+{
+    unsigned int first = (p > 0) ? grid->PolygonEnds[p - 1] : 0, end = grid->PolygonEnds[p];
+    unsigned int v;
+    bool inside = false;
+    for (v = first; v < end; v++)
+    {
+        coordinate c = grid->Vertices[v], d = grid->Vertices[(v + 1 < end) ? v + 1 : first];
+        double vx = d.x - c.x, vy = d.y - c.y, length = sqrt(vx * vx + vy * vy);
+        if (length == 0) continue;
+        double along = ((x - c.x) * vx + (y - c.y) * vy) / (length * length);
+        if (fabs(vx * (y - c.y) - vy * (x - c.x)) < 1e-9 * length && along >= 0 && along <= 1) return false;
+        if ((c.y > y) != (d.y > y) && x < c.x + (y - c.y) * vx / vy) inside = !inside;
+    }
+    return inside;
+}
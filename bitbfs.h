@@ -0,0 +1,360 @@
+#pragma once
+#include "line.h"
+#include "grid.h"
+
+/*  BITBOARD BFS
+ *  A BFS from one tile reaches its tiles a level at a time, and every tile of a level is at the same distance, so
+ *  the order within a level doesn't matter when all that's wanted is distances. With a bit per tile, the next
+ *  level is the current one shifted a column left and right and a row up and down, OR'd together, AND'd with the
+ *  open tiles and AND NOT'd with the tiles reached already: a few operations per 64 tiles instead of a queue
+ *  operation per tile. The rows carry a zero word at each end and the board a zero row above and below, so the
+ *  loop over a row has no edge cases and the compiler can vectorize it (e.g. 4 words at a time with -mavx2).
+ *  Each level keeps the list of rows it has tiles in, and the span of words they're in within each row, and only
+ *  the words around those are computed, so a thin wave through a big map stays cheap. Still, a level of a 4-way
+ *  BFS has about 2 tiles per row wherever the map is open, so the distances cost about as much per tile as a queue.
+ *  Reachability needs no levels: bitReach() fills whole runs of a row at once, and sweeps down and up the rows
+ *  until nothing changes, which packs 64 tiles into each operation. That is how a search tells a goal it can't
+ *  reach on a map whose regions aren't labelled (see searchConnected() in search.h).
+ */
+
+#define BITBFS_UNREACHABLE 0xFFFF // distance to a tile the root can't reach; the same encoding as the ALT table
+#define BITBFS_FAR 0xFFFE // longer distances are stored as this
+
+typedef struct
+{
+    Grid * Map;
+    unsigned int Words; // 64-bit words per row
+    unsigned int Stride; // Words plus the zero word at each end
+    uint64_t * Open; // bit per tile: not blocked; bits past the last column are 0
+    uint64_t * Reached; // bit per tile: reached by the last search
+    uint64_t * Wave[2]; // the current level and the next one
+    uint32_t * Low[2]; // Low[w][y + 1] up to High[w][y + 1]: the words of row y of Wave[w] that can be nonzero;
+    uint32_t * High[2]; // the rest of the row is 0 (and so are the zero rows above and below, whose spans are empty)
+    uint32_t * Rows[2]; // the rows of each Wave with any bit set, top to bottom
+    unsigned int RowCount[2];
+} BitBoard; // Bitmaps of one map for level-at-a-time searches; a snapshot, so take it again with bitSnapshot()
+           // after SetGridCell()
+
+BitBoard * createBitBoard(Grid * map);
+void destroyBitBoard(BitBoard * b);
+void bitSnapshot(BitBoard * b);
+size_t bitDistances(BitBoard * b, size_t root, uint16_t * dist, unsigned int stride);
+size_t bitReach(BitBoard * b, size_t root);
+bool bitReached(BitBoard * b, unsigned int x, unsigned int y);
+bool bitFillRow(BitBoard * b, unsigned int y);
+uint64_t * bitRow(BitBoard * b, uint64_t * bits, unsigned int y);
+unsigned int bitStep(BitBoard * b, unsigned int current, unsigned int y);
+
+/*
+ * createBitBoard() - the bitmaps of the map's open tiles, and room for the searches' levels; NULL if there isn't
+ *                    enough memory
+ */
+BitBoard * createBitBoard(Grid * map)
+{
+    BitBoard * b = calloc(1, sizeof(BitBoard));
+    unsigned int w;
+    if (b == NULL) return NULL;
+    b->Map = map;
+    b->Words = (map->Width + 63) / 64;
+    b->Stride = b->Words + 2;
+    size_t words = (size_t)(map->Height + 2) * b->Stride; // and a zero row above and below
+    b->Open = AllocateAligned(words * sizeof(uint64_t));
+    b->Reached = AllocateAligned(words * sizeof(uint64_t));
+    bool enough = b->Open != NULL && b->Reached != NULL;
+    for (w = 0; w < 2; w++)
+    {
+        b->Wave[w] = AllocateAligned(words * sizeof(uint64_t));
+        b->Low[w] = calloc(map->Height + 2, sizeof(uint32_t));
+        b->High[w] = calloc(map->Height + 2, sizeof(uint32_t));
+        b->Rows[w] = malloc(map->Height * sizeof(uint32_t));
+        enough = enough && b->Wave[w] != NULL && b->Low[w] != NULL && b->High[w] != NULL && b->Rows[w] != NULL;
+    }
+    if (!enough)
+    {
+        destroyBitBoard(b);
+        return NULL;
+    }
+    memset(b->Reached, 0, words * sizeof(uint64_t));
+    memset(b->Wave[0], 0, words * sizeof(uint64_t));
+    memset(b->Wave[1], 0, words * sizeof(uint64_t));
+    bitSnapshot(b);
+    return b;
+}
+
+/*
+ * bitSnapshot() - copies the map's open tiles into Open again, e.g. after SetGridCell() changed some
+ */
+void bitSnapshot(BitBoard * b)
+{
+    Grid * map = b->Map;
+    unsigned int x, y;
+    memset(b->Open, 0, (size_t)(map->Height + 2) * b->Stride * sizeof(uint64_t));
+    for (y = 0; y < map->Height; y++)
+    {
+        uint64_t * row = bitRow(b, b->Open, y);
+        const uint8_t * blocked = map->Blocked + (size_t)y * map->Width;
+        for (x = 0; x < map->Width; x++)
+        {
+            if (!blocked[x]) row[x / 64] |= 1ULL << (x % 64);
+        }
+    }
+}
+
+/*
+ * destroyBitBoard() - frees the board; b may be partly allocated
+ */
+void destroyBitBoard(BitBoard * b)
+{
+    unsigned int w;
+    if (b == NULL) return;
+    free(b->Open);
+    free(b->Reached);
+    for (w = 0; w < 2; w++)
+    {
+        free(b->Wave[w]);
+        free(b->Low[w]);
+        free(b->High[w]);
+        free(b->Rows[w]);
+    }
+    free(b);
+}
+
+/*
+ * bitDistances() - BFS from root (a cell, y * Width + x) a level at a time; returns how many tiles it reached,
+ *                  root included, and leaves them in Reached
+ *                - if dist isn't NULL, writes the distance from root to every tile into dist[cell * stride], the
+ *                  same as landmarkBFS(): BITBFS_UNREACHABLE for tiles it can't reach, BITBFS_FAR for farther ones
+ *                - a blocked root reaches nothing
+ */
+size_t bitDistances(BitBoard * b, size_t root, uint16_t * dist, unsigned int stride)
+{
+    unsigned int W = b->Map->Width;
+    unsigned int H = b->Map->Height;
+    size_t words = (size_t)(H + 2) * b->Stride;
+    size_t cells = (size_t)W * H, cell, reached;
+    unsigned int current = 0, i, k, y;
+    uint16_t d = 0;
+    if (dist != NULL)
+    {
+        for (cell = 0; cell < cells; cell++)
+        {
+            dist[cell * stride] = BITBFS_UNREACHABLE;
+        }
+    }
+    memset(b->Reached, 0, words * sizeof(uint64_t));
+    memset(b->Wave[0], 0, words * sizeof(uint64_t));
+    memset(b->Wave[1], 0, words * sizeof(uint64_t));
+    memset(b->Low[0], 0, (H + 2) * sizeof(uint32_t));
+    memset(b->High[0], 0, (H + 2) * sizeof(uint32_t));
+    memset(b->Low[1], 0, (H + 2) * sizeof(uint32_t));
+    memset(b->High[1], 0, (H + 2) * sizeof(uint32_t));
+    b->RowCount[0] = b->RowCount[1] = 0;
+    if (b->Map->Blocked[root]) return 0;
+    y = root / W;
+    k = root % W / 64;
+    bitRow(b, b->Wave[0], y)[k] = 1ULL << (root % W % 64);
+    bitRow(b, b->Reached, y)[k] = 1ULL << (root % W % 64);
+    b->Low[0][y + 1] = k;
+    b->High[0][y + 1] = k + 1;
+    b->Rows[0][b->RowCount[0]++] = y;
+    if (dist != NULL) dist[root * stride] = 0;
+    reached = 1;
+    while (b->RowCount[current] > 0)
+    {
+        unsigned int next = current ^ 1;
+        uint64_t * wave = b->Wave[next];
+        d = (d < BITBFS_FAR) ? d + 1 : BITBFS_FAR;
+        // What's left in the next level's bitmap is the level before this one
+        for (i = 0; i < b->RowCount[next]; i++)
+        {
+            y = b->Rows[next][i];
+            memset(bitRow(b, wave, y) + b->Low[next][y + 1], 0,
+                (b->High[next][y + 1] - b->Low[next][y + 1]) * sizeof(uint64_t));
+            b->Low[next][y + 1] = b->High[next][y + 1] = 0;
+        }
+        b->RowCount[next] = 0;
+        // The next level can only be in the rows of this one and the rows next to them, top to bottom
+        unsigned int done = 0; // rows above this one are done
+        for (i = 0; i < b->RowCount[current]; i++)
+        {
+            unsigned int row = b->Rows[current][i];
+            for (y = (row > done) ? row - 1 : done; y <= row + 1 && y < H; y++)
+            {
+                unsigned int found = bitStep(b, current, y);
+                done = y + 1;
+                if (found == 0) continue;
+                reached += found;
+                if (dist == NULL) continue;
+                uint64_t * bits = bitRow(b, wave, y);
+                for (k = b->Low[next][y + 1]; k < b->High[next][y + 1]; k++)
+                {
+                    uint64_t word = bits[k];
+                    while (word != 0)
+                    {
+                        dist[((size_t)y * W + k * 64 + __builtin_ctzll(word)) * stride] = d;
+                        word &= word - 1;
+                    }
+                }
+            }
+        }
+        current = next;
+    }
+    return reached;
+}
+
+/*
+ * bitReach() - marks the tiles root (a cell, y * Width + x) can reach in Reached and returns how many there are,
+ *              root included; the same tiles as bitDistances(), without the distances
+ *            - sweeps down and up the rows the region spans so far until a pair of sweeps changes nothing; each
+ *              sweep costs the words of those rows, and a region needs another one every time it turns back on
+ *              itself, so winding mazes take many
+ */
+size_t bitReach(BitBoard * b, size_t root)
+{
+    unsigned int W = b->Map->Width;
+    unsigned int H = b->Map->Height;
+    size_t reached = 0;
+    unsigned int y, k, top, bottom;
+    bool changed = true;
+    memset(b->Reached, 0, (size_t)(H + 2) * b->Stride * sizeof(uint64_t));
+    if (b->Map->Blocked[root]) return 0;
+    top = bottom = root / W;
+    bitRow(b, b->Reached, top)[root % W / 64] = 1ULL << (root % W % 64);
+    while (changed)
+    {
+        changed = false;
+        for (y = top; y <= bottom + 1 && y < H; y++) // Down, one row past the region
+        {
+            if (!bitFillRow(b, y)) continue;
+            changed = true;
+            if (y > bottom) bottom = y;
+        }
+        for (y = bottom + 1; y-- > 0 && y + 1 >= top;) // Up, one row past the region
+        {
+            if (!bitFillRow(b, y)) continue;
+            changed = true;
+            if (y < top) top = y;
+        }
+    }
+    for (y = top; y <= bottom; y++)
+    {
+        const uint64_t * row = bitRow(b, b->Reached, y);
+        for (k = 0; k < b->Words; k++)
+        {
+            reached += __builtin_popcountll(row[k]);
+        }
+    }
+    return reached;
+}
+
+/*
+ * bitReached() - whether the last bitDistances() or bitReach() reached (x,y)
+ */
+bool bitReached(BitBoard * b, unsigned int x, unsigned int y)
+{
+    return (bitRow(b, b->Reached, y)[x / 64] >> (x % 64)) & 1;
+}
+
+/*
+ * bitFillRow() - adds to row y of Reached every open tile of the row that a reached tile of it, or of a row next
+ *                to it, can get to along the row; returns true if that's any
+ */
+bool bitFillRow(BitBoard * b, unsigned int y)
+{
+    const uint64_t * open = bitRow(b, b->Open, y);
+    uint64_t * reached = bitRow(b, b->Reached, y);
+    const uint64_t * up = reached - b->Stride;
+    const uint64_t * down = reached + b->Stride;
+    uint64_t carry = 0, changed = 0;
+    unsigned int k;
+    // Towards the last column: adding the seeds to the open bits carries through each run above a seed
+    for (k = 0; k < b->Words; k++)
+    {
+        uint64_t o = open[k];
+        uint64_t s = (reached[k] | up[k] | down[k] | carry) & o;
+        uint64_t fill = (o & ((o + s) ^ o)) | s;
+        carry = fill >> 63; // The run goes on into the next word if its first tile is open
+        changed |= fill ^ reached[k];
+        reached[k] = fill;
+    }
+    // Towards the first column: no carry trick that way, so the runs are doubled up 6 times instead
+    carry = 0;
+    for (k = b->Words; k-- > 0;)
+    {
+        uint64_t p = open[k];
+        uint64_t g = reached[k] | ((carry << 63) & p);
+        g |= p & (g >> 1);
+        p &= p >> 1;
+        g |= p & (g >> 2);
+        p &= p >> 2;
+        g |= p & (g >> 4);
+        p &= p >> 4;
+        g |= p & (g >> 8);
+        p &= p >> 8;
+        g |= p & (g >> 16);
+        p &= p >> 16;
+        g |= p & (g >> 32);
+        carry = g & 1;
+        changed |= g ^ reached[k];
+        reached[k] = g;
+    }
+    return changed != 0;
+}
+
+/*
+ * bitRow() - the first word of row y in one of the board's bitmaps; the words before it and after its last are 0
+ */
+uint64_t * bitRow(BitBoard * b, uint64_t * bits, unsigned int y)
+{
+    return bits + (size_t)(y + 1) * b->Stride + 1;
+}
+
+/*
+ * bitStep() - row y of the level after Wave[current]: the open, unreached neighbours of its tiles; marks them
+ *             reached, adds the row to the level's rows if it has any, and returns how many there are
+ */
+unsigned int bitStep(BitBoard * b, unsigned int current, unsigned int y)
+{
+    unsigned int next = current ^ 1;
+    const uint32_t * low = b->Low[current] + y + 1; // spans of rows y - 1, y and y + 1 are low[-1..1]
+    const uint32_t * high = b->High[current] + y + 1;
+    unsigned int first = b->Words, last = 0, k, found = 0;
+    int r;
+    for (r = -1; r <= 1; r++)
+    {
+        if (low[r] == high[r]) continue;
+        if (low[r] < first) first = low[r];
+        if (high[r] > last) last = high[r];
+    }
+    if (first >= last) return 0; // Nothing in or next to the row
+    if (first > 0) first--; // A bit at either end of a word can carry into the word next to it
+    if (last < b->Words) last++;
+    const uint64_t * here = bitRow(b, b->Wave[current], y);
+    const uint64_t * left = here - 1;
+    const uint64_t * right = here + 1;
+    const uint64_t * up = here - b->Stride;
+    const uint64_t * down = here + b->Stride;
+    const uint64_t * open = bitRow(b, b->Open, y);
+    uint64_t * reached = bitRow(b, b->Reached, y);
+    uint64_t * out = bitRow(b, b->Wave[next], y);
+    uint64_t any = 0;
+    for (k = first; k < last; k++) // Branch-free, so it vectorizes
+    {
+        uint64_t n = (here[k] << 1) | (here[k] >> 1) | (left[k] >> 63) | (right[k] << 63) | up[k] | down[k];
+        n &= open[k] & ~reached[k];
+        out[k] = n;
+        reached[k] |= n;
+        any |= n;
+    }
+    if (any == 0) return 0;
+    while (out[first] == 0) first++; // Tighten the span to the words that got any bits
+    while (out[last - 1] == 0) last--;
+    for (k = first; k < last; k++)
+    {
+        found += __builtin_popcountll(out[k]);
+    }
+    b->Low[next][y + 1] = first;
+    b->High[next][y + 1] = last;
+    b->Rows[next][b->RowCount[next]++] = y;
+    return found;
+}
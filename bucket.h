@@ -0,0 +1,223 @@
+/****************************************************************************
+'bucket.h' - implements functions that perform operations or manipulations
+             on Bucket Queues (Dial's algorithm), i.e., priority queues
+             for small nonnegative integer keys
+           - Programmer: Vincent Paul Fiestada
+*****************************************************************************/
+
+#pragma once
+#include "line.h"
+#include "arena.h"
+
+typedef struct
+{
+	int * Buckets; // Buckets[f] = cell at the top of bucket f, or -1 if the bucket is empty
+	int * Next; // Next[cell] = cell below it in the same bucket, or -1
+	int * Prev; // Prev[cell] = cell above it in the same bucket, or -1 if it is the top
+	int * Key; // Key[cell] = f of the cell, or -1 if the cell is not in the queue
+	int * Level; // Level[cell] = g of the cell
+	unsigned int BucketCount; // number of buckets allocated, i.e., largest f + 1 that fits
+	unsigned int Min; // no bucket below Min is nonempty
+	unsigned int Count; // number of cells in the queue
+	unsigned int Width;
+	unsigned int Height;
+	Arena * Pool; // where the queue's arrays come from; NULL means malloc
+} BucketQueue;
+
+
+BucketQueue * CreateNewBucketQueue(unsigned int width, unsigned int height);
+BucketQueue * CreateNewBucketQueueInArena(Arena * pool, unsigned int width, unsigned int height);
+void AnnihilateBucketQueue(BucketQueue * targetQueue);
+void ClearBucketQueue(BucketQueue * targetQueue);
+void InsertToBucketQueue(BucketQueue * targetQueue, unsigned int x, unsigned int y, int f, int g);
+int PeekBucketQueue(BucketQueue * targetQueue);
+coordinate PopFromBucketQueue(BucketQueue * targetQueue);
+void UnlinkFromBucket(BucketQueue * targetQueue, int cell);
+void BucketQueueUnderflow();
+
+// <summary>
+// CreateNewBucketQueue - allocates space for a new empty Bucket Queue over a width x height grid and
+//                        returns a pointer to it
+//                      - every cell can be in the queue at most once; inserting a cell that is already
+//                        in the queue moves it to its new bucket (decrease-key)
+//				        - The creator has the implicit responsibility of freeing up memory later
+// </summary>
+BucketQueue * CreateNewBucketQueue(unsigned int width, unsigned int height)
+{
+	return CreateNewBucketQueueInArena(NULL, width, height);
+}
+
+// <summary>
+// CreateNewBucketQueueInArena - same as CreateNewBucketQueue, but all memory is drawn from the given Arena
+// </summary>
+BucketQueue * CreateNewBucketQueueInArena(Arena * pool, unsigned int width, unsigned int height)
+{
+	BucketQueue * n = ArenaAlloc(pool, sizeof(BucketQueue));
+	unsigned int i;
+	unsigned int cells = width * height;
+	n->Pool = pool;
+	n->Width = width;
+	n->Height = height;
+	n->Count = 0;
+	n->Min = 0;
+	// Manhattan distance never exceeds width + height; g grows the array on demand
+	n->BucketCount = width + height + 1;
+	n->Buckets = ArenaAlloc(pool, n->BucketCount * sizeof(int));
+	for (i = 0; i < n->BucketCount; i++)
+	{
+		n->Buckets[i] = -1;
+	}
+	n->Next = ArenaAlloc(pool, (size_t)cells * sizeof(int));
+	n->Prev = ArenaAlloc(pool, (size_t)cells * sizeof(int));
+	n->Key = ArenaAlloc(pool, (size_t)cells * sizeof(int));
+	n->Level = ArenaAlloc(pool, (size_t)cells * sizeof(int));
+	for (i = 0; i < cells; i++)
+	{
+		n->Key[i] = -1; // Initialize as empty
+	}
+	return n;
+}
+
+// <summary>
+// AnnihilateBucketQueue - frees up the memory allocated for the Bucket Queue and all of its buckets
+// </summary>
+void AnnihilateBucketQueue(BucketQueue * targetQueue)
+{
+	ArenaFree(targetQueue->Pool, targetQueue->Buckets);
+	ArenaFree(targetQueue->Pool, targetQueue->Next);
+	ArenaFree(targetQueue->Pool, targetQueue->Prev);
+	ArenaFree(targetQueue->Pool, targetQueue->Key);
+	ArenaFree(targetQueue->Pool, targetQueue->Level);
+	ArenaFree(targetQueue->Pool, targetQueue);
+	return;
+}
+
+// <summary>
+// ClearBucketQueue - removes every cell from the Bucket Queue, leaving it empty but still usable
+//                  - only the buckets from Min up to the last nonempty one are touched, so reusing a
+//                    Bucket Queue is cheaper than creating one
+// </summary>
+void ClearBucketQueue(BucketQueue * targetQueue)
+{
+	unsigned int f = targetQueue->Min;
+	while (targetQueue->Count > 0)
+	{
+		int cell = targetQueue->Buckets[f];
+		while (cell >= 0)
+		{
+			targetQueue->Key[cell] = -1;
+			targetQueue->Count--;
+			cell = targetQueue->Next[cell];
+		}
+		targetQueue->Buckets[f++] = -1;
+	}
+	targetQueue->Min = 0;
+	return;
+}
+
+// <summary>
+// InsertToBucketQueue - pushes a cell on top of bucket f in O(1)
+//                     - the top of a bucket is popped first (LIFO), so among equal f the deepest,
+//                       most recently generated cell wins, just like in SortedList
+//                     - if the cell is already queued with a smaller f, nothing changes
+// </summary>
+void InsertToBucketQueue(BucketQueue * targetQueue, unsigned int x, unsigned int y, int f, int g)
+{
+	int cell = y * targetQueue->Width + x;
+	if (targetQueue->Key[cell] >= 0)
+	{
+		if (f > targetQueue->Key[cell]) return; // the stored entry is still better
+		UnlinkFromBucket(targetQueue, cell);
+	}
+	if ((unsigned int)f >= targetQueue->BucketCount) // Out of buckets; grow to fit f
+	{
+		unsigned int old = targetQueue->BucketCount;
+		unsigned int i;
+		while ((unsigned int)f >= targetQueue->BucketCount) targetQueue->BucketCount *= 2;
+		targetQueue->Buckets = ArenaGrow(targetQueue->Pool, targetQueue->Buckets, old * sizeof(int), targetQueue->BucketCount * sizeof(int));
+		for (i = old; i < targetQueue->BucketCount; i++)
+		{
+			targetQueue->Buckets[i] = -1;
+		}
+	}
+	targetQueue->Key[cell] = f;
+	targetQueue->Level[cell] = g;
+	targetQueue->Prev[cell] = -1;
+	targetQueue->Next[cell] = targetQueue->Buckets[f]; // The new cell points to the previous top and
+	if (targetQueue->Next[cell] >= 0)                 // becomes the new top
+	{
+		targetQueue->Prev[targetQueue->Next[cell]] = cell;
+	}
+	targetQueue->Buckets[f] = cell;
+	if ((unsigned int)f < targetQueue->Min) targetQueue->Min = f; // f(n) is monotone in A*, but don't rely on it
+	targetQueue->Count++;
+}
+
+// <summary>
+// PeekBucketQueue - returns the cell that the next Pop will return (as y * Width + x), or -1 if the queue
+//                   is empty
+//                 - advances Min past empty buckets; amortized O(1) since Min only moves forward
+// </summary>
+int PeekBucketQueue(BucketQueue * targetQueue)
+{
+	if (targetQueue->Count == 0) return -1;
+	while (targetQueue->Buckets[targetQueue->Min] < 0)
+	{
+		targetQueue->Min++;
+	}
+	return targetQueue->Buckets[targetQueue->Min];
+}
+
+// <summary>
+// PopFromBucketQueue - removes the top cell of the lowest nonempty bucket and returns its coordinates
+// </summary>
+coordinate PopFromBucketQueue(BucketQueue * targetQueue)
+{
+	coordinate data;
+	int cell = PeekBucketQueue(targetQueue);
+	if (cell < 0)
+	{
+		BucketQueueUnderflow(); // Queue is empty; Call UNDERFLOW
+		data.x = -1;
+		data.y = -1;
+		return data;
+	}
+	UnlinkFromBucket(targetQueue, cell);
+	data.x = cell % targetQueue->Width;
+	data.y = cell / targetQueue->Width;
+	return data;
+}
+
+// <summary>
+// UnlinkFromBucket - takes a queued cell out of its bucket in O(1)
+// </summary>
+void UnlinkFromBucket(BucketQueue * targetQueue, int cell)
+{
+	int prev = targetQueue->Prev[cell];
+	int next = targetQueue->Next[cell];
+	if (prev >= 0)
+	{
+		targetQueue->Next[prev] = next;
+	}
+	else
+	{
+		targetQueue->Buckets[targetQueue->Key[cell]] = next; // cell was the top of its bucket
+	}
+	if (next >= 0)
+	{
+		targetQueue->Prev[next] = prev;
+	}
+	targetQueue->Key[cell] = -1;
+	targetQueue->Count--;
+}
+
+// <summary>
+// BucketQueueUnderflow - do stuff if another function determines that the Bucket Queue is empty and a
+//						  manipulation needs to be cancelled
+// </summary>
+void BucketQueueUnderflow()
+{
+	// Print error; DO NOT EXIT
+	printf("\n\nERR: Bucket Queue Underflow\nCannot Pop From Empty Bucket Queue\n\n");
+	return;
+}
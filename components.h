@@ -0,0 +1,387 @@
+/****************************************************************************
+'components.h' - implements functions that label the connected regions of
+                 free tiles in an obstacle mask, and keep the labels right
+                 while single tiles are blocked and freed
+*****************************************************************************/
+#pragma once
+#include "cardinal.h"
+
+#define COMPONENT_SEEDS 4 // a tile has 4 neighbours, so blocking it splits its region at most 4 ways
+#define COMPONENT_UNLABELLED UINT32_MAX // free tile not reached yet while labelling from scratch
+
+typedef struct
+{
+	uint32_t * Label; // Label[y * Width + x] = region of tile (x,y); 0 if the tile is blocked
+	uint32_t * Size; // Size[l] = number of tiles labelled l; 0 for labels that went away
+	uint32_t Count; // labels 1 to Count have been handed out; they are never reused until the next relabelling
+	unsigned int Width;
+	unsigned int Height;
+} ComponentLabels; // Two free tiles are connected, moving in the 4 directions, if and only if their labels match
+
+// Function declarations
+ComponentLabels * CreateComponentLabels(const uint8_t * blocked, unsigned int width, unsigned int height);
+void AnnihilateComponentLabels(ComponentLabels * labels);
+bool RelabelComponents(ComponentLabels * labels);
+bool ReserveComponentLabels(ComponentLabels * labels, unsigned int n);
+bool BlockComponentCell(ComponentLabels * labels, unsigned int cell);
+bool FreeComponentCell(ComponentLabels * labels, unsigned int cell);
+unsigned int ComponentSeeds(ComponentLabels * labels, unsigned int cell, unsigned int * seeds);
+bool SplitComponent(ComponentLabels * labels, uint32_t from, const unsigned int * seeds, unsigned int n);
+unsigned int ComponentNeighbours(ComponentLabels * labels, unsigned int cell, unsigned int * neighbours);
+unsigned int FloodComponent(ComponentLabels * labels, unsigned int * queue, unsigned int seed, uint32_t from, uint32_t to);
+unsigned int ComponentGroup(unsigned int * group, unsigned int s);
+
+// <summary>
+// CreateComponentLabels - labels the regions of free tiles of a width x height obstacle mask (1 = blocked) and
+//                         returns the labels, or NULL if there isn't enough memory
+//                       - costs 8 bytes per tile; labelling takes one pass over the map
+//                       - The creator has the implicit responsibility of freeing up the labels later
+//                         using the AnnihilateComponentLabels(..) function
+// </summary>
+ComponentLabels * CreateComponentLabels(const uint8_t * blocked, unsigned int width, unsigned int height)
+{
+	size_t cells = (size_t)width * height;
+	ComponentLabels * labels = malloc(sizeof(ComponentLabels));
+	labels->Width = width;
+	labels->Height = height;
+	labels->Count = 0;
+	labels->Label = malloc(cells * sizeof(uint32_t));
+	// Room for a label per tile, plus the ones a split hands out before the next relabelling
+	labels->Size = malloc((cells + COMPONENT_SEEDS + 1) * sizeof(uint32_t));
+	if (labels->Label == NULL || labels->Size == NULL)
+	{
+		AnnihilateComponentLabels(labels);
+		return NULL;
+	}
+	size_t i;
+	for (i = 0; i < cells; i++)
+	{
+		labels->Label[i] = !blocked[i]; // Any nonzero label will do; RelabelComponents(..) only tells 0 apart
+	}
+	if (!RelabelComponents(labels))
+	{
+		AnnihilateComponentLabels(labels);
+		return NULL;
+	}
+	return labels;
+}
+
+// <summary>
+// AnnihilateComponentLabels - frees up the label grid, the sizes and the labels themselves
+// </summary>
+void AnnihilateComponentLabels(ComponentLabels * labels)
+{
+	free(labels->Label);
+	free(labels->Size);
+	free(labels);
+}
+
+// <summary>
+// RelabelComponents - labels every region from scratch, as 1 to Count in scan order; only which tiles are labelled
+//                     0, i.e., blocked, matters beforehand
+//                   - returns false if there isn't enough memory for the flood fill (the labels are then garbage)
+// </summary>
+bool RelabelComponents(ComponentLabels * labels)
+{
+	unsigned int cells = labels->Width * labels->Height;
+	unsigned int * queue = malloc((cells > 0 ? cells : 1) * sizeof(unsigned int));
+	unsigned int i;
+	if (queue == NULL) return false;
+	for (i = 0; i < cells; i++)
+	{
+		if (labels->Label[i] != 0) labels->Label[i] = COMPONENT_UNLABELLED;
+	}
+	labels->Count = 0;
+	labels->Size[0] = 0;
+	for (i = 0; i < cells; i++)
+	{
+		if (labels->Label[i] != COMPONENT_UNLABELLED) continue;
+		labels->Count++;
+		labels->Size[labels->Count] = FloodComponent(labels, queue, i, COMPONENT_UNLABELLED, labels->Count);
+	}
+	free(queue);
+	return true;
+}
+
+// <summary>
+// ReserveComponentLabels - makes sure n more labels can be handed out, relabelling from scratch to take back the
+//                          ones that went away if they can't; that happens once every Width * Height / n updates
+//                          at most, so it costs O(n) per update on average
+//                        - returns false if there isn't enough memory (the labels are then garbage)
+// </summary>
+bool ReserveComponentLabels(ComponentLabels * labels, unsigned int n)
+{
+	if ((size_t)labels->Count + n <= (size_t)labels->Width * labels->Height + COMPONENT_SEEDS) return true;
+	return RelabelComponents(labels);
+}
+
+// <summary>
+// BlockComponentCell - updates the labels after tile 'cell' of the mask was blocked
+//                    - the 8 tiles around it tell in O(1) whether its free neighbours are still connected without
+//                      it; only if they might not be does it search from them, one step each in turn, and it stops
+//                      as soon as all but one have met or run out, so the cost is about the size of the smaller
+//                      pieces rather than of the whole region
+//                    - returns false if there isn't enough memory (the labels are then garbage)
+// </summary>
+bool BlockComponentCell(ComponentLabels * labels, unsigned int cell)
+{
+	uint32_t from = labels->Label[cell];
+	unsigned int seeds[COMPONENT_SEEDS];
+	if (from == 0) return true; // Already blocked
+	if (!ReserveComponentLabels(labels, COMPONENT_SEEDS)) return false;
+	from = labels->Label[cell]; // Relabelling may have renamed it
+	labels->Label[cell] = 0;
+	labels->Size[from]--;
+	unsigned int n = ComponentSeeds(labels, cell, seeds);
+	if (n <= 1) return true; // Its free neighbours still touch each other around it
+	return SplitComponent(labels, from, seeds, n);
+}
+
+// <summary>
+// FreeComponentCell - updates the labels after tile 'cell' of the mask was freed
+//                   - the regions around it become one; all but the biggest are relabelled to it, so the cost is
+//                     the size of the smaller ones
+//                   - returns false if there isn't enough memory (the labels are then garbage)
+// </summary>
+bool FreeComponentCell(ComponentLabels * labels, unsigned int cell)
+{
+	unsigned int neighbours[COMPONENT_SEEDS];
+	unsigned int n = ComponentNeighbours(labels, cell, neighbours);
+	uint32_t keep = 0;
+	unsigned int i, largest = 0;
+	if (labels->Label[cell] != 0) return true; // Already free
+	if (!ReserveComponentLabels(labels, 1)) return false;
+	for (i = 0; i < n; i++)
+	{
+		uint32_t l = labels->Label[neighbours[i]];
+		if (l != 0 && (keep == 0 || labels->Size[l] > labels->Size[keep])) keep = l;
+	}
+	if (keep == 0) // No free neighbours; a region of its own
+	{
+		labels->Count++;
+		labels->Label[cell] = labels->Count;
+		labels->Size[labels->Count] = 1;
+		return true;
+	}
+	for (i = 0; i < n; i++)
+	{
+		uint32_t l = labels->Label[neighbours[i]];
+		if (l != 0 && l != keep && labels->Size[l] > largest) largest = labels->Size[l];
+	}
+	if (largest > 0)
+	{
+		unsigned int * queue = malloc(largest * sizeof(unsigned int)); // Big enough for any region but keep
+		if (queue == NULL) return false;
+		for (i = 0; i < n; i++)
+		{
+			uint32_t l = labels->Label[neighbours[i]];
+			if (l == 0 || l == keep) continue; // Blocked, or merged already
+			labels->Size[keep] += FloodComponent(labels, queue, neighbours[i], l, keep);
+			labels->Size[l] = 0;
+		}
+		free(queue);
+	}
+	labels->Label[cell] = keep;
+	labels->Size[keep]++;
+	return true;
+}
+
+// <summary>
+// ComponentSeeds - walks the 8 tiles around 'cell' and puts one free neighbour of each run of free tiles there into
+//                  seeds; neighbours in the same run are connected around the corner, so only tiles in different
+//                  runs can have lost their connection
+//                - returns the number of seeds; tiles outside the mask count as blocked
+// </summary>
+unsigned int ComponentSeeds(ComponentLabels * labels, unsigned int cell, unsigned int * seeds)
+{
+	static const int dx[8] = {0, 1, 1, 1, 0, -1, -1, -1}; // Clockwise from straight up; even ones are neighbours
+	static const int dy[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+	int x = cell % labels->Width;
+	int y = cell / labels->Width;
+	bool free[8];
+	unsigned int n = 0;
+	int k, first = -1;
+	for (k = 0; k < 8; k++)
+	{
+		int nx = x + dx[k];
+		int ny = y + dy[k];
+		free[k] = nx >= 0 && ny >= 0 && nx < (int)labels->Width && ny < (int)labels->Height
+			&& labels->Label[ny * labels->Width + nx] != 0;
+		if (!free[k] && first < 0) first = k;
+	}
+	if (first < 0) // A free ring is a single run
+	{
+		seeds[0] = (y - 1) * labels->Width + x;
+		return 1;
+	}
+	bool seeded = false; // whether the current run has its seed already
+	for (k = first + 1; k <= first + 8; k++)
+	{
+		int j = k % 8;
+		if (!free[j])
+		{
+			seeded = false;
+			continue;
+		}
+		if (j % 2 == 0 && !seeded)
+		{
+			seeds[n++] = (y + dy[j]) * labels->Width + (x + dx[j]);
+			seeded = true;
+		}
+	}
+	return n;
+}
+
+// <summary>
+// SplitComponent - relabels the pieces region 'from' fell apart into, given one tile in each of n possible pieces
+//                - each seed floods a temporary label of its own, one tile per seed in turn; seeds whose floods
+//                  touch are one piece, and a piece whose floods all ran out is finished and keeps a new label
+//                - stops once at most one piece is unfinished; that one (the biggest, most of the time) keeps 'from',
+//                  without ever being flooded in full
+// </summary>
+bool SplitComponent(ComponentLabels * labels, uint32_t from, const unsigned int * seeds, unsigned int n)
+{
+	unsigned int * queue[COMPONENT_SEEDS];
+	unsigned int head[COMPONENT_SEEDS], count[COMPONENT_SEEDS], capacity[COMPONENT_SEEDS], group[COMPONENT_SEEDS];
+	unsigned int neighbours[COMPONENT_SEEDS];
+	uint32_t base = labels->Count; // seed s floods label base + 1 + s
+	unsigned int s, t, i, k, open = n;
+	bool enough = true;
+	for (s = 0; s < n; s++)
+	{
+		capacity[s] = 64;
+		queue[s] = malloc(capacity[s] * sizeof(unsigned int));
+		if (queue[s] == NULL) enough = false;
+	}
+	for (s = 0; s < n && enough; s++)
+	{
+		queue[s][0] = seeds[s];
+		head[s] = 0;
+		count[s] = 1;
+		group[s] = s;
+		labels->Label[seeds[s]] = base + 1 + s;
+		labels->Size[base + 1 + s] = 0;
+	}
+	while (enough && open > 1)
+	{
+		for (s = 0; s < n && enough; s++)
+		{
+			if (head[s] == count[s]) continue; // This flood ran out
+			unsigned int m = ComponentNeighbours(labels, queue[s][head[s]++], neighbours);
+			for (k = 0; k < m; k++)
+			{
+				uint32_t l = labels->Label[neighbours[k]];
+				if (l == from)
+				{
+					if (count[s] == capacity[s])
+					{
+						capacity[s] *= 2;
+						unsigned int * grown = realloc(queue[s], capacity[s] * sizeof(unsigned int));
+						if (grown == NULL)
+						{
+							enough = false;
+							break;
+						}
+						queue[s] = grown;
+					}
+					labels->Label[neighbours[k]] = base + 1 + s;
+					queue[s][count[s]++] = neighbours[k];
+				}
+				else if (l > base && l <= base + n)
+				{
+					unsigned int a = ComponentGroup(group, s);
+					unsigned int b = ComponentGroup(group, l - base - 1);
+					if (a != b) group[b] = a; // The two floods met; same piece
+				}
+			}
+		}
+		// Count the pieces that are still growing
+		open = 0;
+		for (s = 0; s < n; s++)
+		{
+			if (ComponentGroup(group, s) != s) continue;
+			for (t = 0; t < n; t++)
+			{
+				if (ComponentGroup(group, t) == s && head[t] < count[t]) break;
+			}
+			if (t < n) open++;
+		}
+	}
+	if (enough)
+	{
+		labels->Count += n;
+		for (s = 0; s < n; s++)
+		{
+			unsigned int g = ComponentGroup(group, s);
+			bool growing = false;
+			for (t = 0; t < n; t++)
+			{
+				if (ComponentGroup(group, t) == g && head[t] < count[t]) growing = true;
+			}
+			uint32_t to = growing ? from : base + 1 + g; // A finished piece takes its root seed's label
+			for (i = 0; i < count[s]; i++)
+			{
+				labels->Label[queue[s][i]] = to;
+			}
+			if (!growing)
+			{
+				labels->Size[to] += count[s];
+				labels->Size[from] -= count[s];
+			}
+		}
+	}
+	for (s = 0; s < n; s++)
+	{
+		free(queue[s]);
+	}
+	return enough;
+}
+
+// <summary>
+// ComponentNeighbours - puts the tiles right, left, above and below 'cell' that lie inside the mask into
+//                       neighbours, and returns how many there are
+// </summary>
+unsigned int ComponentNeighbours(ComponentLabels * labels, unsigned int cell, unsigned int * neighbours)
+{
+	unsigned int W = labels->Width;
+	unsigned int x = cell % W;
+	unsigned int n = 0;
+	if (x + 1 < W) neighbours[n++] = cell + 1;
+	if (x > 0) neighbours[n++] = cell - 1;
+	if (cell >= W) neighbours[n++] = cell - W;
+	if (cell + W < W * labels->Height) neighbours[n++] = cell + W;
+	return n;
+}
+
+// <summary>
+// FloodComponent - relabels the tiles labelled 'from' that are connected to 'seed' (itself labelled 'from') as
+//                  'to', breadth-first, and returns how many there were
+//                - queue must have room for all of them
+// </summary>
+unsigned int FloodComponent(ComponentLabels * labels, unsigned int * queue, unsigned int seed, uint32_t from, uint32_t to)
+{
+	unsigned int neighbours[COMPONENT_SEEDS];
+	unsigned int head = 0, count = 1, k;
+	labels->Label[seed] = to;
+	queue[0] = seed;
+	while (head < count)
+	{
+		unsigned int m = ComponentNeighbours(labels, queue[head++], neighbours);
+		for (k = 0; k < m; k++)
+		{
+			if (labels->Label[neighbours[k]] != from) continue;
+			labels->Label[neighbours[k]] = to;
+			queue[count++] = neighbours[k];
+		}
+	}
+	return count;
+}
+
+// <summary>
+// ComponentGroup - the seed that stands for seed s's piece in SplitComponent(..)
+// </summary>
+unsigned int ComponentGroup(unsigned int * group, unsigned int s)
+{
+	while (group[s] != s) s = group[s];
+	return s;
+}
@@ -0,0 +1,351 @@
+#pragma once
+#include "line.h"
+#include "stack.h"
+#include "grid.h"
+#include <limits.h> // INT_MAX
+
+/*  D* LITE: REPAIRING A SEARCH WHEN THE MAP CHANGES
+ *  The search runs from the goal and keeps two numbers per tile: g, its distance to the goal as last expanded,
+ *  and rhs, the distance its neighbours' g values imply (1 + the smallest of them). A tile whose two disagree is
+ *  queued, keyed like A* towards the start. When some tiles are blocked or freed, only the rhs of those tiles and
+ *  their neighbours changes, and expanding the queue until the start is settled again touches just the part of
+ *  the search tree that the change affected. Since the tree hangs from the goal, the start can move along the
+ *  path without losing it; instead of re-keying the whole queue, Km is added to every key computed after a move.
+ */
+
+#define REPLAN_INFINITY INT_MAX // g and rhs of a tile with no known way to the goal
+
+typedef struct
+{
+    int K1; // min(g, rhs) + h(tile, start) + Km
+    int K2; // min(g, rhs); among equal K1, the tile closer to the goal comes first
+    int32_t Cell;
+} ReplanKey;
+
+typedef struct
+{
+    Grid * Map; // the obstacle map; replanCells() writes to it
+    coordinate Start;
+    coordinate Goal;
+    int * G; // G[y * Width + x] = g of tile (x,y)
+    int * Rhs; // Rhs[y * Width + x] = rhs of tile (x,y)
+    ReplanKey * Open; // binary min-heap of the tiles whose g and rhs disagree
+    int32_t * OpenPosition; // OpenPosition[y * Width + x] = index of tile (x,y) in Open, or -1
+    unsigned int OpenCount;
+    int Km; // h(old start, new start) summed over every move of the start
+} Replanner; // One incremental search between a start and a goal on a map that changes
+
+Replanner * createReplanner(Grid * map, coordinate start, coordinate goal);
+void destroyReplanner(Replanner * r);
+int replan(Replanner * r, int * expanded);
+void replanCells(Replanner * r, const coordinate * cells, unsigned int count, uint8_t blocked);
+void moveReplannerStart(Replanner * r, coordinate start);
+bool replannedPath(Replanner * r, Stack * path);
+void replanUpdate(Replanner * r, size_t cell);
+ReplanKey replanKey(Replanner * r, size_t cell);
+bool replanKeyBefore(ReplanKey a, ReplanKey b);
+void replanQueueSet(Replanner * r, size_t cell, ReplanKey key);
+void replanQueueRemove(Replanner * r, size_t cell);
+void replanQueueSift(Replanner * r, unsigned int i);
+void replanQueueSwap(Replanner * r, unsigned int i, unsigned int j);
+
+/*
+ * createReplanner() - sets up an incremental search from start to goal on the map; nothing is searched until the
+ *                     first replan(); returns NULL if there isn't enough memory
+ *                   - costs 16 bytes per tile, whatever the length of the path
+ */
+Replanner * createReplanner(Grid * map, coordinate start, coordinate goal)
+{
+    size_t cells = (size_t)map->Width * map->Height;
+    size_t cell;
+    Replanner * r = malloc(sizeof(Replanner));
+    if (r == NULL) return NULL;
+    r->Map = map;
+    r->Start = start;
+    r->Goal = goal;
+    r->G = AllocateAligned(cells * sizeof(int));
+    r->Rhs = AllocateAligned(cells * sizeof(int));
+    r->Open = AllocateAligned(cells * sizeof(ReplanKey)); // a tile is queued at most once
+    r->OpenPosition = AllocateAligned(cells * sizeof(int32_t));
+    r->OpenCount = 0;
+    r->Km = 0;
+    if (r->G == NULL || r->Rhs == NULL || r->Open == NULL || r->OpenPosition == NULL)
+    {
+        destroyReplanner(r);
+        return NULL;
+    }
+    for (cell = 0; cell < cells; cell++)
+    {
+        r->G[cell] = REPLAN_INFINITY;
+        r->Rhs[cell] = REPLAN_INFINITY;
+        r->OpenPosition[cell] = -1;
+    }
+    cell = (size_t)goal.y * map->Width + goal.x;
+    r->Rhs[cell] = 0;
+    replanQueueSet(r, cell, replanKey(r, cell));
+    return r;
+}
+
+/*
+ * destroyReplanner() - frees the search state; the map is left as it is
+ */
+void destroyReplanner(Replanner * r)
+{
+    free(r->G);
+    free(r->Rhs);
+    free(r->Open);
+    free(r->OpenPosition);
+    free(r);
+}
+
+/*
+ * replan() - brings the search up to date with every change since the last call, and returns the cost of the
+ *            shortest path from the start to the goal, or -1 if there is none
+ *          - expanded gets the number of tiles expanded by this call only; the first call is a full backward A*
+ *          - like the other strategies, the start may be blocked but the goal may not
+ *          - if the map's regions are labelled, a goal cut off from the start costs O(1) instead of a full search
+ */
+int replan(Replanner * r, int * expanded)
+{
+    unsigned int W = r->Map->Width;
+    size_t cells = (size_t)W * r->Map->Height;
+    size_t start = (size_t)r->Start.y * W + r->Start.x;
+    size_t goal = (size_t)r->Goal.y * W + r->Goal.x;
+    *expanded = 0;
+    // The labels tell a goal in another region in O(1); the queued repairs wait until it is in reach again
+    if (!GridConnected(r->Map, r->Start, r->Goal)) return -1;
+    while (r->OpenCount > 0)
+    {
+        ReplanKey top = r->Open[0];
+        if (!replanKeyBefore(top, replanKey(r, start)) && r->G[start] == r->Rhs[start]) break; // Start is settled
+        size_t u = top.Cell;
+        ReplanKey key = replanKey(r, u);
+        if (replanKeyBefore(top, key))
+        {
+            replanQueueSet(r, u, key); // Keyed before the start moved; put it back where it belongs now
+            continue;
+        }
+        (*expanded)++;
+        if (r->G[u] > r->Rhs[u])
+        {
+            r->G[u] = r->Rhs[u]; // Overconsistent: a shorter way to the goal was found, so take it
+            replanQueueRemove(r, u);
+        }
+        else
+        {
+            r->G[u] = REPLAN_INFINITY; // Underconsistent: the way it had got longer, so it has to be found again
+            replanUpdate(r, u);
+        }
+        unsigned int x = u % W;
+        if (x + 1 < W) replanUpdate(r, u + 1);
+        if (x > 0) replanUpdate(r, u - 1);
+        if (u >= W) replanUpdate(r, u - W);
+        if (u + W < cells) replanUpdate(r, u + W);
+    }
+    if (r->Map->Blocked[goal] || r->G[start] == REPLAN_INFINITY) return -1;
+    return r->G[start];
+}
+
+/*
+ * replanCells() - blocks (blocked = 1) or frees (blocked = 0) the given tiles of the map, through SetGridCell(), and
+ *                 queues the tiles whose distance to the goal may change; the next replan() repairs the path
+ *               - a polygon that moves is its old tiles freed, then its new tiles blocked; tiles outside the map
+ *                 and tiles that already were as asked are skipped
+ */
+void replanCells(Replanner * r, const coordinate * cells, unsigned int count, uint8_t blocked)
+{
+    unsigned int W = r->Map->Width;
+    unsigned int H = r->Map->Height;
+    unsigned int i;
+    for (i = 0; i < count; i++)
+    {
+        coordinate c = cells[i];
+        if (c.x < 0 || c.y < 0 || c.x >= (int)W || c.y >= (int)H) continue;
+        if (!SetGridCell(r->Map, c.x, c.y, blocked)) continue;
+        size_t v = (size_t)c.y * W + c.x;
+        // Only moves into v changed, so only v and the tiles that can move into it need a new rhs
+        replanUpdate(r, v);
+        if (c.x + 1 < (int)W) replanUpdate(r, v + 1);
+        if (c.x > 0) replanUpdate(r, v - 1);
+        if (c.y > 0) replanUpdate(r, v - W);
+        if (c.y + 1 < (int)H) replanUpdate(r, v + W);
+    }
+}
+
+/*
+ * moveReplannerStart() - moves the start, e.g. to the next tile of the path as the agent walks it; the tree is
+ *                        kept, so the next replan() only redoes what the move and any changes since call for
+ */
+void moveReplannerStart(Replanner * r, coordinate start)
+{
+    unsigned int W = r->Map->Width;
+    size_t old = (size_t)r->Start.y * W + r->Start.x;
+    r->Km += abs(start.x - r->Start.x) + abs(start.y - r->Start.y);
+    r->Start = start;
+    replanUpdate(r, old); // A blocked tile has a way to the goal only while it is the start
+    replanUpdate(r, (size_t)start.y * W + start.x);
+}
+
+/*
+ * replannedPath() - pushes the path found by the last replan() onto path, goal first and start on top like the
+ *                   paths of runSearch(); returns false, leaving path as it was, if there is none
+ *                 - the path steps from each tile to the neighbour with the smallest g, which is a shortest path
+ *                   once replan() has settled the start
+ */
+bool replannedPath(Replanner * r, Stack * path)
+{
+    unsigned int W = r->Map->Width;
+    size_t cells = (size_t)W * r->Map->Height;
+    size_t u = (size_t)r->Start.y * W + r->Start.x;
+    size_t goal = (size_t)r->Goal.y * W + r->Goal.x;
+    unsigned int bottom = path->Depth;
+    int steps;
+    if (r->Map->Blocked[goal] || r->G[u] == REPLAN_INFINITY) return false;
+    ReserveStack(path, bottom + r->G[u] + 1);
+    PushToStack(path, r->Start.x, r->Start.y);
+    for (steps = r->G[u]; steps > 0 && u != goal; steps--)
+    {
+        size_t v[4], next = u;
+        int n = 0, i;
+        if (u % W + 1 < W) v[n++] = u + 1;
+        if (u % W > 0) v[n++] = u - 1;
+        if (u >= W) v[n++] = u - W;
+        if (u + W < cells) v[n++] = u + W;
+        for (i = 0; i < n; i++)
+        {
+            if (r->Map->Blocked[v[i]]) continue;
+            if (next == u || r->G[v[i]] < r->G[next]) next = v[i];
+        }
+        u = next;
+        PushToStack(path, u % W, u / W);
+    }
+    // Walked from the start, so the start is at the bottom; turn the new part of the stack upside down
+    unsigned int i = bottom, j = path->Depth - 1;
+    while (i < j)
+    {
+        coordinate temp = path->Data[i];
+        path->Data[i++] = path->Data[j];
+        path->Data[j--] = temp;
+    }
+    return true;
+}
+
+/*
+ * replanUpdate() - recomputes the rhs of a tile from its neighbours, and queues the tile if it now disagrees with
+ *                  its g, or takes it out of the queue if it doesn't
+ */
+void replanUpdate(Replanner * r, size_t cell)
+{
+    unsigned int W = r->Map->Width;
+    size_t cells = (size_t)W * r->Map->Height;
+    size_t start = (size_t)r->Start.y * W + r->Start.x;
+    size_t goal = (size_t)r->Goal.y * W + r->Goal.x;
+    if (cell != goal)
+    {
+        int best = REPLAN_INFINITY;
+        // Nothing moves into a blocked tile, so its own distance only matters if the search starts there
+        if (!r->Map->Blocked[cell] || cell == start)
+        {
+            size_t v[4];
+            int n = 0, i;
+            if (cell % W + 1 < W) v[n++] = cell + 1;
+            if (cell % W > 0) v[n++] = cell - 1;
+            if (cell >= W) v[n++] = cell - W;
+            if (cell + W < cells) v[n++] = cell + W;
+            for (i = 0; i < n; i++)
+            {
+                if (r->Map->Blocked[v[i]] || r->G[v[i]] == REPLAN_INFINITY) continue;
+                if (r->G[v[i]] + 1 < best) best = r->G[v[i]] + 1;
+            }
+        }
+        r->Rhs[cell] = best;
+    }
+    if (r->G[cell] != r->Rhs[cell]) replanQueueSet(r, cell, replanKey(r, cell));
+    else replanQueueRemove(r, cell);
+}
+
+/*
+ * replanKey() - the key a tile would be queued with now
+ */
+ReplanKey replanKey(Replanner * r, size_t cell)
+{
+    ReplanKey key;
+    unsigned int W = r->Map->Width;
+    int m = (r->G[cell] < r->Rhs[cell]) ? r->G[cell] : r->Rhs[cell];
+    key.Cell = cell;
+    key.K2 = m;
+    key.K1 = (m == REPLAN_INFINITY) ? m : m + abs((int)(cell % W) - r->Start.x) + abs((int)(cell / W) - r->Start.y) + r->Km;
+    return key;
+}
+
+/*
+ * replanKeyBefore() - true if key a comes out of the queue before key b
+ */
+bool replanKeyBefore(ReplanKey a, ReplanKey b)
+{
+    if (a.K1 != b.K1) return a.K1 < b.K1;
+    return a.K2 < b.K2;
+}
+
+/*
+ * replanQueueSet() - queues a tile with the given key, or moves it to that key if it is already queued
+ */
+void replanQueueSet(Replanner * r, size_t cell, ReplanKey key)
+{
+    int32_t i = r->OpenPosition[cell];
+    if (i < 0)
+    {
+        i = r->OpenCount++;
+        r->OpenPosition[cell] = i;
+    }
+    r->Open[i] = key;
+    replanQueueSift(r, i);
+}
+
+/*
+ * replanQueueRemove() - takes a tile out of the queue, if it is there
+ */
+void replanQueueRemove(Replanner * r, size_t cell)
+{
+    int32_t i = r->OpenPosition[cell];
+    if (i < 0) return;
+    r->OpenPosition[cell] = -1;
+    if ((unsigned int)i == --r->OpenCount) return;
+    // The last entry takes its place, then goes up or down from there
+    r->Open[i] = r->Open[r->OpenCount];
+    r->OpenPosition[r->Open[i].Cell] = i;
+    replanQueueSift(r, i);
+}
+
+/*
+ * replanQueueSift() - moves the entry at index i of the queue up or down until it is in order again
+ */
+void replanQueueSift(Replanner * r, unsigned int i)
+{
+    while (i > 0 && replanKeyBefore(r->Open[i], r->Open[(i - 1) / 2]))
+    {
+        replanQueueSwap(r, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    while (1)
+    {
+        unsigned int best = i, c = 2 * i + 1;
+        if (c < r->OpenCount && replanKeyBefore(r->Open[c], r->Open[best])) best = c;
+        if (c + 1 < r->OpenCount && replanKeyBefore(r->Open[c + 1], r->Open[best])) best = c + 1;
+        if (best == i) break;
+        replanQueueSwap(r, i, best);
+        i = best;
+    }
+}
+
+/*
+ * replanQueueSwap() - swaps two entries of the queue and keeps OpenPosition in sync
+ */
+void replanQueueSwap(Replanner * r, unsigned int i, unsigned int j)
+{
+    ReplanKey temp = r->Open[i];
+    r->Open[i] = r->Open[j];
+    r->Open[j] = temp;
+    r->OpenPosition[r->Open[i].Cell] = i;
+    r->OpenPosition[r->Open[j].Cell] = j;
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include "line.h"
+#include "grid.h"
+#include "search.h"
+#include <pthread.h> // pthread_create(), pthread_join()
+#include <stdatomic.h> // atomic_uint, atomic_fetch_add()
+#include <time.h> // clock_gettime(), CLOCK_MONOTONIC
+
+// Number of queries a worker claims at a time; big enough to keep the shared counter cold,
+// small enough that a few slow queries don't leave the other workers idle at the end
+#define EXECUTOR_CHUNK 16
+
+typedef struct
+{
+    coordinate Start;
+    coordinate Goal;
+    int Strategy;
+    int FringeType;
+    // Filled in by the executor
+    bool Found;
+    int Cost; // number of steps in the path (legs between waypoints, for the visibility strategy), or -1 if none
+    double Length; // length of the path in straight lines between its entries (= Cost except for waypoints), or -1
+    int Expanded; // number of expanded nodes
+} BatchQuery;
+
+typedef struct
+{
+    Grid * Map; // shared by every worker, never written
+    BatchQuery * Queries;
+    unsigned int Count;
+    atomic_uint Next; // first query no worker has claimed yet
+    atomic_bool OutOfMemory; // set by a worker that couldn't allocate its search state
+} Executor;
+
+bool runQueries(Grid * map, BatchQuery * queries, unsigned int count, unsigned int threads);
+void * executorWorker(void * arg);
+double wallTime();
+uint64_t wallNanoseconds();
+
+/*
+ * runQueries() - answers every query on the map with the given number of threads, storing the results in the queries
+ *              - each thread owns one SearchContext, reused for all of its queries; only the map is shared
+ *              - threads claim queries in chunks of EXECUTOR_CHUNK from a shared counter, so results don't depend
+ *                on which thread ran which query
+ *              - JPS+, ALT, HPA* and visibility queries need the map's table or graph to be built beforehand
+ *              - returns false if a thread couldn't be started or ran out of memory
+ */
+bool runQueries(Grid * map, BatchQuery * queries, unsigned int count, unsigned int threads)
+{
+    Executor ex;
+    unsigned int i, started;
+    bool ok = true;
+    ex.Map = map;
+    ex.Queries = queries;
+    ex.Count = count;
+    atomic_init(&ex.Next, 0);
+    atomic_init(&ex.OutOfMemory, false);
+    if (threads <= 1)
+    {
+        executorWorker(&ex); // No point in a thread when there's nothing to run it alongside
+        return !atomic_load(&ex.OutOfMemory);
+    }
+    pthread_t * pool = malloc(threads * sizeof(pthread_t));
+    for (started = 0; started < threads; started++)
+    {
+        if (pthread_create(&pool[started], NULL, executorWorker, &ex) != 0)
+        {
+            ok = false;
+            break;
+        }
+    }
+    for (i = 0; i < started; i++)
+    {
+        pthread_join(pool[i], NULL);
+    }
+    free(pool);
+    return ok && !atomic_load(&ex.OutOfMemory);
+}
+
+/*
+ * executorWorker() - body of one executor thread: keeps claiming chunks of queries until there are none left
+ */
+void * executorWorker(void * arg)
+{
+    Executor * ex = arg;
+    SearchContext * ctx = createSearchContext(ex->Map);
+    if (ctx == NULL)
+    {
+        atomic_store(&ex->OutOfMemory, true);
+        return NULL; // The other workers stop too, and runQueries() reports the failure
+    }
+    while (!atomic_load(&ex->OutOfMemory))
+    {
+        unsigned int first = atomic_fetch_add(&ex->Next, EXECUTOR_CHUNK);
+        unsigned int i;
+        if (first >= ex->Count) break;
+        for (i = first; i < first + EXECUTOR_CHUNK && i < ex->Count; i++)
+        {
+            BatchQuery * q = &ex->Queries[i];
+            if (!reserveStrategy(ctx, q->Strategy))
+            {
+                atomic_store(&ex->OutOfMemory, true);
+                break;
+            }
+            PROFILE_START(began);
+            SearchResult result = runSearch(ctx, q->Strategy, q->FringeType, q->Start, q->Goal);
+            PROFILE_STOP(began, PROFILE_SEARCH);
+            q->Found = result.Found;
+            q->Cost = result.Found ? (int)result.Path->Depth - 1 : -1;
+            q->Length = result.Found ? pathLength(result.Path) : -1;
+            q->Expanded = result.Expanded;
+        }
+    }
+    destroySearchContext(ctx);
+    return NULL;
+}
+
+/*
+ * wallTime() - monotonic wall-clock time in seconds; unlike clock(), it doesn't add up the time of every thread
+ */
+double wallTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * wallNanoseconds() - the same clock as wallTime(), in whole nanoseconds; a double of seconds since boot only
+ *                     keeps a few hundred of them, which is too coarse for one search on a small map
+ */
+uint64_t wallNanoseconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
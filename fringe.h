@@ -0,0 +1,250 @@
+/****************************************************************************
+'fringe.h' - implements functions that perform operations or manipulations
+             on A* Fringes, which wrap one of the priority queue
+             implementations so that Astar() can be run on any of them
+           - Programmer: Vincent Paul Fiestada
+*****************************************************************************/
+
+#pragma once
+#include "slist.h"
+#include "heap.h"
+#include "bucket.h"
+#include "profile.h"
+
+// A* fringe implementations
+#define FRINGE_LIST 1 // Sorted doubly linked list; O(n) insert, keeps stale duplicates
+#define FRINGE_HEAP 2 // Indexed d-ary heap; O(log n) insert/pop with decrease-key
+#define FRINGE_BUCKET 3 // Bucket queue indexed by f; O(1) insert/pop with decrease-key, integer f only
+
+typedef struct
+{
+	int Type; // one of the FRINGE_* constants
+	SortedList * List; // used if Type == FRINGE_LIST
+	Heap * Heap; // used if Type == FRINGE_HEAP
+	BucketQueue * Buckets; // used if Type == FRINGE_BUCKET
+	Arena * Pool; // where the fringe and its queue come from; NULL means malloc
+	unsigned int Peak; // most cells the fringe has held at once since it was created or last cleared
+} AstarFringe;
+
+
+AstarFringe * CreateNewAstarFringe(int type, unsigned int width, unsigned int height);
+AstarFringe * CreateNewAstarFringeInArena(Arena * pool, int type, unsigned int width, unsigned int height);
+void AnnihilateAstarFringe(AstarFringe * targetFringe);
+void ClearAstarFringe(AstarFringe * targetFringe);
+void InsertToAstarFringe(AstarFringe * targetFringe, unsigned int x, unsigned int y, int f, int g);
+coordinate PopFromAstarFringe(AstarFringe * targetFringe, int * g);
+int PeekAstarFringe(AstarFringe * targetFringe);
+bool IsAstarFringeEmpty(AstarFringe * targetFringe);
+unsigned int AstarFringeSize(AstarFringe * targetFringe);
+void PrintAstarFringe(AstarFringe * targetFringe);
+
+// <summary>
+// CreateNewAstarFringe - allocates space for a new empty fringe of the given type over a width x height grid
+//                      - unknown types fall back to FRINGE_BUCKET
+//				        - The creator has the implicit responsibility of freeing up memory later
+// </summary>
+AstarFringe * CreateNewAstarFringe(int type, unsigned int width, unsigned int height)
+{
+	return CreateNewAstarFringeInArena(NULL, type, width, height);
+}
+
+// <summary>
+// CreateNewAstarFringeInArena - same as CreateNewAstarFringe, but the fringe and its queue are drawn from the
+//                               given Arena
+// </summary>
+AstarFringe * CreateNewAstarFringeInArena(Arena * pool, int type, unsigned int width, unsigned int height)
+{
+	AstarFringe * n = ArenaAlloc(pool, sizeof(AstarFringe));
+	n->Pool = pool;
+	n->List = NULL;
+	n->Heap = NULL;
+	n->Buckets = NULL;
+	n->Peak = 0;
+	if (type == FRINGE_LIST)
+	{
+		n->Type = FRINGE_LIST;
+		n->List = CreateNewSortedListInArena(pool);
+	}
+	else if (type == FRINGE_HEAP)
+	{
+		n->Type = FRINGE_HEAP;
+		n->Heap = CreateNewHeapInArena(pool, width, height);
+	}
+	else
+	{
+		n->Type = FRINGE_BUCKET;
+		n->Buckets = CreateNewBucketQueueInArena(pool, width, height);
+	}
+	return n;
+}
+
+// <summary>
+// AnnihilateAstarFringe - frees up the underlying priority queue and the fringe itself
+// </summary>
+void AnnihilateAstarFringe(AstarFringe * targetFringe)
+{
+	if (targetFringe->List != NULL) AnnihilateSortedList(targetFringe->List);
+	if (targetFringe->Heap != NULL) AnnihilateHeap(targetFringe->Heap);
+	if (targetFringe->Buckets != NULL) AnnihilateBucketQueue(targetFringe->Buckets);
+	ArenaFree(targetFringe->Pool, targetFringe);
+	return;
+}
+
+// <summary>
+// ClearAstarFringe - empties the fringe so that it can be reused for another search, and forgets its Peak
+// </summary>
+void ClearAstarFringe(AstarFringe * targetFringe)
+{
+	targetFringe->Peak = 0;
+	switch (targetFringe->Type)
+	{
+		case FRINGE_LIST:
+			ClearSortedList(targetFringe->List);
+			break;
+		case FRINGE_HEAP:
+			ClearHeap(targetFringe->Heap);
+			break;
+		default:
+			ClearBucketQueue(targetFringe->Buckets);
+	}
+}
+
+// <summary>
+// InsertToAstarFringe - inserts a cell with cost f and level g into the fringe
+//                     - keeps track of the fringe's Peak size
+//                     - with PROFILE, counts the insert, and an insert that didn't grow the fringe as a duplicate
+// </summary>
+void InsertToAstarFringe(AstarFringe * targetFringe, unsigned int x, unsigned int y, int f, int g)
+{
+	unsigned int size;
+	#ifdef PROFILE
+		unsigned int before = AstarFringeSize(targetFringe);
+	#endif
+	switch (targetFringe->Type)
+	{
+		case FRINGE_LIST:
+			InsertToSortedList(targetFringe->List, x, y, f, g);
+			size = targetFringe->List->Count;
+			break;
+		case FRINGE_HEAP:
+			InsertToHeap(targetFringe->Heap, x, y, f, g);
+			size = targetFringe->Heap->Count;
+			break;
+		default:
+			InsertToBucketQueue(targetFringe->Buckets, x, y, f, g);
+			size = targetFringe->Buckets->Count;
+	}
+	if (size > targetFringe->Peak) targetFringe->Peak = size;
+	PROFILE_COUNT(PROFILE_PUSHES);
+	#ifdef PROFILE
+		if (size == before) profileCount(PROFILE_DUPLICATES, 1); // Updated in place
+	#endif
+}
+
+// <summary>
+// PopFromAstarFringe - removes the cell with the smallest f and returns its coordinates
+//                    - the level of the popped cell is written into g
+// </summary>
+coordinate PopFromAstarFringe(AstarFringe * targetFringe, int * g)
+{
+	PROFILE_COUNT(PROFILE_POPS);
+	switch (targetFringe->Type)
+	{
+		case FRINGE_LIST:
+			*g = targetFringe->List->Head->g;
+			return PopFromSortedList(targetFringe->List);
+		case FRINGE_HEAP:
+			*g = targetFringe->Heap->Nodes[0].g;
+			return PopFromHeap(targetFringe->Heap);
+		default:
+			*g = targetFringe->Buckets->Level[PeekBucketQueue(targetFringe->Buckets)];
+			return PopFromBucketQueue(targetFringe->Buckets);
+	}
+}
+
+// <summary>
+// PeekAstarFringe - returns the smallest f in the fringe, i.e., that of the cell the next Pop will return,
+//                   w/out popping it; the fringe must not be empty
+// </summary>
+int PeekAstarFringe(AstarFringe * targetFringe)
+{
+	switch (targetFringe->Type)
+	{
+		case FRINGE_LIST:
+			return targetFringe->List->Head->f;
+		case FRINGE_HEAP:
+			return targetFringe->Heap->Nodes[0].f;
+		default:
+			return targetFringe->Buckets->Key[PeekBucketQueue(targetFringe->Buckets)];
+	}
+}
+
+// <summary>
+// IsAstarFringeEmpty - true if there is nothing left to pop
+// </summary>
+bool IsAstarFringeEmpty(AstarFringe * targetFringe)
+{
+	switch (targetFringe->Type)
+	{
+		case FRINGE_LIST:
+			return targetFringe->List->Head == NULL;
+		case FRINGE_HEAP:
+			return targetFringe->Heap->Count == 0;
+		default:
+			return targetFringe->Buckets->Count == 0;
+	}
+}
+
+// <summary>
+// AstarFringeSize - number of cells in the fringe; for the sorted list, stale duplicates count too
+// </summary>
+unsigned int AstarFringeSize(AstarFringe * targetFringe)
+{
+	switch (targetFringe->Type)
+	{
+		case FRINGE_LIST:
+			return targetFringe->List->Count;
+		case FRINGE_HEAP:
+			return targetFringe->Heap->Count;
+		default:
+			return targetFringe->Buckets->Count;
+	}
+}
+
+// <summary>
+// PrintAstarFringe - prints the contents of the fringe w/out popping them
+//                  - the list and the bucket queue are printed in pop order, the heap in storage order
+// </summary>
+void PrintAstarFringe(AstarFringe * targetFringe)
+{
+	unsigned int i;
+	int cell;
+	Node * n;
+	switch (targetFringe->Type)
+	{
+		case FRINGE_LIST:
+			n = targetFringe->List->Head;
+			while (n != NULL)
+			{
+				printf("(%d %d) ", n->Data.x, n->Data.y);
+				n = n->Next;
+			}
+			break;
+		case FRINGE_HEAP:
+			for (i = 0; i < targetFringe->Heap->Count; i++)
+			{
+				printf("(%d %d) ", targetFringe->Heap->Nodes[i].Data.x, targetFringe->Heap->Nodes[i].Data.y);
+			}
+			break;
+		default:
+			for (i = targetFringe->Buckets->Min; i < targetFringe->Buckets->BucketCount; i++)
+			{
+				cell = targetFringe->Buckets->Buckets[i];
+				while (cell >= 0)
+				{
+					printf("(%d %d) ", cell % targetFringe->Buckets->Width, cell / targetFringe->Buckets->Width);
+					cell = targetFringe->Buckets->Next[cell];
+				}
+			}
+	}
+}
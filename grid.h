@@ -0,0 +1,262 @@
+/****************************************************************************
+'grid.h' - implements functions that perform operations or manipulations
+           on Grids, i.e., runtime-sized obstacle maps
+         - Programmer: Vincent Paul Fiestada
+*****************************************************************************/
+
+#pragma once
+#include "line.h"
+#include "components.h"
+#include <sys/mman.h> // munmap()
+
+#define GRID_DEFAULT_WIDTH 400 // Size of maps whose input file has no 'size' line
+#define GRID_DEFAULT_HEIGHT 200
+#define GRID_ALIGNMENT 64 // Cache line size; every array of the Grid starts on a cache line
+
+struct Hierarchy; // HPA* abstract graph; see hpa.h
+struct VisibilityGraph; // any-angle graph over the polygons' corners; see vis.h
+
+typedef struct
+{
+	unsigned int Width;
+	unsigned int Height;
+	uint8_t * Blocked; // Blocked[y * Width + x] = 1 if tile (x,y) is part of an obstacle, 0 if it is free
+	int32_t * Jumps; // JPS+ jump distances, 4 per tile (see jps.h); NULL until reserveJumpTable(..) is called
+	uint64_t * OpenBits; // the free tiles, a bit per tile and 64-bit words per row, that JPS scans (see jps.h); NULL
+	                     // until reserveOpenBits(..) is called
+	uint16_t * Landmarks; // ALT landmark distances, LandmarkCount per tile (see alt.h); NULL until
+	unsigned int LandmarkCount; // reserveLandmarks(..) or loadLandmarks(..) is called
+	struct Hierarchy * Hierarchy; // HPA* abstract graph, in one block; NULL until reserveHierarchy(..) is called
+	coordinate * Vertices; // the polygons the map was rasterized from, one after another; polygon p is
+	unsigned int * PolygonEnds; // Vertices[PolygonEnds[p - 1]] up to (not including) Vertices[PolygonEnds[p]]
+	unsigned int PolygonCount;
+	struct VisibilityGraph * Visibility; // visibility graph of the polygons, in one block; NULL until
+	                                     // reserveVisibility(..) is called
+	ComponentLabels * Components; // which connected region each free tile is in; NULL until LabelGridComponents(..)
+	                              // is called, and kept up to date by SetGridCell(..) after that
+	void * Image; // the compiled map file the Grid was mapped from (see mapfile.h), or NULL; the tables that
+	size_t ImageSize; // point into it are released with it rather than freed
+	uint64_t Changes; // number of tiles SetGridCell(..) has changed; copies of Blocked kept outside the Grid compare
+	                  // it to tell whether they are stale
+} Grid; // The obstacle map; read-only once it is rasterized (but see SetGridCell), so any number of searches can share it
+
+
+Grid * CreateNewGrid(unsigned int width, unsigned int height);
+void AnnihilateGrid(Grid * targetGrid);
+void * AllocateAligned(size_t size);
+uint64_t HashGrid(Grid * targetGrid);
+bool SetGridCell(Grid * targetGrid, unsigned int x, unsigned int y, uint8_t blocked);
+bool LabelGridComponents(Grid * targetGrid);
+bool GridConnected(Grid * targetGrid, coordinate a, coordinate b);
+void AddGridPolygon(Grid * targetGrid, coordinate * vertices, unsigned int n);
+bool GridImageHolds(Grid * targetGrid, const void * array);
+void ReleaseGridArray(Grid * targetGrid, void * array);
+void ReleaseGridComponents(Grid * targetGrid);
+unsigned int GridCapacity(unsigned int count);
+
+// <summary>
+// CreateNewGrid - allocates space for a new width x height Grid with no obstacles and returns a pointer to it
+//               - the obstacle mask is allocated once and cache-aligned; it costs 1 byte per tile
+//				 - The creator has the implicit responsibility of freeing up the Grid later
+//                 using the AnnihilateGrid(..) function
+// </summary>
+Grid * CreateNewGrid(unsigned int width, unsigned int height)
+{
+	size_t cells = (size_t)width * height;
+	Grid * g = malloc(sizeof(Grid));
+	g->Width = width;
+	g->Height = height;
+	g->Blocked = AllocateAligned(cells * sizeof(uint8_t));
+	g->Jumps = NULL;
+	g->OpenBits = NULL;
+	g->Landmarks = NULL;
+	g->LandmarkCount = 0;
+	g->Hierarchy = NULL;
+	g->Vertices = NULL;
+	g->PolygonEnds = NULL;
+	g->PolygonCount = 0;
+	g->Visibility = NULL;
+	g->Components = NULL;
+	g->Image = NULL;
+	g->ImageSize = 0;
+	g->Changes = 0;
+	if (g->Blocked == NULL)
+	{
+		AnnihilateGrid(g);
+		return NULL; // Not enough memory for a map this size
+	}
+	memset(g->Blocked, 0, cells);
+	return g;
+}
+
+// <summary>
+// AnnihilateGrid - frees up the obstacle mask, the free-tile bits, the jump and landmark tables, the abstract and
+//                  visibility graphs, the polygons, the component labels, and the Grid itself, and unmaps the file
+//                  it was mapped from
+// </summary>
+void AnnihilateGrid(Grid * targetGrid)
+{
+	free(targetGrid->Blocked);
+	free(targetGrid->Jumps);
+	free(targetGrid->OpenBits);
+	ReleaseGridArray(targetGrid, targetGrid->Landmarks);
+	free(targetGrid->Hierarchy);
+	free(targetGrid->Vertices);
+	free(targetGrid->PolygonEnds);
+	free(targetGrid->Visibility);
+	ReleaseGridComponents(targetGrid);
+	if (targetGrid->Image != NULL) munmap(targetGrid->Image, targetGrid->ImageSize);
+	free(targetGrid);
+	return;
+}
+
+// <summary>
+// AllocateAligned - allocates size bytes starting on a GRID_ALIGNMENT boundary; free with free()
+// </summary>
+void * AllocateAligned(size_t size)
+{
+	// aligned_alloc wants the size to be a multiple of the alignment
+	size = (size + GRID_ALIGNMENT - 1) & ~((size_t)GRID_ALIGNMENT - 1);
+	if (size == 0) size = GRID_ALIGNMENT;
+	return aligned_alloc(GRID_ALIGNMENT, size);
+}
+
+// <summary>
+// HashGrid - returns a 64-bit FNV-1a hash of the size and obstacles of the Grid, which tells whether a table
+//            saved for a map still belongs to it
+// </summary>
+uint64_t HashGrid(Grid * targetGrid)
+{
+	size_t cells = (size_t)targetGrid->Width * targetGrid->Height;
+	uint64_t hash = 14695981039346656037ULL; // FNV offset basis
+	size_t i;
+	hash = (hash ^ targetGrid->Width) * 1099511628211ULL; // FNV prime
+	hash = (hash ^ targetGrid->Height) * 1099511628211ULL;
+	for (i = 0; i < cells; i++)
+	{
+		hash = (hash ^ targetGrid->Blocked[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+// <summary>
+// SetGridCell - blocks (blocked = 1) or frees (blocked = 0) tile (x,y) of the Grid; returns false if it already was
+//             - the free-tile bits, the jump and landmark tables and the abstract graph are dropped when a tile
+//               changes, since they describe the old map; they are rebuilt by the next reserve..(..) call
+//             - the polygons, and so the visibility graph, stay as they were
+//             - Changes goes up by one, so that copies of the tiles kept elsewhere know to take them again
+//             - the component labels are updated in place, at a cost that depends on the regions the tile joins
+//               or splits rather than on the size of the map; they are dropped only if that runs out of memory
+//             - the Grid is no longer read-only while this is called; no search may be running on it
+// </summary>
+bool SetGridCell(Grid * targetGrid, unsigned int x, unsigned int y, uint8_t blocked)
+{
+	size_t cell = (size_t)y * targetGrid->Width + x;
+	if (targetGrid->Blocked[cell] == blocked) return false;
+	targetGrid->Blocked[cell] = blocked;
+	targetGrid->Changes++;
+	if (targetGrid->Components != NULL
+		&& !(blocked ? BlockComponentCell(targetGrid->Components, cell) : FreeComponentCell(targetGrid->Components, cell)))
+	{
+		ReleaseGridComponents(targetGrid); // Searches just go without them
+	}
+	free(targetGrid->Jumps);
+	free(targetGrid->OpenBits);
+	ReleaseGridArray(targetGrid, targetGrid->Landmarks);
+	free(targetGrid->Hierarchy);
+	targetGrid->Jumps = NULL;
+	targetGrid->OpenBits = NULL;
+	targetGrid->Landmarks = NULL;
+	targetGrid->LandmarkCount = 0;
+	targetGrid->Hierarchy = NULL;
+	return true;
+}
+
+// <summary>
+// LabelGridComponents - labels the connected regions of free tiles of the Grid, if they aren't labelled yet
+//                     - returns false if there isn't enough memory for the labels
+// </summary>
+bool LabelGridComponents(Grid * targetGrid)
+{
+	if (targetGrid->Components == NULL)
+	{
+		targetGrid->Components = CreateComponentLabels(targetGrid->Blocked, targetGrid->Width, targetGrid->Height);
+	}
+	return targetGrid->Components != NULL;
+}
+
+// <summary>
+// GridConnected - returns false if the component labels show that no path leads from tile a to tile b, in O(1)
+//               - a blocked b is never reached; a blocked a is left to the search, which still steps off it
+//               - without labels nothing is known, so it returns true
+// </summary>
+bool GridConnected(Grid * targetGrid, coordinate a, coordinate b)
+{
+	if (targetGrid->Components == NULL) return true;
+	uint32_t from = targetGrid->Components->Label[(size_t)a.y * targetGrid->Width + a.x];
+	return from == 0 || from == targetGrid->Components->Label[(size_t)b.y * targetGrid->Width + b.x];
+}
+
+// <summary>
+// AddGridPolygon - keeps a copy of a polygon's n vertices with the Grid, after the ones added before it
+//                - only records the polygon; rasterizing it into Blocked is up to the caller
+// </summary>
+void AddGridPolygon(Grid * targetGrid, coordinate * vertices, unsigned int n)
+{
+	unsigned int p = targetGrid->PolygonCount;
+	unsigned int first = (p > 0) ? targetGrid->PolygonEnds[p - 1] : 0;
+	// Both arrays double when they fill up, so loading a map copies every vertex O(1) times on average
+	if (GridCapacity(p + 1) != GridCapacity(p))
+	{
+		targetGrid->PolygonEnds = realloc(targetGrid->PolygonEnds, GridCapacity(p + 1) * sizeof(unsigned int));
+	}
+	if (GridCapacity(first + n) != GridCapacity(first))
+	{
+		targetGrid->Vertices = realloc(targetGrid->Vertices, GridCapacity(first + n) * sizeof(coordinate));
+	}
+	if (n > 0) memcpy(targetGrid->Vertices + first, vertices, n * sizeof(coordinate));
+	targetGrid->PolygonEnds[p] = first + n;
+	targetGrid->PolygonCount++;
+}
+
+// <summary>
+// GridCapacity - number of slots allocated for an array of the Grid that holds count elements: the smallest
+//                power of two that fits them, and 0 for none
+// </summary>
+unsigned int GridCapacity(unsigned int count)
+{
+	unsigned int capacity = 1;
+	if (count == 0) return 0;
+	while (capacity < count) capacity *= 2;
+	return capacity;
+}
+
+// <summary>
+// GridImageHolds - true if array lies in the compiled map file the Grid was mapped from
+// </summary>
+bool GridImageHolds(Grid * targetGrid, const void * array)
+{
+	const char * image = targetGrid->Image;
+	return image != NULL && (const char *)array >= image && (const char *)array < image + targetGrid->ImageSize;
+}
+
+// <summary>
+// ReleaseGridArray - frees one of the Grid's tables, unless it lies in the file the Grid was mapped from
+// </summary>
+void ReleaseGridArray(Grid * targetGrid, void * array)
+{
+	if (!GridImageHolds(targetGrid, array)) free(array);
+}
+
+// <summary>
+// ReleaseGridComponents - drops the component labels of the Grid, if it has any; labels mapped from a compiled map
+//                         file only lose their header, the arrays go with the file
+// </summary>
+void ReleaseGridComponents(Grid * targetGrid)
+{
+	ComponentLabels * labels = targetGrid->Components;
+	targetGrid->Components = NULL;
+	if (labels == NULL) return;
+	if (GridImageHolds(targetGrid, labels->Label)) free(labels);
+	else AnnihilateComponentLabels(labels);
+}
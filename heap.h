@@ -0,0 +1,242 @@
+/****************************************************************************
+'heap.h' - implements functions that perform operations or manipulations
+           on Indexed d-ary Min-Heaps (priority queues with decrease-key)
+         - Programmer: Vincent Paul Fiestada
+*****************************************************************************/
+
+#pragma once
+#include "line.h"
+#include "arena.h"
+
+// Number of children per heap node; 2 gives a plain binary heap
+#ifndef HEAP_ARITY
+#define HEAP_ARITY 4
+#endif
+
+typedef struct
+{
+	int f; // evaluated node cost
+	int g; // level of this node in the search tree
+	unsigned int Order; // insertion stamp; among equal f, the newest node comes out first
+	coordinate Data;
+} HeapNode;
+
+typedef struct
+{
+	HeapNode * Nodes; // the heap itself, Nodes[0] is the minimum
+	int * Position; // Position[y * Width + x] = index of that cell in Nodes, or -1 if not in the heap
+	unsigned int Count; // number of nodes in the heap
+	unsigned int Capacity; // number of slots allocated for Nodes
+	unsigned int Width;
+	unsigned int Height;
+	unsigned int Stamp; // last Order handed out
+	Arena * Pool; // where the Heap's arrays come from; NULL means malloc
+} Heap;
+
+
+Heap * CreateNewHeap(unsigned int width, unsigned int height);
+Heap * CreateNewHeapInArena(Arena * pool, unsigned int width, unsigned int height);
+void AnnihilateHeap(Heap * targetHeap);
+void ClearHeap(Heap * targetHeap);
+HeapNode * InsertToHeap(Heap * targetHeap, unsigned int x, unsigned int y, int f, int g);
+coordinate PopFromHeap(Heap * targetHeap);
+bool HeapNodeBefore(HeapNode * a, HeapNode * b);
+void HeapSwap(Heap * targetHeap, unsigned int i, unsigned int j);
+void HeapSiftUp(Heap * targetHeap, unsigned int i);
+void HeapSiftDown(Heap * targetHeap, unsigned int i);
+void HeapUnderflow();
+
+// <summary>
+// CreateNewHeap - allocates space for a new empty Heap over a width x height grid and returns a pointer to it
+//               - every cell of the grid can be in the heap at most once; inserting a cell that is
+//                 already in the heap updates it in place (decrease-key)
+//               - The creator has the implicit responsibility of freeing up memory later
+// </summary>
+Heap * CreateNewHeap(unsigned int width, unsigned int height)
+{
+	return CreateNewHeapInArena(NULL, width, height);
+}
+
+// <summary>
+// CreateNewHeapInArena - same as CreateNewHeap, but all memory is drawn from the given Arena
+// </summary>
+Heap * CreateNewHeapInArena(Arena * pool, unsigned int width, unsigned int height)
+{
+	Heap * n = ArenaAlloc(pool, sizeof(Heap));
+	unsigned int i;
+	n->Pool = pool;
+	n->Width = width;
+	n->Height = height;
+	n->Count = 0;
+	n->Stamp = 0;
+	n->Capacity = 256; // grows on demand; most searches never touch every cell
+	n->Nodes = ArenaAlloc(pool, n->Capacity * sizeof(HeapNode));
+	n->Position = ArenaAlloc(pool, (size_t)width * height * sizeof(int));
+	for (i = 0; i < width * height; i++)
+	{
+		n->Position[i] = -1; // Initialize as empty
+	}
+	return n;
+}
+
+// <summary>
+// AnnihilateHeap - frees up the memory allocated for the Heap and all of its nodes
+// </summary>
+void AnnihilateHeap(Heap * targetHeap)
+{
+	ArenaFree(targetHeap->Pool, targetHeap->Nodes);
+	ArenaFree(targetHeap->Pool, targetHeap->Position);
+	ArenaFree(targetHeap->Pool, targetHeap);
+	return;
+}
+
+// <summary>
+// ClearHeap - removes every node from the Heap in O(Count), leaving it empty but still usable
+//           - only the cells still in the Heap are touched, so reusing a Heap is cheaper than creating one
+// </summary>
+void ClearHeap(Heap * targetHeap)
+{
+	unsigned int i;
+	for (i = 0; i < targetHeap->Count; i++)
+	{
+		targetHeap->Position[targetHeap->Nodes[i].Data.y * targetHeap->Width + targetHeap->Nodes[i].Data.x] = -1;
+	}
+	targetHeap->Count = 0;
+	targetHeap->Stamp = 0;
+	return;
+}
+
+// <summary>
+// InsertToHeap - inserts a cell into the Heap in O(log n)
+//              - if the cell is already in the Heap, its entry is replaced only when the new one would
+//                come out first (smaller f, or equal f since it is newer); otherwise nothing changes
+//              - returns a pointer to the cell's node (valid until the next Insert or Pop)
+// </summary>
+HeapNode * InsertToHeap(Heap * targetHeap, unsigned int x, unsigned int y, int f, int g)
+{
+	unsigned int cell = y * targetHeap->Width + x;
+	int slot = targetHeap->Position[cell];
+	if (slot >= 0)
+	{
+		// Decrease-key: keep a single entry per cell
+		HeapNode * node = &(targetHeap->Nodes[slot]);
+		if (f > node->f)
+		{
+			return node; // the stored entry is still better
+		}
+		node->f = f;
+		node->g = g;
+		node->Order = ++targetHeap->Stamp;
+		HeapSiftUp(targetHeap, slot);
+		return &(targetHeap->Nodes[targetHeap->Position[cell]]);
+	}
+	if (targetHeap->Count == targetHeap->Capacity) // Out of slots; double the capacity
+	{
+		targetHeap->Nodes = ArenaGrow(targetHeap->Pool, targetHeap->Nodes, targetHeap->Capacity * sizeof(HeapNode), 2 * targetHeap->Capacity * sizeof(HeapNode));
+		targetHeap->Capacity *= 2;
+	}
+	slot = targetHeap->Count++;
+	HeapNode * newNode = &(targetHeap->Nodes[slot]);
+	newNode->Data.x = x;
+	newNode->Data.y = y;
+	newNode->f = f;
+	newNode->g = g;
+	newNode->Order = ++targetHeap->Stamp;
+	targetHeap->Position[cell] = slot;
+	HeapSiftUp(targetHeap, slot);
+	return &(targetHeap->Nodes[targetHeap->Position[cell]]);
+}
+
+// <summary>
+// PopFromHeap - removes the node with the smallest f and returns its contents
+// </summary>
+coordinate PopFromHeap(Heap * targetHeap)
+{
+	coordinate data;
+	if (targetHeap->Count == 0)
+	{
+		HeapUnderflow(); // Heap is empty; Call UNDERFLOW
+		data.x = -1;
+		data.y = -1;
+		return data;
+	}
+	data = targetHeap->Nodes[0].Data; // Salvage Data
+	targetHeap->Position[data.y * targetHeap->Width + data.x] = -1;
+	targetHeap->Count--;
+	if (targetHeap->Count > 0)
+	{
+		// Move the last node to the root and let it sink to where it belongs
+		targetHeap->Nodes[0] = targetHeap->Nodes[targetHeap->Count];
+		coordinate moved = targetHeap->Nodes[0].Data;
+		targetHeap->Position[moved.y * targetHeap->Width + moved.x] = 0;
+		HeapSiftDown(targetHeap, 0);
+	}
+	return data; // Return the 'salvaged Data'
+}
+
+// <summary>
+// HeapNodeBefore - true if node a should come out of the Heap before node b
+//                - ties in f go to the most recently inserted node, which is the order SortedList uses
+// </summary>
+bool HeapNodeBefore(HeapNode * a, HeapNode * b)
+{
+	if (a->f != b->f) return a->f < b->f;
+	return a->Order > b->Order;
+}
+
+// <summary>
+// HeapSwap - swaps two slots of the Heap and keeps the Position index in sync
+// </summary>
+void HeapSwap(Heap * targetHeap, unsigned int i, unsigned int j)
+{
+	HeapNode temp = targetHeap->Nodes[i];
+	targetHeap->Nodes[i] = targetHeap->Nodes[j];
+	targetHeap->Nodes[j] = temp;
+	targetHeap->Position[targetHeap->Nodes[i].Data.y * targetHeap->Width + targetHeap->Nodes[i].Data.x] = i;
+	targetHeap->Position[targetHeap->Nodes[j].Data.y * targetHeap->Width + targetHeap->Nodes[j].Data.x] = j;
+}
+
+// <summary>
+// HeapSiftUp - moves the node at slot i towards the root until its parent comes out before it
+// </summary>
+void HeapSiftUp(Heap * targetHeap, unsigned int i)
+{
+	while (i > 0)
+	{
+		unsigned int parent = (i - 1) / HEAP_ARITY;
+		if (!HeapNodeBefore(&(targetHeap->Nodes[i]), &(targetHeap->Nodes[parent]))) break;
+		HeapSwap(targetHeap, i, parent);
+		i = parent;
+	}
+}
+
+// <summary>
+// HeapSiftDown - moves the node at slot i away from the root until none of its children come out before it
+// </summary>
+void HeapSiftDown(Heap * targetHeap, unsigned int i)
+{
+	while (1)
+	{
+		unsigned int first = i * HEAP_ARITY + 1;
+		unsigned int best = i;
+		unsigned int c;
+		for (c = first; c < first + HEAP_ARITY && c < targetHeap->Count; c++)
+		{
+			if (HeapNodeBefore(&(targetHeap->Nodes[c]), &(targetHeap->Nodes[best]))) best = c;
+		}
+		if (best == i) break;
+		HeapSwap(targetHeap, i, best);
+		i = best;
+	}
+}
+
+// <summary>
+// HeapUnderflow - do stuff if another function determines that the Heap is empty and a manipulation
+//				   needs to be cancelled
+// </summary>
+void HeapUnderflow()
+{
+	// Print error; DO NOT EXIT
+	printf("\n\nERR: Heap Underflow\nCannot Pop From Empty Heap\n\n");
+	return;
+}
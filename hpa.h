@@ -0,0 +1,462 @@
+#pragma once
+#include "line.h"
+#include "grid.h"
+#include "arena.h"
+#include "stack.h"
+#include "fringe.h"
+#include <limits.h> // INT_MAX
+
+/*  HIERARCHICAL PATH-FINDING A* (HPA*)
+ *  The map is cut into square clusters. Wherever open tiles face each other across the border of two
+ *  clusters there is an entrance; a narrow entrance gets one transition (a pair of facing tiles) in its
+ *  middle, a wide one a transition at each end. The transition tiles are the nodes of an abstract graph:
+ *  facing tiles are 1 apart, and the nodes of one cluster are joined by their shortest distance inside it.
+ *  A query links the start and goal to the nodes of their clusters, runs A* on the abstract graph, and only
+ *  then turns the edges it took into tiles, one BFS inside one cluster per edge. Paths must pass through
+ *  transitions, so they can come out a little longer than the shortest one.
+ */
+
+#ifndef HPA_CLUSTER_SIZE
+#define HPA_CLUSTER_SIZE 16 // side of a cluster, in tiles
+#endif
+#define HPA_WIDE_ENTRANCE 6 // entrances at least this long get a transition at each end instead of the middle
+
+struct Hierarchy
+{
+    unsigned int ClusterSize;
+    unsigned int ClustersX; // number of clusters across
+    unsigned int ClustersY; // number of clusters down
+    unsigned int NodeCount;
+    unsigned int EdgeCount;
+    int32_t * NodeCell; // NodeCell[node] = y * Width + x of its tile; nodes are numbered cluster by cluster
+    int32_t * ClusterFirst; // nodes of cluster c are ClusterFirst[c] .. ClusterFirst[c + 1] - 1
+    int32_t * EdgeFirst; // edges of node n are EdgeFirst[n] .. EdgeFirst[n + 1] - 1
+    int32_t * EdgeTo; // node at the other end of each edge
+    int32_t * EdgeCost; // length of each edge, in steps
+}; // The abstract graph; one block of memory, so free() on it frees everything
+typedef struct Hierarchy Hierarchy;
+
+bool reserveHierarchy(Grid * grid, unsigned int clusterSize);
+void markTransitions(Grid * grid, unsigned int C, int32_t * nodeOf);
+void markTransition(int32_t * nodeOf, size_t a, size_t b);
+unsigned int clusterOf(Grid * grid, unsigned int C, size_t cell);
+void clusterBounds(Grid * grid, unsigned int C, unsigned int cluster, unsigned int * x0, unsigned int * y0, unsigned int * x1, unsigned int * y1);
+size_t clusterIndex(Grid * grid, unsigned int C, size_t cell);
+int clusterBFS(Grid * grid, unsigned int C, size_t root, int32_t * dist, uint8_t * pred, int32_t * queue);
+void traceCluster(Grid * grid, unsigned int C, size_t root, size_t from, uint8_t * pred, Stack * path);
+int abstractH(Grid * grid, size_t cell, coordinate goal);
+bool hierarchicalSearch(Grid * grid, Arena * pool, int fringeType, coordinate start, coordinate goal, Stack * path, int * expanded,
+    unsigned int * peakFringe);
+void relaxAbstract(AstarFringe * fringe, int * g, int * parent, uint8_t * closed, int u, int v, int ng, int hv);
+
+/*
+ * reserveHierarchy() - builds the HPA* abstract graph of the grid with clusters of clusterSize x clusterSize tiles
+ *                      if it isn't there yet; returns false if there isn't enough memory
+ *                    - one BFS inside its cluster per node, so O(nodes * clusterSize^2)
+ */
+bool reserveHierarchy(Grid * grid, unsigned int clusterSize)
+{
+    size_t cells = (size_t)grid->Width * grid->Height;
+    unsigned int C = clusterSize;
+    unsigned int clustersX = (grid->Width + C - 1) / C;
+    unsigned int clustersY = (grid->Height + C - 1) / C;
+    unsigned int clusters = clustersX * clustersY;
+    unsigned int nodes = 0, c, x, y, x0, y0, x1, y1;
+    size_t bound = 0, edges = 0, cell;
+    int n, j, d;
+    if (grid->Hierarchy != NULL) return true;
+    int32_t * nodeOf = malloc(cells * sizeof(int32_t)); // node number of every tile, -1 if it isn't a node
+    int32_t * clusterFirst = malloc((clusters + 1) * sizeof(int32_t));
+    int32_t * dist = malloc((size_t)C * C * sizeof(int32_t));
+    int32_t * queue = malloc((size_t)C * C * sizeof(int32_t));
+    uint8_t * pred = malloc((size_t)C * C);
+    Hierarchy * hpa = NULL;
+    if (nodeOf != NULL && clusterFirst != NULL && dist != NULL && queue != NULL && pred != NULL)
+    {
+        for (cell = 0; cell < cells; cell++)
+        {
+            nodeOf[cell] = -1;
+        }
+        markTransitions(grid, C, nodeOf);
+        // Count the nodes of each cluster; a node has at most 4 edges out of its cluster and one to every other
+        // node in it, which bounds the number of edges
+        for (c = 0; c < clusters; c++)
+        {
+            clusterFirst[c] = nodes;
+            clusterBounds(grid, C, c, &x0, &y0, &x1, &y1);
+            for (y = y0; y < y1; y++)
+            {
+                for (x = x0; x < x1; x++)
+                {
+                    if (nodeOf[(size_t)y * grid->Width + x] >= 0) nodes++;
+                }
+            }
+            bound += (size_t)(nodes - clusterFirst[c]) * (4 + nodes - clusterFirst[c]);
+        }
+        clusterFirst[clusters] = nodes;
+        size_t words = nodes + (clusters + 1) + (nodes + 1) + 2 * bound;
+        hpa = AllocateAligned(sizeof(Hierarchy) + words * sizeof(int32_t));
+    }
+    if (hpa != NULL)
+    {
+        hpa->ClusterSize = C;
+        hpa->ClustersX = clustersX;
+        hpa->ClustersY = clustersY;
+        hpa->NodeCount = nodes;
+        hpa->NodeCell = (int32_t *)(hpa + 1);
+        hpa->ClusterFirst = hpa->NodeCell + nodes;
+        hpa->EdgeFirst = hpa->ClusterFirst + clusters + 1;
+        hpa->EdgeTo = hpa->EdgeFirst + nodes + 1;
+        hpa->EdgeCost = hpa->EdgeTo + bound;
+        memcpy(hpa->ClusterFirst, clusterFirst, (clusters + 1) * sizeof(int32_t));
+        // Number the nodes cluster by cluster, so that each cluster's nodes are contiguous
+        nodes = 0;
+        for (c = 0; c < clusters; c++)
+        {
+            clusterBounds(grid, C, c, &x0, &y0, &x1, &y1);
+            for (y = y0; y < y1; y++)
+            {
+                for (x = x0; x < x1; x++)
+                {
+                    cell = (size_t)y * grid->Width + x;
+                    if (nodeOf[cell] < 0) continue;
+                    nodeOf[cell] = nodes;
+                    hpa->NodeCell[nodes++] = cell;
+                }
+            }
+        }
+        // Edges: to facing nodes in the neighbouring clusters, and to every node reachable inside the same cluster
+        for (n = 0; n < (int)nodes; n++)
+        {
+            cell = hpa->NodeCell[n];
+            c = clusterOf(grid, C, cell);
+            hpa->EdgeFirst[n] = edges;
+            x = cell % grid->Width;
+            y = cell / grid->Width;
+            size_t around[4];
+            int count = 0;
+            if (x + 1 < grid->Width) around[count++] = cell + 1;
+            if (x > 0) around[count++] = cell - 1;
+            if (y > 0) around[count++] = cell - grid->Width;
+            if (y + 1 < grid->Height) around[count++] = cell + grid->Width;
+            for (d = 0; d < count; d++)
+            {
+                if (nodeOf[around[d]] < 0 || clusterOf(grid, C, around[d]) == c) continue;
+                hpa->EdgeTo[edges] = nodeOf[around[d]];
+                hpa->EdgeCost[edges++] = 1;
+            }
+            clusterBFS(grid, C, cell, dist, pred, queue);
+            for (j = clusterFirst[c]; j < clusterFirst[c + 1]; j++)
+            {
+                int32_t steps = dist[clusterIndex(grid, C, hpa->NodeCell[j])];
+                if (j == n || steps < 0) continue;
+                hpa->EdgeTo[edges] = j;
+                hpa->EdgeCost[edges++] = steps;
+            }
+        }
+        hpa->EdgeFirst[nodes] = edges;
+        hpa->EdgeCount = edges;
+    }
+    free(nodeOf);
+    free(clusterFirst);
+    free(dist);
+    free(queue);
+    free(pred);
+    grid->Hierarchy = hpa;
+    return hpa != NULL;
+}
+
+/*
+ * markTransitions() - marks the tiles of every transition between clusters of C x C tiles with 0 in nodeOf
+ *                   - an entrance is a run of facing open tiles along one side of one cluster
+ */
+void markTransitions(Grid * grid, unsigned int C, int32_t * nodeOf)
+{
+    unsigned int W = grid->Width;
+    unsigned int H = grid->Height;
+    unsigned int border, from, i, run;
+    // Vertical borders: tile (border - 1, y) faces (border, y)
+    for (border = C; border < W; border += C)
+    {
+        for (from = 0; from < H; from += C)
+        {
+            unsigned int to = (from + C < H) ? from + C : H;
+            for (i = from, run = 0; i <= to; i++)
+            {
+                size_t left = (size_t)i * W + border - 1;
+                if (i < to && !grid->Blocked[left] && !grid->Blocked[left + 1])
+                {
+                    run++;
+                    continue;
+                }
+                if (run == 0) continue;
+                if (run < HPA_WIDE_ENTRANCE) // One transition in the middle
+                {
+                    size_t middle = (size_t)(i - run + (run - 1) / 2) * W + border - 1;
+                    markTransition(nodeOf, middle, middle + 1);
+                }
+                else // One at each end
+                {
+                    markTransition(nodeOf, (size_t)(i - run) * W + border - 1, (size_t)(i - run) * W + border);
+                    markTransition(nodeOf, (size_t)(i - 1) * W + border - 1, (size_t)(i - 1) * W + border);
+                }
+                run = 0;
+            }
+        }
+    }
+    // Horizontal borders: tile (x, border - 1) faces (x, border)
+    for (border = C; border < H; border += C)
+    {
+        for (from = 0; from < W; from += C)
+        {
+            unsigned int to = (from + C < W) ? from + C : W;
+            for (i = from, run = 0; i <= to; i++)
+            {
+                size_t above = (size_t)(border - 1) * W + i;
+                if (i < to && !grid->Blocked[above] && !grid->Blocked[above + W])
+                {
+                    run++;
+                    continue;
+                }
+                if (run == 0) continue;
+                if (run < HPA_WIDE_ENTRANCE)
+                {
+                    size_t middle = (size_t)(border - 1) * W + i - run + (run - 1) / 2;
+                    markTransition(nodeOf, middle, middle + W);
+                }
+                else
+                {
+                    markTransition(nodeOf, (size_t)(border - 1) * W + i - run, (size_t)border * W + i - run);
+                    markTransition(nodeOf, (size_t)(border - 1) * W + i - 1, (size_t)border * W + i - 1);
+                }
+                run = 0;
+            }
+        }
+    }
+}
+
+/*
+ * markTransition() - makes both tiles a and b of a transition nodes
+ */
+void markTransition(int32_t * nodeOf, size_t a, size_t b)
+{
+    nodeOf[a] = 0;
+    nodeOf[b] = 0;
+}
+
+/*
+ * clusterOf() - number of the cluster of C x C tiles a tile belongs to, row by row
+ */
+unsigned int clusterOf(Grid * grid, unsigned int C, size_t cell)
+{
+    unsigned int clustersX = (grid->Width + C - 1) / C;
+    return (cell / grid->Width / C) * clustersX + (cell % grid->Width) / C;
+}
+
+/*
+ * clusterBounds() - the tiles [x0, x1) x [y0, y1) of a cluster; the last row and column of clusters may be cut short
+ */
+void clusterBounds(Grid * grid, unsigned int C, unsigned int cluster, unsigned int * x0, unsigned int * y0, unsigned int * x1, unsigned int * y1)
+{
+    unsigned int clustersX = (grid->Width + C - 1) / C;
+    *x0 = (cluster % clustersX) * C;
+    *y0 = (cluster / clustersX) * C;
+    *x1 = (*x0 + C < grid->Width) ? *x0 + C : grid->Width;
+    *y1 = (*y0 + C < grid->Height) ? *y0 + C : grid->Height;
+}
+
+/*
+ * clusterIndex() - position of a tile within its cluster, as used by clusterBFS()
+ */
+size_t clusterIndex(Grid * grid, unsigned int C, size_t cell)
+{
+    return (cell / grid->Width % C) * C + cell % grid->Width % C;
+}
+
+/*
+ * clusterBFS() - BFS from root that never leaves root's cluster; writes the distance of every tile of the cluster
+ *                (-1 if unreachable) into dist and the direction back to its predecessor into pred, both indexed
+ *                by clusterIndex(); returns the number of expanded tiles
+ *              - dist, pred and queue need room for C^2 tiles
+ */
+int clusterBFS(Grid * grid, unsigned int C, size_t root, int32_t * dist, uint8_t * pred, int32_t * queue)
+{
+    // Same relative order as BFS: Right, Left, Up, Down; step d ^ 1 undoes step d
+    static const int dx[4] = {1, -1, 0, 0};
+    static const int dy[4] = {0, 0, -1, 1};
+    unsigned int x0, y0, x1, y1, i;
+    int head = 0, tail = 0, d;
+    clusterBounds(grid, C, clusterOf(grid, C, root), &x0, &y0, &x1, &y1);
+    for (i = 0; i < C * C; i++)
+    {
+        dist[i] = -1;
+    }
+    dist[clusterIndex(grid, C, root)] = 0;
+    queue[tail++] = root;
+    while (head < tail)
+    {
+        size_t u = queue[head++];
+        int ux = u % grid->Width;
+        int uy = u / grid->Width;
+        int32_t next = dist[clusterIndex(grid, C, u)] + 1;
+        for (d = 0; d < 4; d++)
+        {
+            int x = ux + dx[d];
+            int y = uy + dy[d];
+            if (x < (int)x0 || y < (int)y0 || x >= (int)x1 || y >= (int)y1) continue;
+            size_t v = (size_t)y * grid->Width + x;
+            size_t local = clusterIndex(grid, C, v);
+            if (grid->Blocked[v] || dist[local] >= 0) continue;
+            dist[local] = next;
+            pred[local] = d ^ 1;
+            queue[tail++] = v;
+        }
+    }
+    return head;
+}
+
+/*
+ * traceCluster() - pushes the tiles after from on the way back to root into path, root last, following the pred
+ *                  left by clusterBFS() from root
+ */
+void traceCluster(Grid * grid, unsigned int C, size_t root, size_t from, uint8_t * pred, Stack * path)
+{
+    static const int dx[4] = {1, -1, 0, 0};
+    static const int dy[4] = {0, 0, -1, 1};
+    size_t cell = from;
+    while (cell != root)
+    {
+        int d = pred[clusterIndex(grid, C, cell)];
+        cell = (size_t)((int)(cell / grid->Width) + dy[d]) * grid->Width + (cell % grid->Width) + dx[d];
+        PushToStack(path, cell % grid->Width, cell / grid->Width);
+    }
+}
+
+/*
+ * hierarchicalSearch() - "HPA*": answers a query with the grid's abstract graph (see reserveHierarchy()) and pushes
+ *                        the path into path, goal first and start on top; returns false if there is no path
+ *                      - the start and goal are linked to the nodes of their clusters by a BFS in each; if they
+ *                        share a cluster and meet inside it, that path is taken without an abstract search
+ *                      - a start inside an obstacle can only be left into its own cluster, unlike with the other
+ *                        strategies, since obstacle tiles are never transitions
+ *                      - scratch memory comes from pool, and the abstract A* uses a fringe of the given type
+ *                      - expanded nodes, abstract and concrete, are added to expanded; peakFringe is raised to the
+ *                        most nodes the abstract fringe held at once if that's more
+ */
+bool hierarchicalSearch(Grid * grid, Arena * pool, int fringeType, coordinate start, coordinate goal, Stack * path, int * expanded,
+    unsigned int * peakFringe)
+{
+    Hierarchy * hpa = grid->Hierarchy;
+    unsigned int C = hpa->ClusterSize;
+    size_t s = (size_t)start.y * grid->Width + start.x;
+    size_t t = (size_t)goal.y * grid->Width + goal.x;
+    int N = hpa->NodeCount;
+    int S = N; // the start and the goal join the abstract graph as two extra nodes
+    int T = N + 1;
+    int32_t * queue = ArenaAlloc(pool, (size_t)C * C * sizeof(int32_t));
+    int32_t * fromStart = ArenaAlloc(pool, (size_t)C * C * sizeof(int32_t));
+    int32_t * toGoal = ArenaAlloc(pool, (size_t)C * C * sizeof(int32_t));
+    uint8_t * pred = ArenaAlloc(pool, (size_t)C * C);
+    unsigned int cs = clusterOf(grid, C, s);
+    unsigned int cg = clusterOf(grid, C, t);
+    int i, j, e, gu;
+    if (grid->Blocked[t]) return false; // Like the other strategies, never reach a goal inside an obstacle
+    *expanded += clusterBFS(grid, C, s, fromStart, pred, queue);
+    if (cs == cg && fromStart[clusterIndex(grid, C, t)] >= 0) // Close enough for a local path
+    {
+        PushToStack(path, goal.x, goal.y);
+        traceCluster(grid, C, s, t, pred, path);
+        return true;
+    }
+    *expanded += clusterBFS(grid, C, t, toGoal, pred, queue);
+
+    // A* on the abstract graph
+    int * g = ArenaAlloc(pool, (N + 2) * sizeof(int));
+    int * parent = ArenaAlloc(pool, (N + 2) * sizeof(int));
+    uint8_t * closed = ArenaAlloc(pool, N + 2);
+    for (i = 0; i < N + 2; i++)
+    {
+        g[i] = INT_MAX;
+        closed[i] = 0;
+    }
+    AstarFringe * fringe = CreateNewAstarFringeInArena(pool, fringeType, N + 2, 1); // x is the node number
+    g[S] = 0;
+    InsertToAstarFringe(fringe, S, 0, abstractH(grid, s, goal), 0);
+    bool found = false;
+    while (!IsAstarFringeEmpty(fringe))
+    {
+        int u = PopFromAstarFringe(fringe, &gu).x;
+        if (closed[u] || gu > g[u]) continue; // The sorted list keeps stale duplicates around; skip them
+        closed[u] = 1;
+        (*expanded)++;
+        if (u == T)
+        {
+            found = true;
+            break;
+        }
+        if (u == S) // The start leads to every node of its cluster it can reach
+        {
+            for (j = hpa->ClusterFirst[cs]; j < hpa->ClusterFirst[cs + 1]; j++)
+            {
+                int32_t steps = fromStart[clusterIndex(grid, C, hpa->NodeCell[j])];
+                if (steps < 0) continue;
+                relaxAbstract(fringe, g, parent, closed, u, j, gu + steps, abstractH(grid, hpa->NodeCell[j], goal));
+            }
+            continue;
+        }
+        for (e = hpa->EdgeFirst[u]; e < hpa->EdgeFirst[u + 1]; e++)
+        {
+            int v = hpa->EdgeTo[e];
+            relaxAbstract(fringe, g, parent, closed, u, v, gu + hpa->EdgeCost[e], abstractH(grid, hpa->NodeCell[v], goal));
+        }
+        if (clusterOf(grid, C, hpa->NodeCell[u]) == cg && toGoal[clusterIndex(grid, C, hpa->NodeCell[u])] >= 0) // ... and so does the goal
+        {
+            relaxAbstract(fringe, g, parent, closed, u, T, gu + toGoal[clusterIndex(grid, C, hpa->NodeCell[u])], 0);
+        }
+    }
+    if (fringe->Peak > *peakFringe) *peakFringe = fringe->Peak;
+    if (!found) return false; // No solution path
+
+    // Refine the abstract path into tiles, walking back from the goal; only the edges taken are ever refined
+    PROFILE_START(refined);
+    PushToStack(path, goal.x, goal.y);
+    int child = T;
+    size_t childCell = t;
+    while (child != S)
+    {
+        int p = parent[child];
+        size_t parentCell = (p == S) ? s : (size_t)hpa->NodeCell[p];
+        if (clusterOf(grid, C, parentCell) == clusterOf(grid, C, childCell)) // Edge inside a cluster: retrace it
+        {
+            *expanded += clusterBFS(grid, C, parentCell, toGoal, pred, queue);
+            traceCluster(grid, C, parentCell, childCell, pred, path);
+        }
+        else // Edge between facing tiles of two clusters
+        {
+            PushToStack(path, parentCell % grid->Width, parentCell / grid->Width);
+        }
+        child = p;
+        childCell = parentCell;
+    }
+    PROFILE_STOP(refined, PROFILE_PATH);
+    return true;
+}
+
+/*
+ * relaxAbstract() - queues abstract node v, reached from u with cost ng, if that is cheaper than before; hv is h(v)
+ */
+void relaxAbstract(AstarFringe * fringe, int * g, int * parent, uint8_t * closed, int u, int v, int ng, int hv)
+{
+    if (closed[v] || ng >= g[v]) return;
+    g[v] = ng;
+    parent[v] = u;
+    InsertToAstarFringe(fringe, v, 0, ng + hv, ng);
+}
+
+/*
+ * abstractH() - h(n) of the abstract search: the Manhattan distance from a tile to the goal
+ */
+int abstractH(Grid * grid, size_t cell, coordinate goal)
+{
+    return abs((int)(cell % grid->Width) - goal.x) + abs((int)(cell / grid->Width) - goal.y);
+}
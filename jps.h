@@ -0,0 +1,262 @@
+#pragma once
+#include "line.h"
+#include "grid.h"
+
+/*  JUMP POINT SEARCH ON A 4-CONNECTED GRID
+ *  Among the shortest paths between two tiles, only the 'vertical-first' ones are searched: a path may turn
+ *  from vertical to horizontal anywhere, but from horizontal to vertical only at a tile whose vertical
+ *  neighbour couldn't have been reached by turning one tile earlier, i.e., where the tile diagonally behind
+ *  is blocked. Such tiles are forced; a horizontal run stops at them, and a vertical run stops wherever a
+ *  horizontal run from it would stop. Every other tile on a run is skipped without being queued.
+ *  A vertical run looks both ways along every row it crosses, so the runs scan the map's free-tile bits
+ *  (reserveOpenBits()) 64 tiles at a time rather than tile by tile; JPS+ (reserveJumpTable()) looks them up instead.
+ */
+
+// Jump directions, in the same order as the PRED_* directions
+#define JUMP_RIGHT 0 // (+1, 0)
+#define JUMP_LEFT 1 // (-1, 0)
+#define JUMP_UP 2 // (0, -1)
+#define JUMP_DOWN 3 // (0, +1)
+
+bool isOpen(Grid * grid, int x, int y);
+bool isForcedHorizontal(Grid * grid, int x, int y, int dx);
+unsigned int openBitWords(Grid * grid);
+uint64_t openBits(Grid * grid, int y, int w);
+uint64_t forcedBits(Grid * grid, int y, int w, int dx);
+int jumpHorizontal(Grid * grid, int x, int y, int dx, coordinate goal);
+int jumpVertical(Grid * grid, int x, int y, int dy, coordinate goal);
+int jumpPrecomputed(Grid * grid, int x, int y, int direction, coordinate goal);
+bool reserveJumpTable(Grid * grid);
+bool reserveOpenBits(Grid * grid);
+
+/*
+ * isOpen() - true if (x,y) is inside the grid and not blocked
+ */
+bool isOpen(Grid * grid, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < (int)grid->Width && y < (int)grid->Height && !grid->Blocked[(size_t)y * grid->Width + x];
+}
+
+/*
+ * isForcedHorizontal() - true if a horizontal run moving by dx has to stop at (x,y), because it is the only
+ *                        way into one of its vertical neighbours along a vertical-first shortest path
+ */
+bool isForcedHorizontal(Grid * grid, int x, int y, int dx)
+{
+    return (isOpen(grid, x, y - 1) && !isOpen(grid, x - dx, y - 1))
+        || (isOpen(grid, x, y + 1) && !isOpen(grid, x - dx, y + 1));
+}
+
+/*
+ * openBitWords() - number of 64-bit words per row of the grid's free-tile bits
+ */
+unsigned int openBitWords(Grid * grid)
+{
+    return (grid->Width + 63) / 64;
+}
+
+/*
+ * openBits() - word w of row y of the free-tile bits: bit i is set if tile (64 * w + i, y) is free; 0 outside the
+ *              grid, whose tiles are never free
+ */
+uint64_t openBits(Grid * grid, int y, int w)
+{
+    int words = openBitWords(grid);
+    if (y < 0 || y >= (int)grid->Height || w < 0 || w >= words) return 0;
+    return grid->OpenBits[(size_t)y * words + w];
+}
+
+/*
+ * forcedBits() - isForcedHorizontal() for the 64 tiles of word w of row y at once: bit i is set if a run moving by
+ *                dx has to stop at tile (64 * w + i, y), blocked or not
+ */
+uint64_t forcedBits(Grid * grid, int y, int w, int dx)
+{
+    uint64_t forced = 0;
+    int row;
+    for (row = y - 1; row <= y + 1; row += 2)
+    {
+        uint64_t open = openBits(grid, row, w);
+        // The tiles a step back along the run, shifted in from the word before
+        uint64_t behind = (dx > 0) ? (open << 1) | (openBits(grid, row, w - 1) >> 63)
+                                   : (open >> 1) | (openBits(grid, row, w + 1) << 63);
+        forced |= open & ~behind;
+    }
+    return forced;
+}
+
+/*
+ * jumpHorizontal() - runs from (x,y) by dx until it reaches the goal or a forced tile, and returns the number
+ *                    of steps taken, or 0 if it hits a wall first
+ *                  - needs the free-tile bits, and scans a word of them at a time
+ */
+int jumpHorizontal(Grid * grid, int x, int y, int dx, coordinate goal)
+{
+    int words = openBitWords(grid);
+    int first = x + dx; // first tile of the run
+    if (first < 0) return 0;
+    int w = first / 64;
+    // The tiles of word w from the first one on, in the direction of the run
+    uint64_t ahead = (dx > 0) ? ~0ULL << (first % 64) : ~0ULL >> (63 - first % 64);
+    for (; w >= 0 && w < words; w += dx, ahead = ~0ULL)
+    {
+        uint64_t walls = ~openBits(grid, y, w) & ahead; // including the tiles past the right edge
+        uint64_t stops = forcedBits(grid, y, w, dx) & ahead;
+        if (goal.y == y && goal.x / 64 == w) stops |= (1ULL << (goal.x % 64)) & ahead;
+        if (walls == 0 && stops == 0) continue;
+        // Whichever comes first along the run; a tile that is both is a wall
+        if (dx > 0)
+        {
+            int stop = (stops != 0) ? __builtin_ctzll(stops) : 64;
+            int wall = (walls != 0) ? __builtin_ctzll(walls) : 64;
+            return (stop < wall) ? 64 * w + stop - x : 0;
+        }
+        int stop = (stops != 0) ? 63 - __builtin_clzll(stops) : -1;
+        int wall = (walls != 0) ? 63 - __builtin_clzll(walls) : -1;
+        return (stop > wall) ? x - (64 * w + stop) : 0;
+    }
+    return 0; // Off the edge of the map
+}
+
+/*
+ * jumpVertical() - runs from (x,y) by dy until it reaches the goal or a tile from which a horizontal run finds
+ *                  something, and returns the number of steps taken, or 0 if it hits a wall first
+ *                - needs the free-tile bits, for the horizontal runs
+ */
+int jumpVertical(Grid * grid, int x, int y, int dy, coordinate goal)
+{
+    int steps = 0;
+    while (1)
+    {
+        y += dy;
+        steps++;
+        if (!isOpen(grid, x, y)) return 0;
+        if (x == goal.x && y == goal.y) return steps;
+        if (jumpHorizontal(grid, x, y, 1, goal) > 0 || jumpHorizontal(grid, x, y, -1, goal) > 0) return steps;
+    }
+}
+
+/*
+ * jumpPrecomputed() - same as jumpHorizontal()/jumpVertical() in the given JUMP_* direction, but in O(1) using the
+ *                     table built by reserveJumpTable() (JPS+)
+ *                   - the table knows every forced tile; only the goal is checked at run time, and a vertical run
+ *                     also stops on the goal's row so that a horizontal run can take it from there
+ */
+int jumpPrecomputed(Grid * grid, int x, int y, int direction, coordinate goal)
+{
+    int jump = grid->Jumps[4 * ((size_t)y * grid->Width + x) + direction];
+    int reach = (jump > 0) ? jump : -jump; // how far this run can go at all
+    int toGoal; // steps to the goal's column (horizontal) or row (vertical), if it is ahead
+    switch (direction)
+    {
+        case JUMP_RIGHT:
+            toGoal = (goal.y == y) ? goal.x - x : 0;
+            break;
+        case JUMP_LEFT:
+            toGoal = (goal.y == y) ? x - goal.x : 0;
+            break;
+        case JUMP_UP:
+            toGoal = y - goal.y;
+            break;
+        default:
+            toGoal = goal.y - y;
+    }
+    if (toGoal > 0 && toGoal <= reach) return toGoal;
+    return (jump > 0) ? jump : 0;
+}
+
+/*
+ * reserveJumpTable() - builds the JPS+ table of the grid if it isn't there yet; returns false if there isn't enough memory
+ *                    - for every tile and JUMP_* direction: the number of steps to the next forced tile (> 0), or
+ *                      minus the number of open tiles before the next wall (<= 0)
+ *                    - one sweep per row and column and direction, so O(Width * Height)
+ */
+bool reserveJumpTable(Grid * grid)
+{
+    int W = grid->Width;
+    int H = grid->Height;
+    int x, y, next;
+    if (grid->Jumps != NULL) return true;
+    grid->Jumps = AllocateAligned((size_t)W * H * 4 * sizeof(int32_t));
+    if (grid->Jumps == NULL) return false;
+    int32_t * J = grid->Jumps;
+    // Horizontal runs first; the vertical ones stop where a horizontal one finds a forced tile
+    for (y = 0; y < H; y++)
+    {
+        for (x = W - 1; x >= 0; x--)
+        {
+            size_t cell = (size_t)y * W + x;
+            if (!isOpen(grid, x + 1, y)) J[4 * cell + JUMP_RIGHT] = 0;
+            else if (isForcedHorizontal(grid, x + 1, y, 1)) J[4 * cell + JUMP_RIGHT] = 1;
+            else
+            {
+                next = J[4 * (cell + 1) + JUMP_RIGHT];
+                J[4 * cell + JUMP_RIGHT] = (next > 0) ? next + 1 : next - 1;
+            }
+        }
+        for (x = 0; x < W; x++)
+        {
+            size_t cell = (size_t)y * W + x;
+            if (!isOpen(grid, x - 1, y)) J[4 * cell + JUMP_LEFT] = 0;
+            else if (isForcedHorizontal(grid, x - 1, y, -1)) J[4 * cell + JUMP_LEFT] = 1;
+            else
+            {
+                next = J[4 * (cell - 1) + JUMP_LEFT];
+                J[4 * cell + JUMP_LEFT] = (next > 0) ? next + 1 : next - 1;
+            }
+        }
+    }
+    for (x = 0; x < W; x++)
+    {
+        for (y = 0; y < H; y++)
+        {
+            size_t cell = (size_t)y * W + x;
+            size_t above = cell - W;
+            if (!isOpen(grid, x, y - 1)) J[4 * cell + JUMP_UP] = 0;
+            else if (J[4 * above + JUMP_RIGHT] > 0 || J[4 * above + JUMP_LEFT] > 0) J[4 * cell + JUMP_UP] = 1;
+            else
+            {
+                next = J[4 * above + JUMP_UP];
+                J[4 * cell + JUMP_UP] = (next > 0) ? next + 1 : next - 1;
+            }
+        }
+        for (y = H - 1; y >= 0; y--)
+        {
+            size_t cell = (size_t)y * W + x;
+            size_t below = cell + W;
+            if (!isOpen(grid, x, y + 1)) J[4 * cell + JUMP_DOWN] = 0;
+            else if (J[4 * below + JUMP_RIGHT] > 0 || J[4 * below + JUMP_LEFT] > 0) J[4 * cell + JUMP_DOWN] = 1;
+            else
+            {
+                next = J[4 * below + JUMP_DOWN];
+                J[4 * cell + JUMP_DOWN] = (next > 0) ? next + 1 : next - 1;
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * reserveOpenBits() - packs the free tiles of the grid into its free-tile bits if they aren't there yet, for
+ *                     jumpHorizontal() and jumpVertical(); returns false if there isn't enough memory
+ *                   - a bit per tile, so an eighth of the obstacle mask, in one pass over it
+ */
+bool reserveOpenBits(Grid * grid)
+{
+    unsigned int words = openBitWords(grid);
+    unsigned int x, y;
+    if (grid->OpenBits != NULL) return true;
+    grid->OpenBits = AllocateAligned((size_t)grid->Height * words * sizeof(uint64_t));
+    if (grid->OpenBits == NULL) return false;
+    memset(grid->OpenBits, 0, (size_t)grid->Height * words * sizeof(uint64_t));
+    for (y = 0; y < grid->Height; y++)
+    {
+        const uint8_t * blocked = grid->Blocked + (size_t)y * grid->Width;
+        uint64_t * bits = grid->OpenBits + (size_t)y * words;
+        for (x = 0; x < grid->Width; x++)
+        {
+            if (!blocked[x]) bits[x / 64] |= 1ULL << (x % 64);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,352 @@
+#pragma once
+#include "line.h"
+#include "grid.h"
+#include <sys/mman.h> // mmap(), munmap()
+#include <sys/stat.h> // fstat(), S_ISREG()
+#include <fcntl.h> // open()
+#include <unistd.h> // close()
+
+/*  COMPILED MAPS
+ *  Reading a map means parsing its polygons with fscanf, rasterizing them and labelling the regions, and on big
+ *  maps that is most of the start-up time. A compiled map is all of that done once, saved as a binary file that
+ *  is mapped into memory as it is: a header, a table of sections, then the sections, each on a cache line.
+ *    - the obstacles, a bit per tile, 64-bit words per row; unpacked into Blocked in one pass
+ *    - the polygons, for the visibility graph: where each one ends, then every vertex
+ *    - the component labels and region sizes, used in place
+ *    - optionally, an ALT table, used in place
+ *  The mapping is private, so the tables used in place can still be changed (e.g. by SetGridCell) without
+ *  touching the file. The header keeps a hash of the text the map was compiled from, so a compiled map whose text
+ *  has changed since is rejected, and the HashGrid() of its obstacles, so a damaged one is rejected too. The
+ *  numbers are stored the way the machine holds them; a file from a machine of the other byte order fails the
+ *  magic number check.
+ */
+
+#define MAPFILE_MAGIC 0x3150414D // "MAP1", first 4 bytes of a compiled map
+#define MAPFILE_VERSION 1 // bumped whenever the layout changes; files of other versions are rejected
+#define MAPFILE_ALIGNMENT 64 // sections start on a cache line of the file, and so of the mapping
+#define MAPFILE_ANY_SOURCE 0 // source hash that takes a compiled map whatever text it was compiled from
+
+// Sections
+#define MAPFILE_OBSTACLES 1 // Count = 64-bit words per row
+#define MAPFILE_POLYGONS 2 // Count = polygons; their ends (uint32_t), then the vertices (coordinate)
+#define MAPFILE_COMPONENTS 3 // Count = labels handed out; Label (uint32_t per tile), then Size (see components.h)
+#define MAPFILE_LANDMARKS 4 // Count = landmarks; the ALT table (see alt.h)
+#define MAPFILE_SECTIONS 4 // most sections a file has
+
+typedef struct
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t Width;
+    uint32_t Height;
+    int32_t Start[2]; // the map's own query
+    int32_t Goal[2];
+    uint64_t SourceHash; // FNV-1a of the text the map was compiled from
+    uint64_t GridHash; // HashGrid() of the obstacles
+    uint32_t SectionCount;
+    uint32_t Reserved;
+} MapFileHeader; // First bytes of a compiled map, followed by SectionCount MapFileSections
+
+typedef struct
+{
+    uint32_t Kind; // MAPFILE_*
+    uint32_t Count; // what it counts depends on the kind
+    uint64_t Offset; // from the start of the file; a multiple of MAPFILE_ALIGNMENT
+    uint64_t Size; // in bytes
+} MapFileSection;
+
+bool regularFile(FILE * file);
+uint64_t hashMapSource(FILE * file);
+bool saveCompiledMap(Grid * grid, coordinate start, coordinate goal, uint64_t sourceHash, const char * filename);
+Grid * openCompiledMap(const char * filename, uint64_t sourceHash, coordinate * start, coordinate * goal);
+bool writeMapSection(FILE * file, uint64_t * offset, MapFileSection * section, const void * data, size_t size);
+bool checkMapSections(Grid * grid, const MapFileHeader * header, const MapFileSection * sections, size_t fileSize);
+
+/*
+ * regularFile() - whether an open file is a regular file, which can be read again from where it was; a pipe or a
+ *                 terminal (e.g. --map <(...) or /dev/stdin) can only be read once
+ */
+bool regularFile(FILE * file)
+{
+    struct stat info;
+    return fstat(fileno(file), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+/*
+ * hashMapSource() - FNV-1a hash of the rest of an open file, which is left where it was
+ *                 - the file must be a regular one (see regularFile()); anything else is used up
+ */
+uint64_t hashMapSource(FILE * file)
+{
+    uint64_t hash = 14695981039346656037ULL; // FNV offset basis
+    unsigned char buffer[4096];
+    long position = ftell(file);
+    size_t n, i;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        for (i = 0; i < n; i++)
+        {
+            hash = (hash ^ buffer[i]) * 1099511628211ULL; // FNV prime
+        }
+    }
+    clearerr(file);
+    fseek(file, position, SEEK_SET);
+    return hash;
+}
+
+/*
+ * saveCompiledMap() - writes the grid, its polygons, its component labels and, if it has one, its ALT table to a
+ *                     compiled map file, with the map's own query and the hash of the text it was read from
+ *                   - the grid must have its component labels; returns false if the file couldn't be written
+ */
+bool saveCompiledMap(Grid * grid, coordinate start, coordinate goal, uint64_t sourceHash, const char * filename)
+{
+    size_t cells = (size_t)grid->Width * grid->Height;
+    unsigned int words = (grid->Width + 63) / 64;
+    unsigned int x, y, p, count = 0;
+    MapFileHeader header;
+    MapFileSection sections[MAPFILE_SECTIONS];
+    if (grid->Components == NULL) return false;
+    memset(&header, 0, sizeof(header));
+    memset(sections, 0, sizeof(sections));
+    header.Magic = MAPFILE_MAGIC;
+    header.Version = MAPFILE_VERSION;
+    header.Width = grid->Width;
+    header.Height = grid->Height;
+    header.Start[0] = start.x;
+    header.Start[1] = start.y;
+    header.Goal[0] = goal.x;
+    header.Goal[1] = goal.y;
+    header.SourceHash = sourceHash;
+    header.GridHash = HashGrid(grid);
+    sections[count++].Kind = MAPFILE_OBSTACLES;
+    sections[count++].Kind = MAPFILE_POLYGONS;
+    sections[count++].Kind = MAPFILE_COMPONENTS;
+    if (grid->Landmarks != NULL) sections[count++].Kind = MAPFILE_LANDMARKS;
+    header.SectionCount = count;
+    // Pack the obstacles
+    uint64_t * bits = calloc((size_t)grid->Height * words, sizeof(uint64_t));
+    if (bits == NULL) return false;
+    for (y = 0; y < grid->Height; y++)
+    {
+        for (x = 0; x < grid->Width; x++)
+        {
+            if (grid->Blocked[(size_t)y * grid->Width + x]) bits[(size_t)y * words + x / 64] |= 1ULL << (x % 64);
+        }
+    }
+    FILE * file = fopen(filename, "wb");
+    if (file == NULL)
+    {
+        free(bits);
+        return false;
+    }
+    // The header and the section table go first, and again once the offsets are known
+    uint64_t offset = sizeof(header) + count * sizeof(MapFileSection);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(sections, sizeof(MapFileSection), count, file) == count;
+    sections[0].Count = words;
+    ok = ok && writeMapSection(file, &offset, &sections[0], bits, (size_t)grid->Height * words * sizeof(uint64_t));
+    free(bits);
+    unsigned int vertices = (grid->PolygonCount > 0) ? grid->PolygonEnds[grid->PolygonCount - 1] : 0;
+    uint32_t * ends = malloc((grid->PolygonCount + 1) * sizeof(uint32_t));
+    ok = ok && ends != NULL;
+    for (p = 0; ok && p < grid->PolygonCount; p++)
+    {
+        ends[p] = grid->PolygonEnds[p];
+    }
+    sections[1].Count = grid->PolygonCount;
+    ok = ok && writeMapSection(file, &offset, &sections[1], ends, grid->PolygonCount * sizeof(uint32_t));
+    free(ends);
+    // The vertices follow the ends in the same section
+    ok = ok && (vertices == 0 || fwrite(grid->Vertices, sizeof(coordinate), vertices, file) == vertices);
+    sections[1].Size += (uint64_t)vertices * sizeof(coordinate);
+    offset += (uint64_t)vertices * sizeof(coordinate);
+    sections[2].Count = grid->Components->Count;
+    ok = ok && writeMapSection(file, &offset, &sections[2], grid->Components->Label, cells * sizeof(uint32_t));
+    ok = ok && fwrite(grid->Components->Size, sizeof(uint32_t), cells + COMPONENT_SEEDS + 1, file)
+        == cells + COMPONENT_SEEDS + 1;
+    sections[2].Size += (cells + COMPONENT_SEEDS + 1) * sizeof(uint32_t);
+    offset += (cells + COMPONENT_SEEDS + 1) * sizeof(uint32_t);
+    if (grid->Landmarks != NULL)
+    {
+        sections[3].Count = grid->LandmarkCount;
+        ok = ok && writeMapSection(file, &offset, &sections[3], grid->Landmarks,
+            cells * grid->LandmarkCount * sizeof(uint16_t));
+    }
+    ok = ok && fseek(file, sizeof(header), SEEK_SET) == 0
+        && fwrite(sections, sizeof(MapFileSection), count, file) == count;
+    if (fclose(file) != 0) ok = false;
+    if (!ok) remove(filename); // Don't leave half a map behind
+    return ok;
+}
+
+/*
+ * writeMapSection() - pads the file from offset up to the next MAPFILE_ALIGNMENT, then writes size bytes of data
+ *                     there as the start of section; offset is moved past them
+ */
+bool writeMapSection(FILE * file, uint64_t * offset, MapFileSection * section, const void * data, size_t size)
+{
+    static const char zeros[MAPFILE_ALIGNMENT] = {0};
+    size_t padding = (MAPFILE_ALIGNMENT - *offset % MAPFILE_ALIGNMENT) % MAPFILE_ALIGNMENT;
+    if (padding > 0 && fwrite(zeros, 1, padding, file) != padding) return false;
+    section->Offset = *offset + padding;
+    section->Size = size;
+    *offset = section->Offset + size;
+    return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+/*
+ * openCompiledMap() - maps a compiled map file into memory and returns its grid, with its polygons, its component
+ *                     labels and any ALT table, and sets start and goal to the map's own query
+ *                   - returns NULL if the file can't be read, isn't a compiled map of this version, was compiled from
+ *                     a text other than the one sourceHash is the hash of (unless it is MAPFILE_ANY_SOURCE), is
+ *                     damaged, or if there isn't enough memory
+ *                   - costs a pass over the obstacles, a bit per tile, a copy of the polygons and a check of the
+ *                     labels; the ALT table isn't read until it's used
+ */
+Grid * openCompiledMap(const char * filename, uint64_t sourceHash, coordinate * start, coordinate * goal)
+{
+    struct stat info;
+    unsigned int s, p, x, y;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(MapFileHeader))
+    {
+        close(fd);
+        return NULL;
+    }
+    size_t size = info.st_size;
+    char * image = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file
+    if (image == MAP_FAILED) return NULL;
+    const MapFileHeader * header = (const MapFileHeader *)image;
+    const MapFileSection * sections = (const MapFileSection *)(image + sizeof(MapFileHeader));
+    Grid * grid = NULL;
+    if (header->Magic == MAPFILE_MAGIC && header->Version == MAPFILE_VERSION && header->Width > 0
+        && header->Height > 0 && header->SectionCount <= MAPFILE_SECTIONS
+        && sizeof(MapFileHeader) + header->SectionCount * sizeof(MapFileSection) <= size
+        && (sourceHash == MAPFILE_ANY_SOURCE || header->SourceHash == sourceHash))
+    {
+        grid = CreateNewGrid(header->Width, header->Height);
+    }
+    if (grid == NULL || !checkMapSections(grid, header, sections, size))
+    {
+        if (grid != NULL) AnnihilateGrid(grid);
+        munmap(image, size);
+        return NULL;
+    }
+    bool ok = true;
+    for (s = 0; s < header->SectionCount && ok; s++)
+    {
+        const MapFileSection * section = &sections[s];
+        char * data = image + section->Offset;
+        size_t cells = (size_t)grid->Width * grid->Height;
+        if (section->Kind == MAPFILE_OBSTACLES)
+        {
+            for (y = 0; y < grid->Height; y++)
+            {
+                const uint64_t * row = (const uint64_t *)data + (size_t)y * section->Count;
+                uint8_t * blocked = grid->Blocked + (size_t)y * grid->Width;
+                for (x = 0; x < grid->Width; x++)
+                {
+                    blocked[x] = (row[x / 64] >> (x % 64)) & 1;
+                }
+            }
+        }
+        else if (section->Kind == MAPFILE_POLYGONS)
+        {
+            const uint32_t * ends = (const uint32_t *)data;
+            coordinate * vertices = (coordinate *)(ends + section->Count);
+            for (p = 0; p < section->Count; p++)
+            {
+                unsigned int first = (p > 0) ? ends[p - 1] : 0;
+                AddGridPolygon(grid, vertices + first, ends[p] - first);
+            }
+        }
+        else if (section->Kind == MAPFILE_COMPONENTS)
+        {
+            grid->Components = malloc(sizeof(ComponentLabels));
+            ok = grid->Components != NULL;
+            if (!ok) break;
+            grid->Components->Label = (uint32_t *)data; // Used in place
+            grid->Components->Size = (uint32_t *)data + cells;
+            grid->Components->Count = section->Count;
+            grid->Components->Width = grid->Width;
+            grid->Components->Height = grid->Height;
+            size_t i;
+            for (i = 0; i < cells && ok; i++) // A label past Count would index past Size when a tile changes
+            {
+                ok = grid->Components->Label[i] <= section->Count;
+            }
+        }
+        else if (section->Kind == MAPFILE_LANDMARKS)
+        {
+            grid->Landmarks = (uint16_t *)data; // Used in place
+            grid->LandmarkCount = section->Count;
+        }
+    }
+    // The Grid owns the mapping from here on, so that AnnihilateGrid() leaves the tables in it alone
+    grid->Image = image;
+    grid->ImageSize = size;
+    if (!ok || HashGrid(grid) != header->GridHash)
+    {
+        AnnihilateGrid(grid);
+        return NULL;
+    }
+    start->x = header->Start[0];
+    start->y = header->Start[1];
+    goal->x = header->Goal[0];
+    goal->y = header->Goal[1];
+    return grid;
+}
+
+/*
+ * checkMapSections() - true if every section of a compiled map for the grid's size lies within the file, is aligned,
+ *                      and is as big as its kind and count say; the obstacles, polygons and labels must be there
+ */
+bool checkMapSections(Grid * grid, const MapFileHeader * header, const MapFileSection * sections, size_t fileSize)
+{
+    size_t cells = (size_t)grid->Width * grid->Height;
+    unsigned int s, p, found = 0;
+    for (s = 0; s < header->SectionCount; s++)
+    {
+        const MapFileSection * section = &sections[s];
+        uint64_t expected;
+        if (section->Offset % MAPFILE_ALIGNMENT != 0 || section->Offset > fileSize
+            || section->Size > fileSize - section->Offset)
+        {
+            return false;
+        }
+        if (section->Kind == MAPFILE_OBSTACLES)
+        {
+            if (section->Count != (grid->Width + 63) / 64) return false;
+            expected = (uint64_t)grid->Height * section->Count * sizeof(uint64_t);
+        }
+        else if (section->Kind == MAPFILE_POLYGONS)
+        {
+            if ((uint64_t)section->Count * sizeof(uint32_t) > section->Size) return false;
+            const uint32_t * ends = (const uint32_t *)((const char *)header + section->Offset);
+            for (p = 0; p < section->Count; p++) // Ends must only go up
+            {
+                if (p > 0 && ends[p] < ends[p - 1]) return false;
+            }
+            expected = (uint64_t)section->Count * sizeof(uint32_t)
+                + (uint64_t)((section->Count > 0) ? ends[section->Count - 1] : 0) * sizeof(coordinate);
+        }
+        else if (section->Kind == MAPFILE_COMPONENTS)
+        {
+            if (section->Count > cells + COMPONENT_SEEDS) return false;
+            expected = (cells + cells + COMPONENT_SEEDS + 1) * sizeof(uint32_t);
+        }
+        else if (section->Kind == MAPFILE_LANDMARKS)
+        {
+            if (section->Count == 0) return false;
+            expected = cells * section->Count * sizeof(uint16_t);
+        }
+        else continue; // A kind this version doesn't know; skipped
+        if (section->Size != expected) return false;
+        found |= 1u << section->Kind;
+    }
+    unsigned int required = (1u << MAPFILE_OBSTACLES) | (1u << MAPFILE_POLYGONS) | (1u << MAPFILE_COMPONENTS);
+    return (found & required) == required;
+}
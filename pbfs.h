@@ -0,0 +1,569 @@
+#pragma once
+#include "line.h"
+#include "grid.h"
+#include "search.h"
+#include <pthread.h> // pthread_create(), pthread_join()
+#include <sched.h> // sched_yield()
+#include <stdatomic.h> // atomic_uint, atomic_compare_exchange_weak_explicit()
+
+/*  LEVEL-SYNCHRONOUS PARALLEL BFS
+ *  BFS() takes one tile at a time off a FIFO queue. Here a whole level, i.e., every tile at the same distance
+ *  from the start, is expanded at once, split among the threads, and the next level is built in three steps:
+ *    1. claim: every new tile is claimed by the first tile of the level, in the serial queue's order, that
+ *       reaches it. Top-down, each tile of the level claims its neighbours with an atomic minimum; bottom-up, each
+ *       unreached tile next to the level (found 64 at a time in bitmaps) picks its first neighbour in the level.
+ *    2. emit: each thread walks its slice of the level in order and puts the tiles it claimed, right, left, up
+ *       then down, into a buffer of its own; their predecessors and tile states are written here.
+ *    3. publish: the buffers are laid end to end, which is the very order the serial queue holds the level in.
+ *  A top-down level costs about its number of tiles, a bottom-up one the bitmap words of the rows it spans, so
+ *  each level takes whichever is cheaper. The level the goal turns up in isn't expanded: the part of it that BFS()
+ *  would expand before the goal is replayed with BFS() itself, so the predecessors (the goal's too, which BFS()
+ *  overwrites with every neighbour expanded before it), the tile states and the expanded count all come out the
+ *  same as runSearch()'s.
+ */
+
+// Ways to expand a level
+#define PBFS_AUTO 0 // whichever is cheaper, level by level
+#define PBFS_TOP_DOWN 1 // from the tiles of the level
+#define PBFS_BOTTOM_UP 2 // from the bitmap rows around the level
+
+#define PBFS_BOTTOM_UP_RATIO 1 // a level goes bottom-up once it has more tiles than 1/this of its rows' bitmap words
+#define PBFS_MIN_CELLS (1u << 20) // smallest map the app runs it on; on smaller ones the setup and barriers cost more than they save
+#define PBFS_MIN_SLICE 64 // fewest tiles of a level worth a thread of their own
+#define PBFS_SPINS 1024 // spins at a barrier before yielding the core; matters when there are more threads than cores
+#define PBFS_UNCLAIMED UINT32_MAX
+
+typedef struct
+{
+    SearchContext * Ctx; // the tiles and predecessors are written here, like runSearch() does
+    unsigned int Goal; // cell of the goal
+    unsigned int Threads; // fixed once the workers are let go
+    int Mode; // PBFS_*
+    unsigned int Words; // 64-bit words per row of a bitmap; bits past the last column are set in Closed
+    _Atomic uint64_t * Closed; // bit per tile: blocked, or reached already
+    _Atomic uint64_t * Frontier; // bit per tile: in the level being expanded (bottom-up levels only)
+    _Atomic uint32_t * Claim; // Claim[cell] = serial position of the tile that reached it first, or PBFS_UNCLAIMED
+    uint32_t * Order; // Order[cell] = position of the tile within its level
+    uint32_t * Level[2]; // the level being expanded and the next one, in serial order; room for every tile
+    atomic_int GoalWorker; // worker that emitted the goal, or -1
+    unsigned int GoalIndex; // where in that worker's buffer
+    atomic_bool Go; // set once every worker is started
+    atomic_bool OutOfMemory;
+    atomic_uint Arrived; // workers at the barrier
+    atomic_bool Sense; // flips every time the barrier opens
+} ParallelBFS; // One level-synchronous search, shared by its workers
+
+typedef struct
+{
+    ParallelBFS * Search;
+    unsigned int Id; // worker 0 runs on the calling thread
+    bool Sense; // what Sense flips to when the barrier opens next
+    uint32_t * Buffer; // tiles this worker emitted into the next level
+    unsigned int Capacity;
+    unsigned int Emitted;
+    unsigned int Top; // rows spanned by the emitted tiles
+    unsigned int Bottom;
+    // Results, kept by worker 0
+    unsigned int Base; // tiles in the levels before the last one
+    unsigned int Size; // tiles in the last level
+    unsigned int Previous; // tiles in the level before the last one
+    unsigned int Current; // which of Level holds the last level
+    unsigned int Widest; // tiles in the widest level
+    bool Found; // the last level holds the goal
+} LevelWorker; // One thread of a ParallelBFS
+
+SearchResult parallelBFS(SearchContext * ctx, unsigned int threads, int mode, coordinate start, coordinate goal);
+void * levelWorker(void * arg);
+void levelBarrier(LevelWorker * w);
+void levelSlice(unsigned int n, unsigned int minimum, unsigned int threads, unsigned int id, unsigned int * first, unsigned int * last);
+void claimTopDown(LevelWorker * w, uint32_t * level, unsigned int first, unsigned int last, unsigned int base);
+void claimBottomUp(LevelWorker * w, unsigned int first, unsigned int last, unsigned int base);
+void emitLevel(LevelWorker * w, uint32_t * level, unsigned int first, unsigned int last, unsigned int base);
+void emitTile(LevelWorker * w, unsigned int cell, unsigned int direction);
+void publishLevel(LevelWorker * w, unsigned int offset, uint32_t * next, bool frontier);
+bool levelBit(_Atomic uint64_t * bits, ParallelBFS * s, unsigned int cell);
+void setLevelBit(_Atomic uint64_t * bits, ParallelBFS * s, unsigned int cell, bool on);
+void setPredShared(SearchContext * ctx, unsigned int cell, unsigned int direction);
+
+/*
+ * parallelBFS() - same as runSearch() with STRAT_BFS, i.e., the same path, expanded count, final tile, tile states
+ *                 and predecessors, but found a level at a time on the given number of threads
+ *               - mode is a PBFS_* way to expand the levels; PBFS_AUTO picks for each level
+ *               - falls back to runSearch() for the trivial cases, and if there isn't enough memory
+ *               - worth it on big maps only: it costs a pass over the map to set up, and the threads meet 3 times
+ *                 per level
+ */
+SearchResult parallelBFS(SearchContext * ctx, unsigned int threads, int mode, coordinate start, coordinate goal)
+{
+    Grid * map = ctx->Map;
+    unsigned int W = map->Width;
+    unsigned int H = map->Height;
+    size_t cells = (size_t)W * H;
+    ParallelBFS s;
+    unsigned int i, started;
+    if ((start.x == goal.x && start.y == goal.y) || !searchConnected(ctx, start, goal) || cells >= PBFS_UNCLAIMED)
+    {
+        return runSearch(ctx, STRAT_BFS, FRINGE_BUCKET, start, goal); // Nothing to search, or too big to claim
+    }
+    if (threads == 0) threads = 1;
+    s.Ctx = ctx;
+    s.Goal = (unsigned int)goal.y * W + goal.x;
+    s.Mode = mode;
+    s.Words = (W + 63) / 64;
+    s.Closed = AllocateAligned((size_t)H * s.Words * sizeof(uint64_t));
+    s.Frontier = AllocateAligned((size_t)H * s.Words * sizeof(uint64_t));
+    s.Claim = AllocateAligned(cells * sizeof(uint32_t));
+    s.Order = AllocateAligned(cells * sizeof(uint32_t));
+    s.Level[0] = malloc(cells * sizeof(uint32_t));
+    s.Level[1] = malloc(cells * sizeof(uint32_t));
+    LevelWorker * workers = calloc(threads, sizeof(LevelWorker));
+    pthread_t * pool = malloc(threads * sizeof(pthread_t));
+    atomic_init(&s.GoalWorker, -1);
+    atomic_init(&s.Go, false);
+    atomic_init(&s.OutOfMemory, false);
+    atomic_init(&s.Arrived, 0);
+    atomic_init(&s.Sense, false);
+    bool enough = s.Closed != NULL && s.Frontier != NULL && s.Claim != NULL && s.Order != NULL
+        && s.Level[0] != NULL && s.Level[1] != NULL && workers != NULL && pool != NULL;
+    SearchResult result;
+    result.Found = false;
+    result.Unreachable = false;
+    result.PeakFringe = 0;
+    if (enough)
+    {
+        beginSearch(ctx, start, goal);
+        s.Level[0][0] = (unsigned int)start.y * W + start.x;
+        s.Order[s.Level[0][0]] = 0;
+        for (i = 0; i < threads; i++)
+        {
+            workers[i].Search = &s;
+            workers[i].Id = i;
+        }
+        for (started = 1; started < threads; started++)
+        {
+            if (pthread_create(&pool[started], NULL, levelWorker, &workers[started]) != 0) break;
+        }
+        s.Threads = started; // Whoever could be started; the split of the work doesn't change the result
+        atomic_store(&s.Go, true);
+        levelWorker(&workers[0]);
+        for (i = 1; i < started; i++)
+        {
+            pthread_join(pool[i], NULL);
+        }
+        enough = !atomic_load(&s.OutOfMemory);
+    }
+    if (enough)
+    {
+        LevelWorker * w = &workers[0];
+        uint32_t * level = s.Level[w->Current];
+        coordinate last;
+        if (w->Found)
+        {
+            unsigned int worker = atomic_load(&s.GoalWorker);
+            unsigned int p = s.GoalIndex; // where the goal is in its level
+            for (i = 0; i < worker; i++) p += workers[i].Emitted;
+            // BFS() gives the goal every neighbour it expands before it; the last one in the level before
+            // the goal's is the one left when the goal's level begins
+            uint32_t * previous = s.Level[w->Current ^ 1];
+            unsigned int n = 0, neighbours[4];
+            int best = -1;
+            if (goal.x + 1 < (int)W) neighbours[n++] = s.Goal + 1;
+            if (goal.x > 0) neighbours[n++] = s.Goal - 1;
+            if (goal.y > 0) neighbours[n++] = s.Goal - W;
+            if (goal.y + 1 < (int)H) neighbours[n++] = s.Goal + W;
+            for (i = 0; i < n; i++)
+            {
+                unsigned int o = s.Order[neighbours[i]];
+                if (o < w->Previous && previous[o] == neighbours[i] && (int)o > best) best = o;
+            }
+            setPred(ctx, goal.x, goal.y, previous[best] % W, previous[best] / W);
+            // Replay the tiles of the goal's level that come before it, the way runSearch() expands them
+            Queue * fringe = CreateNewQueueInArena(ctx->Pool, 4);
+            for (i = 0; i < p; i++)
+            {
+                coordinate c = {level[i] % W, level[i] / W};
+                BFS(ctx, fringe, c);
+                setTile(ctx, c.x, c.y, EXPLORED);
+                fringe->Head = 0; // What it queued is in the next level already
+                fringe->Count = 0;
+            }
+            result.Found = true;
+            result.Expanded = w->Base + p;
+            last = goal;
+        }
+        else
+        {
+            result.Expanded = w->Base + w->Size;
+            last.x = level[w->Size - 1] % W; // BFS() stops on the last tile it expands
+            last.y = level[w->Size - 1] / W;
+            setTile(ctx, last.x, last.y, CURRENT);
+        }
+        result.Final = last;
+        result.PeakFringe = w->Widest; // A level is all a level-synchronous search holds at once
+        result.Path = CreateNewStackInArena(ctx->Pool);
+        ReserveStack(result.Path, W + H);
+        PROFILE_START(traced);
+        tracePreds(ctx, last, result.Path);
+        PROFILE_STOP(traced, PROFILE_PATH);
+    }
+    free(s.Closed);
+    free(s.Frontier);
+    free(s.Claim);
+    free(s.Order);
+    free(s.Level[0]);
+    free(s.Level[1]);
+    if (workers != NULL)
+    {
+        for (i = 0; i < threads; i++)
+        {
+            free(workers[i].Buffer);
+        }
+    }
+    free(workers);
+    free(pool);
+    if (!enough) return runSearch(ctx, STRAT_BFS, FRINGE_BUCKET, start, goal);
+    return result;
+}
+
+/*
+ * levelWorker() - body of one thread of a ParallelBFS: sets up its share of the map, then expands its share of
+ *                 every level until the goal turns up or there is nothing left to reach
+ *               - every worker keeps its own copy of the level counters; they all come out the same
+ */
+void * levelWorker(void * arg)
+{
+    LevelWorker * w = arg;
+    ParallelBFS * s = w->Search;
+    Grid * map = s->Ctx->Map;
+    unsigned int W = map->Width;
+    unsigned int H = map->Height;
+    unsigned int first, last, i, t, y, k;
+    while (!atomic_load(&s->Go)) sched_yield();
+    // Set up this worker's rows: nothing claimed, only the blocked tiles (and the start) closed
+    unsigned int start = s->Level[0][0];
+    int mode = (s->Mode == PBFS_BOTTOM_UP) ? PBFS_BOTTOM_UP : PBFS_TOP_DOWN;
+    levelSlice(H, 1, s->Threads, w->Id, &first, &last);
+    for (y = first; y < last; y++)
+    {
+        for (i = 0; i < W; i++)
+        {
+            atomic_store_explicit(&s->Claim[(size_t)y * W + i], PBFS_UNCLAIMED, memory_order_relaxed);
+        }
+        for (k = 0; k < s->Words; k++)
+        {
+            uint64_t closed = 0;
+            for (i = 0; i < 64; i++)
+            {
+                unsigned int x = k * 64 + i;
+                if (x >= W || map->Blocked[(size_t)y * W + x] || (size_t)y * W + x == start) closed |= 1ULL << i;
+            }
+            uint64_t frontier = 0;
+            if (mode == PBFS_BOTTOM_UP && start / W == y && (start % W) / 64 == k) frontier = 1ULL << (start % W % 64);
+            atomic_store_explicit(&s->Closed[(size_t)y * s->Words + k], closed, memory_order_relaxed);
+            atomic_store_explicit(&s->Frontier[(size_t)y * s->Words + k], frontier, memory_order_relaxed);
+        }
+    }
+    levelBarrier(w);
+    unsigned int size = 1, base = 0, current = 0, previous = 0, widest = 1;
+    unsigned int top = start / W, bottom = start / W;
+    bool found = false;
+    while (1)
+    {
+        // 1. Claim the next level
+        if (mode == PBFS_TOP_DOWN)
+        {
+            levelSlice(size, PBFS_MIN_SLICE, s->Threads, w->Id, &first, &last);
+            claimTopDown(w, s->Level[current], first, last, base);
+        }
+        else
+        {
+            unsigned int above = (top > 0) ? top - 1 : 0;
+            unsigned int below = (bottom + 1 < H) ? bottom + 2 : H;
+            levelSlice(below - above, 1, s->Threads, w->Id, &first, &last);
+            claimBottomUp(w, above + first, above + last, base);
+        }
+        levelBarrier(w);
+        // 2. Emit it, slice by slice
+        levelSlice(size, PBFS_MIN_SLICE, s->Threads, w->Id, &first, &last);
+        emitLevel(w, s->Level[current], first, last, base);
+        levelBarrier(w);
+        if (atomic_load(&s->OutOfMemory)) break;
+        unsigned int total = 0, offset = 0;
+        top = H;
+        bottom = 0;
+        for (t = 0; t < s->Threads; t++)
+        {
+            LevelWorker * other = w - w->Id + t;
+            if (t == w->Id) offset = total;
+            total += other->Emitted;
+            if (other->Emitted > 0 && other->Top < top) top = other->Top;
+            if (other->Emitted > 0 && other->Bottom > bottom) bottom = other->Bottom;
+        }
+        if (total == 0) break; // Nothing left to reach; the level just expanded was the last
+        if (total > widest) widest = total;
+        found = (atomic_load(&s->GoalWorker) >= 0);
+        int next = s->Mode;
+        if (next == PBFS_AUTO)
+        {
+            size_t words = (size_t)(bottom - top + 3) * s->Words; // rows a bottom-up pass would scan
+            next = ((size_t)total * PBFS_BOTTOM_UP_RATIO > words) ? PBFS_BOTTOM_UP : PBFS_TOP_DOWN;
+        }
+        if (found) next = PBFS_TOP_DOWN; // Nobody expands the goal's level; no need for its bits
+        // 3. Publish it: this worker's tiles go after those of the workers before it, and the level just
+        // expanded leaves the frontier bitmap
+        if (mode == PBFS_BOTTOM_UP)
+        {
+            for (i = first; i < last; i++)
+            {
+                setLevelBit(s->Frontier, s, s->Level[current][i], false);
+            }
+        }
+        publishLevel(w, offset, s->Level[current ^ 1], next == PBFS_BOTTOM_UP);
+        levelBarrier(w);
+        previous = size;
+        base += size;
+        size = total;
+        current ^= 1;
+        mode = next;
+        if (found) break;
+    }
+    w->Base = base;
+    w->Size = size;
+    w->Previous = previous;
+    w->Current = current;
+    w->Widest = widest;
+    w->Found = found;
+    return NULL;
+}
+
+/*
+ * levelBarrier() - waits until every worker of the search has called it as many times as this one
+ *                - spins, since the threads meet a few times per level, but gives up the core after a while
+ */
+void levelBarrier(LevelWorker * w)
+{
+    ParallelBFS * s = w->Search;
+    unsigned int spins = 0;
+    w->Sense = !w->Sense;
+    if (atomic_fetch_add(&s->Arrived, 1) == s->Threads - 1)
+    {
+        atomic_store(&s->Arrived, 0);
+        atomic_store(&s->Sense, w->Sense); // Last one in lets everybody go
+        return;
+    }
+    while (atomic_load(&s->Sense) != w->Sense)
+    {
+        if (++spins > PBFS_SPINS) sched_yield();
+    }
+}
+
+/*
+ * levelSlice() - the part [first, last) of n items that a worker takes; workers get the minimum number of items or
+ *                more, so on a small level only the first few get any
+ */
+void levelSlice(unsigned int n, unsigned int minimum, unsigned int threads, unsigned int id, unsigned int * first, unsigned int * last)
+{
+    unsigned int active = n / minimum;
+    if (active == 0) active = 1;
+    if (active > threads) active = threads;
+    if (id >= active)
+    {
+        *first = *last = n;
+        return;
+    }
+    *first = (unsigned int)((uint64_t)n * id / active);
+    *last = (unsigned int)((uint64_t)n * (id + 1) / active);
+}
+
+/*
+ * claimTopDown() - every tile of level[first..last) claims its open neighbours, keeping the smallest serial
+ *                  position on each; base is the serial position of level[0]
+ */
+void claimTopDown(LevelWorker * w, uint32_t * level, unsigned int first, unsigned int last, unsigned int base)
+{
+    ParallelBFS * s = w->Search;
+    unsigned int W = s->Ctx->Map->Width;
+    unsigned int H = s->Ctx->Map->Height;
+    unsigned int i, k;
+    for (i = first; i < last; i++)
+    {
+        unsigned int cell = level[i];
+        unsigned int x = cell % W;
+        uint32_t position = base + i;
+        unsigned int n = 0, neighbours[4];
+        if (x + 1 < W) neighbours[n++] = cell + 1;
+        if (x > 0) neighbours[n++] = cell - 1;
+        if (cell >= W) neighbours[n++] = cell - W;
+        if (cell / W + 1 < H) neighbours[n++] = cell + W;
+        for (k = 0; k < n; k++)
+        {
+            if (levelBit(s->Closed, s, neighbours[k])) continue;
+            uint32_t seen = atomic_load_explicit(&s->Claim[neighbours[k]], memory_order_relaxed);
+            while (position < seen && !atomic_compare_exchange_weak_explicit(&s->Claim[neighbours[k]], &seen,
+                position, memory_order_relaxed, memory_order_relaxed));
+        }
+    }
+}
+
+/*
+ * claimBottomUp() - every open tile in rows [first, last) with a neighbour in the level claims itself for the
+ *                   first such neighbour; the candidates of a bitmap word are found with a few shifts
+ */
+void claimBottomUp(LevelWorker * w, unsigned int first, unsigned int last, unsigned int base)
+{
+    ParallelBFS * s = w->Search;
+    unsigned int W = s->Ctx->Map->Width;
+    unsigned int H = s->Ctx->Map->Height;
+    unsigned int words = s->Words;
+    unsigned int y, k;
+    for (y = first; y < last; y++)
+    {
+        _Atomic uint64_t * row = s->Frontier + (size_t)y * words;
+        for (k = 0; k < words; k++)
+        {
+            uint64_t here = atomic_load_explicit(&row[k], memory_order_relaxed);
+            uint64_t near = (here << 1) | (here >> 1); // Neighbours right and left, within the word
+            if (k > 0) near |= atomic_load_explicit(&row[k - 1], memory_order_relaxed) >> 63;
+            if (k + 1 < words) near |= atomic_load_explicit(&row[k + 1], memory_order_relaxed) << 63;
+            if (y > 0) near |= atomic_load_explicit(&(row - words)[k], memory_order_relaxed);
+            if (y + 1 < H) near |= atomic_load_explicit(&(row + words)[k], memory_order_relaxed);
+            near &= ~atomic_load_explicit(&s->Closed[(size_t)y * words + k], memory_order_relaxed);
+            while (near != 0)
+            {
+                unsigned int x = k * 64 + __builtin_ctzll(near);
+                unsigned int cell = y * W + x;
+                uint32_t best = PBFS_UNCLAIMED;
+                near &= near - 1;
+                if (x + 1 < W && levelBit(s->Frontier, s, cell + 1) && s->Order[cell + 1] < best) best = s->Order[cell + 1];
+                if (x > 0 && levelBit(s->Frontier, s, cell - 1) && s->Order[cell - 1] < best) best = s->Order[cell - 1];
+                if (y > 0 && levelBit(s->Frontier, s, cell - W) && s->Order[cell - W] < best) best = s->Order[cell - W];
+                if (y + 1 < H && levelBit(s->Frontier, s, cell + W) && s->Order[cell + W] < best) best = s->Order[cell + W];
+                atomic_store_explicit(&s->Claim[cell], base + best, memory_order_relaxed);
+            }
+        }
+    }
+}
+
+/*
+ * emitLevel() - every tile of level[first..last), in order, is expanded: it is marked EXPLORED and the neighbours
+ *               it claimed go into the worker's buffer, right, left, up, down, like BFS() queues them
+ */
+void emitLevel(LevelWorker * w, uint32_t * level, unsigned int first, unsigned int last, unsigned int base)
+{
+    ParallelBFS * s = w->Search;
+    unsigned int W = s->Ctx->Map->Width;
+    unsigned int H = s->Ctx->Map->Height;
+    unsigned int i;
+    w->Emitted = 0;
+    w->Top = H;
+    w->Bottom = 0;
+    if (w->Capacity < 4 * (last - first)) // Room for every neighbour of the slice
+    {
+        free(w->Buffer);
+        w->Capacity = 4 * (last - first);
+        w->Buffer = malloc(w->Capacity * sizeof(uint32_t));
+        if (w->Buffer == NULL)
+        {
+            w->Capacity = 0;
+            atomic_store(&s->OutOfMemory, true);
+            return;
+        }
+    }
+    for (i = first; i < last; i++)
+    {
+        unsigned int cell = level[i];
+        unsigned int x = cell % W;
+        uint32_t position = base + i;
+        setTile(s->Ctx, x, cell / W, EXPLORED);
+        if (x + 1 < W && atomic_load_explicit(&s->Claim[cell + 1], memory_order_relaxed) == position)
+        {
+            emitTile(w, cell + 1, PRED_LEFT);
+        }
+        if (x > 0 && atomic_load_explicit(&s->Claim[cell - 1], memory_order_relaxed) == position)
+        {
+            emitTile(w, cell - 1, PRED_RIGHT);
+        }
+        if (cell >= W && atomic_load_explicit(&s->Claim[cell - W], memory_order_relaxed) == position)
+        {
+            emitTile(w, cell - W, PRED_DOWN);
+        }
+        if (cell / W + 1 < H && atomic_load_explicit(&s->Claim[cell + W], memory_order_relaxed) == position)
+        {
+            emitTile(w, cell + W, PRED_UP);
+        }
+    }
+}
+
+/*
+ * emitTile() - puts a claimed tile into the worker's buffer, with direction (a PRED_*) pointing at its claimant
+ */
+void emitTile(LevelWorker * w, unsigned int cell, unsigned int direction)
+{
+    ParallelBFS * s = w->Search;
+    unsigned int W = s->Ctx->Map->Width;
+    unsigned int y = cell / W;
+    setPredShared(s->Ctx, cell, direction);
+    if (cell == s->Goal) // GOAL must supercede QUEUED, as in BFS()
+    {
+        s->GoalIndex = w->Emitted;
+        atomic_store(&s->GoalWorker, w->Id);
+    }
+    else setTile(s->Ctx, cell % W, y, QUEUED);
+    if (y < w->Top) w->Top = y;
+    if (y > w->Bottom) w->Bottom = y;
+    w->Buffer[w->Emitted++] = cell;
+}
+
+/*
+ * publishLevel() - copies the worker's buffer into the next level from offset on, and closes its tiles; frontier
+ *                  also marks them in the frontier bitmap for a bottom-up pass
+ */
+void publishLevel(LevelWorker * w, unsigned int offset, uint32_t * next, bool frontier)
+{
+    ParallelBFS * s = w->Search;
+    unsigned int i;
+    for (i = 0; i < w->Emitted; i++)
+    {
+        unsigned int cell = w->Buffer[i];
+        next[offset + i] = cell;
+        s->Order[cell] = offset + i;
+        setLevelBit(s->Closed, s, cell, true);
+        if (frontier) setLevelBit(s->Frontier, s, cell, true);
+    }
+}
+
+/*
+ * levelBit() - whether the bit of a tile is set in one of the search's bitmaps
+ */
+bool levelBit(_Atomic uint64_t * bits, ParallelBFS * s, unsigned int cell)
+{
+    unsigned int W = s->Ctx->Map->Width;
+    unsigned int x = cell % W;
+    uint64_t word = atomic_load_explicit(&bits[(size_t)(cell / W) * s->Words + x / 64], memory_order_relaxed);
+    return (word >> (x % 64)) & 1;
+}
+
+/*
+ * setLevelBit() - sets (on) or clears the bit of a tile in one of the search's bitmaps; other workers may be
+ *                 changing other bits of the same word
+ */
+void setLevelBit(_Atomic uint64_t * bits, ParallelBFS * s, unsigned int cell, bool on)
+{
+    unsigned int W = s->Ctx->Map->Width;
+    unsigned int x = cell % W;
+    _Atomic uint64_t * word = &bits[(size_t)(cell / W) * s->Words + x / 64];
+    if (on) atomic_fetch_or_explicit(word, 1ULL << (x % 64), memory_order_relaxed);
+    else atomic_fetch_and_explicit(word, ~(1ULL << (x % 64)), memory_order_relaxed);
+}
+
+/*
+ * setPredShared() - same as setPred(), given the cell and the PRED_* direction, for when other workers may be
+ *                   writing the predecessors of the other 3 tiles that share its byte
+ */
+void setPredShared(SearchContext * ctx, unsigned int cell, unsigned int direction)
+{
+    _Atomic uint8_t * byte = (_Atomic uint8_t *)&ctx->Pred[cell >> 2];
+    unsigned int shift = (cell & 3) * 2;
+    atomic_fetch_and_explicit(byte, (uint8_t)~(3u << shift), memory_order_relaxed);
+    atomic_fetch_or_explicit(byte, (uint8_t)(direction << shift), memory_order_relaxed);
+}
@@ -0,0 +1,236 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h> // memcpy()
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h> // clock_gettime(), CLOCK_MONOTONIC
+
+/*  PROFILING
+ *  Built with -DPROFILE (or with the '#define PROFILE' at the top of app.c uncommented), the app times the phases
+ *  of a run (reading the map, rasterizing its polygons, labelling its regions, building what a strategy needs,
+ *  each search and the path it traces) and counts what the fringes go through. Without it, every PROFILE_* macro
+ *  expands to nothing and none of this is compiled in.
+ *    - each thread keeps its own totals and its own list of timed spans, so the batch workers never share a
+ *      cache line; the first span a thread records links its totals into a global list, under a lock
+ *    - profileReport() prints the totals of every thread together
+ *    - profileWriteTrace() writes every span as a Chrome trace event ("X", per thread), and the fringe counters
+ *      after each search as counter events ("C"), for chrome://tracing or Perfetto
+ *  A span covers the phases started inside it, e.g. the rasterizing is part of reading the map.
+ */
+
+// Phases
+#define PROFILE_PARSE 0 // reading the map: parsing its text, or mapping its compiled file
+#define PROFILE_RASTERIZE 1 // blocking the tiles of a polygon
+#define PROFILE_LABEL 2 // labelling the map's regions
+#define PROFILE_PREPARE 3 // building a strategy's table or graph
+#define PROFILE_SEARCH 4 // one query, path included
+#define PROFILE_PATH 5 // tracing the path of a query back from where it stopped
+#define PROFILE_PHASES 6
+
+// Counters
+#define PROFILE_PUSHES 0 // cells put in a fringe (queue, stack or A* fringe)
+#define PROFILE_POPS 1 // cells taken out of one
+#define PROFILE_DUPLICATES 2 // A* fringe inserts of a cell the heap or bucket queue holds already, which update it in
+                             // place; the sorted list can't tell, and keeps a stale copy instead
+#define PROFILE_REQUEUES 3 // cells Astar() queued again because the getF() check found a cheaper way to them
+#define PROFILE_COUNTERS 4
+
+#define PROFILE_MAX_EVENTS (1u << 20) // spans kept per thread for the trace; later ones only add to the totals
+
+#ifdef PROFILE
+#include <pthread.h> // pthread_mutex_t
+
+#define PROFILE_START(t) uint64_t t = profileNow()
+#define PROFILE_STOP(t, phase) profileSpan(phase, t)
+#define PROFILE_COUNT(counter) profileCount(counter, 1)
+
+typedef struct
+{
+    uint64_t Start; // profileNow() when the span began
+    uint64_t Duration; // ns
+    uint64_t Counters[PROFILE_COUNTERS]; // the thread's counters when the span ended
+    unsigned int Phase;
+} ProfileEvent;
+
+typedef struct ProfileThread
+{
+    unsigned int Id; // 'tid' in the trace; 0 is the first thread to record anything
+    uint64_t Time[PROFILE_PHASES]; // ns spent in each phase
+    uint64_t Spans[PROFILE_PHASES]; // times each phase was entered
+    uint64_t Counters[PROFILE_COUNTERS];
+    ProfileEvent * Events;
+    size_t EventCount;
+    size_t EventCapacity;
+    uint64_t Dropped; // spans past PROFILE_MAX_EVENTS, or that didn't fit in memory
+    struct ProfileThread * Next;
+} ProfileThread; // What one thread recorded
+
+static ProfileThread * profileThreads = NULL; // every thread that recorded anything, newest first
+static unsigned int profileThreadCount = 0;
+static pthread_mutex_t profileLock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local ProfileThread * profileSelf = NULL;
+
+static const char * const profilePhaseNames[PROFILE_PHASES] = {"parse", "rasterize", "label", "prepare", "search", "path"};
+static const char * const profileCounterNames[PROFILE_COUNTERS] = {"pushes", "pops", "duplicates", "requeues"};
+#else
+#define PROFILE_START(t)
+#define PROFILE_STOP(t, phase) ((void)0)
+#define PROFILE_COUNT(counter) ((void)0)
+#endif
+
+#ifdef PROFILE
+uint64_t profileNow();
+ProfileThread * profileThread();
+void profileSpan(unsigned int phase, uint64_t start);
+void profileCount(unsigned int counter, uint64_t n);
+void profileReport(FILE * log);
+bool profileWriteTrace(const char * filename);
+
+/*
+ * profileNow() - monotonic wall-clock time in nanoseconds
+ */
+uint64_t profileNow()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * profileThread() - the calling thread's record, created and linked into the global list the first time; NULL if
+ *                   there isn't enough memory for it
+ */
+ProfileThread * profileThread()
+{
+    if (profileSelf != NULL) return profileSelf;
+    ProfileThread * self = calloc(1, sizeof(ProfileThread));
+    if (self == NULL) return NULL;
+    pthread_mutex_lock(&profileLock);
+    self->Id = profileThreadCount++;
+    self->Next = profileThreads;
+    profileThreads = self;
+    pthread_mutex_unlock(&profileLock);
+    profileSelf = self; // Outlives the thread, so that the batch workers can be reported after they are joined
+    return self;
+}
+
+/*
+ * profileSpan() - adds the time from start to now to a phase of the calling thread, and keeps the span for the
+ *                 trace
+ */
+void profileSpan(unsigned int phase, uint64_t start)
+{
+    uint64_t end = profileNow();
+    ProfileThread * self = profileThread();
+    if (self == NULL) return;
+    self->Time[phase] += end - start;
+    self->Spans[phase]++;
+    if (self->EventCount == self->EventCapacity)
+    {
+        size_t capacity = (self->EventCapacity > 0) ? 2 * self->EventCapacity : 256;
+        ProfileEvent * events = (capacity <= PROFILE_MAX_EVENTS) ? realloc(self->Events, capacity * sizeof(ProfileEvent)) : NULL;
+        if (events == NULL)
+        {
+            self->Dropped++;
+            return;
+        }
+        self->Events = events;
+        self->EventCapacity = capacity;
+    }
+    ProfileEvent * e = &self->Events[self->EventCount++];
+    e->Start = start;
+    e->Duration = end - start;
+    e->Phase = phase;
+    memcpy(e->Counters, self->Counters, sizeof(e->Counters));
+}
+
+/*
+ * profileCount() - adds n to a counter of the calling thread
+ */
+void profileCount(unsigned int counter, uint64_t n)
+{
+    ProfileThread * self = profileThread();
+    if (self != NULL) self->Counters[counter] += n;
+}
+
+/*
+ * profileReport() - prints how long every phase took and how often it was entered, and the counters, summed over
+ *                   every thread, on log
+ */
+void profileReport(FILE * log)
+{
+    uint64_t time[PROFILE_PHASES] = {0}, spans[PROFILE_PHASES] = {0}, counters[PROFILE_COUNTERS] = {0}, dropped = 0;
+    ProfileThread * t;
+    unsigned int i;
+    pthread_mutex_lock(&profileLock);
+    for (t = profileThreads; t != NULL; t = t->Next)
+    {
+        for (i = 0; i < PROFILE_PHASES; i++)
+        {
+            time[i] += t->Time[i];
+            spans[i] += t->Spans[i];
+        }
+        for (i = 0; i < PROFILE_COUNTERS; i++) counters[i] += t->Counters[i];
+        dropped += t->Dropped;
+    }
+    fprintf(log, "\nProfile (%u threads):", profileThreadCount);
+    pthread_mutex_unlock(&profileLock);
+    for (i = 0; i < PROFILE_PHASES; i++)
+    {
+        if (spans[i] > 0) fprintf(log, "\n  %-10s %14.6f ms in %llu spans", profilePhaseNames[i], time[i] / 1e6, (unsigned long long)spans[i]);
+    }
+    for (i = 0; i < PROFILE_COUNTERS; i++)
+    {
+        fprintf(log, "\n  %-10s %14llu", profileCounterNames[i], (unsigned long long)counters[i]);
+    }
+    if (dropped > 0) fprintf(log, "\n  (%llu spans left out of the trace)", (unsigned long long)dropped);
+    fprintf(log, "\n");
+}
+
+/*
+ * profileWriteTrace() - writes every span kept as a Chrome trace-event JSON file: a complete event per span, on
+ *                       the track of its thread, and after each search a counter event with the fringe counters;
+ *                       false if the file can't be written
+ */
+bool profileWriteTrace(const char * filename)
+{
+    FILE * f = fopen(filename, "w");
+    if (f == NULL) return false;
+    ProfileThread * t;
+    size_t i;
+    unsigned int c;
+    bool first = true;
+    uint64_t epoch = UINT64_MAX; // The first span of all starts at 0
+    pthread_mutex_lock(&profileLock);
+    for (t = profileThreads; t != NULL; t = t->Next)
+    {
+        for (i = 0; i < t->EventCount; i++) if (t->Events[i].Start < epoch) epoch = t->Events[i].Start;
+    }
+    fprintf(f, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    for (t = profileThreads; t != NULL; t = t->Next)
+    {
+        fprintf(f, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s %u\"}}",
+            first ? "" : ",\n", t->Id, (t->Id == 0) ? "main" : "thread", t->Id);
+        first = false;
+        for (i = 0; i < t->EventCount; i++)
+        {
+            ProfileEvent * e = &t->Events[i];
+            double ts = (e->Start - epoch) / 1e3; // Trace times are in microseconds
+            fprintf(f, ",\n{\"name\": \"%s\", \"cat\": \"phase\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                profilePhaseNames[e->Phase], t->Id, ts, e->Duration / 1e3);
+            if (e->Phase != PROFILE_SEARCH) continue;
+            fprintf(f, ",\n{\"name\": \"fringe\", \"ph\": \"C\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"args\": {", t->Id,
+                ts + e->Duration / 1e3);
+            for (c = 0; c < PROFILE_COUNTERS; c++)
+            {
+                fprintf(f, "%s\"%s\": %llu", (c > 0) ? ", " : "", profileCounterNames[c], (unsigned long long)e->Counters[c]);
+            }
+            fprintf(f, "}}");
+        }
+    }
+    pthread_mutex_unlock(&profileLock);
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0;
+}
+#endif
@@ -5,101 +5,132 @@
 *****************************************************************************/
 #pragma once
 #include "line.h"
-
-typedef struct QueueNode
-{
-	coordinate Data;
-	struct QueueNode * Next;
-} QueueNode;
+#include "arena.h"
 
 typedef struct
 {
-	QueueNode * Head;
-	QueueNode * Tail;
+	coordinate * Data; // ring buffer holding the queued coordinates inline
+	unsigned int Head; // index of the first element in Data
+	unsigned int Count; // number of elements in the Queue
+	unsigned int Capacity; // number of slots allocated for Data
+	Arena * Pool; // where Data and the Queue itself come from; NULL means malloc
 } Queue;
 
+#define QUEUE_DEFAULT_CAPACITY 64
+
 // Function declarations; see 'stack.c' for definitions
 Queue * CreateNewQueue();
+Queue * CreateNewQueueWithCapacity(unsigned int capacity);
+Queue * CreateNewQueueInArena(Arena * pool, unsigned int capacity);
 void AnnihilateQueue(Queue * targetQueue);
-QueueNode * Enqueue(Queue * targetQueue, unsigned int x, unsigned int y);
+coordinate * Enqueue(Queue * targetQueue, unsigned int x, unsigned int y);
 coordinate Dequeue(Queue * targetQueue);
+void GrowQueue(Queue * targetQueue);
 void QueueUnderflow();
 void PrintQueue(Queue * targetQueue);
 
 // <summary>
 // CreateNewQueue - allocates space for a new empty Queue and returns a pointer to that Queue
 //                - the pointer DOES NOT point to the head of the Queue
-//                - Members: Head - First element of the Queue
+//                - Members: Data - ring buffer, Head - index of the first element of the Queue
 //				  - The creator of the Stack has the implicit responsibility of freeing up the Queue Later
 //                  using the AnnihilateQueue(..) function
 // </summary>
 Queue * CreateNewQueue()
 {
-	Queue * q = malloc(sizeof(Queue));
-	q->Head = NULL; // Initialize Queue as empty
-	q->Tail = NULL;
+	return CreateNewQueueWithCapacity(QUEUE_DEFAULT_CAPACITY);
+}
+
+// <summary>
+// CreateNewQueueWithCapacity - same as CreateNewQueue, but reserves room for 'capacity' elements up front
+//                            - the Queue still grows past that if needed; the hint just avoids regrowing
+// </summary>
+Queue * CreateNewQueueWithCapacity(unsigned int capacity)
+{
+	return CreateNewQueueInArena(NULL, capacity);
+}
+
+// <summary>
+// CreateNewQueueInArena - same as CreateNewQueueWithCapacity, but all memory is drawn from the given Arena
+//                       - resetting the Arena frees the Queue; AnnihilateQueue is then unnecessary
+// </summary>
+Queue * CreateNewQueueInArena(Arena * pool, unsigned int capacity)
+{
+	Queue * q = ArenaAlloc(pool, sizeof(Queue));
+	if (capacity == 0) capacity = QUEUE_DEFAULT_CAPACITY;
+	q->Pool = pool;
+	q->Data = ArenaAlloc(pool, capacity * sizeof(coordinate));
+	q->Capacity = capacity;
+	q->Head = 0; // Initialize Queue as empty
+	q->Count = 0;
 	return q;
 }
 
 // <summary>
-// AnnihilateQueue - goes through each Node in the Queue and pops them
-//                 - DOES NOT return the data in a Node; purely destructive
-//                 - also frees up the memory allocated for the queue itself
+// AnnihilateQueue - frees up the ring buffer and the memory allocated for the queue itself
+//                 - DOES NOT return the data in the Queue; purely destructive
 // </summary>
 void AnnihilateQueue(Queue * targetQueue)
 {
-	while (targetQueue->Head != NULL) // Do while queue is not empty
-	{
-		(void)Dequeue(targetQueue); // Pop each node and discard data returned
-		// freeing up of memory used for each node is handled by the PopFromQueue function
-	}
-	free(targetQueue);	// free up the empty queue
+	ArenaFree(targetQueue->Pool, targetQueue->Data); // elements are stored inline, so there are no nodes to pop
+	ArenaFree(targetQueue->Pool, targetQueue);	// free up the queue
 	return;
 }
 
 // <summary>
-// Enqueue - allocates space for a new node and pushes it into the queue.
-//             - returns a pointer to the new node
+// Enqueue - stores a new element at the tail of the ring buffer, growing it if it is full
+//         - returns a pointer to the new element (valid until the next Enqueue)
 // </summary>
-QueueNode * Enqueue(Queue * targetQueue, unsigned int x, unsigned int y)
+coordinate * Enqueue(Queue * targetQueue, unsigned int x, unsigned int y)
 {
-	QueueNode * n = malloc(sizeof(QueueNode));
-	n->Next = NULL;
-	n->Data.x = x;
-	n->Data.y = y;
-	if (targetQueue->Head == NULL) // If empty, the new node becomes the head and tail
+	if (targetQueue->Count == targetQueue->Capacity)
 	{
-		targetQueue->Head = n;
-		targetQueue->Tail = n;
-	}
-	else // If not empty, the tail's 'next' points to the new node
-	{
-		targetQueue->Tail->Next = n;
-		targetQueue->Tail = n; // The new node becomes the tail
+		GrowQueue(targetQueue);
 	}
+	unsigned int tail = targetQueue->Head + targetQueue->Count;
+	if (tail >= targetQueue->Capacity) tail -= targetQueue->Capacity; // wrap around
+	coordinate * n = &(targetQueue->Data[tail]);
+	n->x = x;
+	n->y = y;
+	targetQueue->Count++;
 	return n;
 }
 
 // <summary>
-// Dequeue - frees up a the head of the queue and returns its contents
+// Dequeue - removes the head of the queue and returns its contents
 // </summary>
 coordinate Dequeue(Queue * targetQueue)
 {
-	if (targetQueue->Head == NULL)
+	coordinate data;
+	if (targetQueue->Count == 0)
 	{
 		QueueUnderflow(); // Queue is empty; Call UNDERFLOW
+		data.x = -1;
+		data.y = -1;
+		return data;
 	}
-	else
-	{
-		QueueNode * node = targetQueue->Head; // Get the Head node
-		coordinate data;
-		data.x = node->Data.x; // Salvage Data
-		data.y = node->Data.y;
-		targetQueue->Head = node->Next;	 // Get Next node, which becomes the new Head
-										// if Next == NULL, then the Queue is automatically empty
-		free(node);	// Free up memory
-		return data; // Return the 'salvaged Data'
-	}
+	data = targetQueue->Data[targetQueue->Head]; // Salvage Data
+	targetQueue->Head++; // The next element becomes the new Head
+	if (targetQueue->Head == targetQueue->Capacity) targetQueue->Head = 0; // wrap around
+	targetQueue->Count--;
+	return data; // Return the 'salvaged Data'
+}
+
+// <summary>
+// GrowQueue - doubles the capacity of the ring buffer, unwrapping its contents so that Head becomes 0
+// </summary>
+void GrowQueue(Queue * targetQueue)
+{
+	unsigned int capacity = targetQueue->Capacity * 2;
+	coordinate * data = ArenaAlloc(targetQueue->Pool, capacity * sizeof(coordinate));
+	unsigned int first = targetQueue->Capacity - targetQueue->Head; // elements from Head to the end of the buffer
+	if (first > targetQueue->Count) first = targetQueue->Count;
+	memcpy(data, targetQueue->Data + targetQueue->Head, first * sizeof(coordinate));
+	memcpy(data + first, targetQueue->Data, (targetQueue->Count - first) * sizeof(coordinate));
+	ArenaFree(targetQueue->Pool, targetQueue->Data);
+	targetQueue->Data = data;
+	targetQueue->Capacity = capacity;
+	targetQueue->Head = 0;
 }
 
 // <summary>
@@ -117,10 +148,10 @@ void QueueUnderflow()
 // </summary>
 void PrintQueue(Queue * targetQueue)
 {
-	QueueNode * node = targetQueue->Head;
-	while(node != NULL)
+	unsigned int i;
+	for (i = 0; i < targetQueue->Count; i++)
 	{
-		printf("(%d, %d) ", node->Data.x, node->Data.y);
-		node = node->Next;
+		coordinate * n = &(targetQueue->Data[(targetQueue->Head + i) % targetQueue->Capacity]);
+		printf("(%d, %d) ", n->x, n->y);
 	}
 }
@@ -0,0 +1,175 @@
+#pragma once
+#include "line.h"
+
+// Rasterization modes
+#define RASTER_OUTLINE 1 // Block only the edges of a polygon
+#define RASTER_FILLED 2 // Block the edges and the interior of a polygon
+
+typedef struct
+{
+    long long num;
+    long long den; // always positive
+} fraction; // An exact x-coordinate where a scanline crosses an edge
+
+void rasterizePolygon(coordinate * vertices, unsigned int n, int mode, uint8_t * cells, unsigned int width, unsigned int height, uint8_t value);
+void rasterizeEdge(coordinate a, coordinate b, uint8_t * cells, unsigned int width, unsigned int height, uint8_t value);
+void fillPolygon(coordinate * vertices, unsigned int n, uint8_t * cells, unsigned int width, unsigned int height, uint8_t value);
+void markCell(int x, int y, int xmin, int xmax, int ymin, int ymax, uint8_t * cells, unsigned int width, unsigned int height, uint8_t value);
+long long floorDiv(long long a, long long b);
+long long ceilDiv(long long a, long long b);
+bool fractionLess(fraction a, fraction b);
+
+/*
+ * rasterizePolygon() - sets every cell covered by the polygon with the given vertices to value
+ *                    - cells is a row-major width x height array; parts of the polygon outside it are clipped
+ *                    - only the cells inside the bounding box of each edge (or of the polygon if filled) are touched
+ */
+void rasterizePolygon(coordinate * vertices, unsigned int n, int mode, uint8_t * cells, unsigned int width, unsigned int height, uint8_t value)
+{
+    unsigned int i;
+    for (i = 0; i < n; i++)
+    {
+        rasterizeEdge(vertices[i], vertices[(i + 1) % n], cells, width, height, value);
+    }
+    if (mode == RASTER_FILLED)
+    {
+        fillPolygon(vertices, n, cells, width, height, value);
+    }
+}
+
+/*
+ * rasterizeEdge() - sets the cells on the edge from a to b, using the same rule as inLine():
+ *                   for every column, the cells just above and below the exact line, and for every row,
+ *                   the cells just left and right of it, as long as they are inside the edge's bounding box
+ *                 - works in exact integer arithmetic, so there is no float rounding and no per-cell test
+ */
+void rasterizeEdge(coordinate a, coordinate b, uint8_t * cells, unsigned int width, unsigned int height, uint8_t value)
+{
+    int xmin = (a.x < b.x) ? a.x : b.x;
+    int xmax = (a.x < b.x) ? b.x : a.x;
+    int ymin = (a.y < b.y) ? a.y : b.y;
+    int ymax = (a.y < b.y) ? b.y : a.y;
+    long long dx = b.x - a.x;
+    long long dy = b.y - a.y;
+    int x, y;
+    if (dx == 0) // Vertical line
+    {
+        for (y = ymin; y <= ymax; y++)
+        {
+            markCell(a.x, y, xmin, xmax, ymin, ymax, cells, width, height, value);
+        }
+        return;
+    }
+    // For every column, y = a.y + dy * (x - a.x) / dx
+    for (x = xmin; x <= xmax; x++)
+    {
+        long long t = dy * (x - a.x);
+        markCell(x, a.y + floorDiv(t, dx), xmin, xmax, ymin, ymax, cells, width, height, value);
+        markCell(x, a.y + ceilDiv(t, dx), xmin, xmax, ymin, ymax, cells, width, height, value);
+    }
+    if (dy == 0) return; // Horizontal line; the columns already covered it
+    // For every row, x = a.x + dx * (y - a.y) / dy
+    for (y = ymin; y <= ymax; y++)
+    {
+        long long t = dx * (y - a.y);
+        markCell(a.x + floorDiv(t, dy), y, xmin, xmax, ymin, ymax, cells, width, height, value);
+        markCell(a.x + ceilDiv(t, dy), y, xmin, xmax, ymin, ymax, cells, width, height, value);
+    }
+}
+
+/*
+ * fillPolygon() - sets the cells strictly inside the polygon (even-odd rule), one scanline at a time
+ *               - each row is crossed against every edge; the crossings are sorted and filled in pairs
+ */
+void fillPolygon(coordinate * vertices, unsigned int n, uint8_t * cells, unsigned int width, unsigned int height, uint8_t value)
+{
+    int ymin = vertices[0].y;
+    int ymax = vertices[0].y;
+    unsigned int i, j, k;
+    int y;
+    for (i = 1; i < n; i++)
+    {
+        if (vertices[i].y < ymin) ymin = vertices[i].y;
+        if (vertices[i].y > ymax) ymax = vertices[i].y;
+    }
+    if (ymin < 0) ymin = 0;
+    if (ymax > (int)height - 1) ymax = height - 1;
+    fraction * crossings = malloc(n * sizeof(fraction)); // a row crosses each edge at most once
+    for (y = ymin; y <= ymax; y++)
+    {
+        k = 0;
+        for (i = 0; i < n; i++)
+        {
+            coordinate a = vertices[i];
+            coordinate b = vertices[(i + 1) % n];
+            // Half-open rule [lower y, upper y) so shared vertices are counted once and horizontal edges never
+            if ((a.y <= y && y < b.y) || (b.y <= y && y < a.y))
+            {
+                fraction c;
+                c.num = (long long)a.x * (b.y - a.y) + (long long)(b.x - a.x) * (y - a.y);
+                c.den = b.y - a.y;
+                if (c.den < 0)
+                {
+                    c.num = -c.num;
+                    c.den = -c.den;
+                }
+                // Insertion sort; polygons in our maps have a handful of edges
+                j = k++;
+                while (j > 0 && fractionLess(c, crossings[j - 1]))
+                {
+                    crossings[j] = crossings[j - 1];
+                    j--;
+                }
+                crossings[j] = c;
+            }
+        }
+        for (i = 0; i + 1 < k; i += 2)
+        {
+            long long from = ceilDiv(crossings[i].num, crossings[i].den);
+            long long to = floorDiv(crossings[i + 1].num, crossings[i + 1].den);
+            if (from < 0) from = 0;
+            if (to > (long long)width - 1) to = width - 1;
+            for (; from <= to; from++)
+            {
+                cells[(size_t)y * width + from] = value;
+            }
+        }
+    }
+    free(crossings);
+}
+
+/*
+ * markCell() - sets cell (x,y) to value if it is inside both the box [xmin,xmax] x [ymin,ymax] and the grid
+ */
+void markCell(int x, int y, int xmin, int xmax, int ymin, int ymax, uint8_t * cells, unsigned int width, unsigned int height, uint8_t value)
+{
+    if (x < xmin || x > xmax || y < ymin || y > ymax) return;
+    if (x < 0 || y < 0 || x >= (int)width || y >= (int)height) return;
+    cells[(size_t)y * width + x] = value;
+}
+
+/*
+ * floorDiv() - floor(a / b) for b != 0, rounding towards negative infinity unlike C's '/'
+ */
+long long floorDiv(long long a, long long b)
+{
+    long long q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) q--;
+    return q;
+}
+
+/*
+ * ceilDiv() - ceil(a / b) for b != 0
+ */
+long long ceilDiv(long long a, long long b)
+{
+    return -floorDiv(-a, b);
+}
+
+/*
+ * fractionLess() - true if a < b
+ */
+bool fractionLess(fraction a, fraction b)
+{
+    return a.num * b.den < b.num * a.den;
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h> // INT_MAX
+
+/*  STREAMING MAP READER
+ *  fscanf parses a map one number at a time, through the locale, the format string and the stdio buffer, and the
+ *  polygons used to be read into a variable-length array sized by the vertex count in the file, so a polygon of
+ *  millions of vertices ran off the stack. The scanner reads the file a big block at a time into one buffer and
+ *  parses the numbers right out of it; nothing is copied per token. A number cut in two at the end of the block
+ *  is finished after the next block is read, since its digits are added up as they come. The buffer ends in a
+ *  NUL that no number or keyword takes, so the parsing loops need no bounds checks of their own.
+ */
+
+#define SCANNER_BLOCK (1u << 20) // bytes read from the file at a time
+
+// What scanInt() found
+#define SCAN_BAD -1 // something that isn't a number comes next, or a number that doesn't fit in an int
+#define SCAN_END 0 // nothing but whitespace is left in the file
+#define SCAN_OK 1 // a number, now in *value
+
+typedef struct
+{
+    FILE * File;
+    char * Buffer; // SCANNER_BLOCK bytes, then a NUL
+    char * Next; // first byte not parsed yet
+    char * End; // one past the last byte read; always a NUL
+    bool Eof; // nothing more to read from the file
+    uint64_t Bytes; // read from the file so far
+} Scanner;
+
+Scanner * createScanner(FILE * file);
+void destroyScanner(Scanner * scanner);
+bool fillScanner(Scanner * scanner);
+bool skipSpace(Scanner * scanner);
+bool scanKeyword(Scanner * scanner, const char * word);
+int scanInt(Scanner * scanner, int * value);
+
+/*
+ * createScanner() - a scanner over the rest of an open file, which it reads from but doesn't close; NULL if there
+ *                   isn't enough memory
+ */
+Scanner * createScanner(FILE * file)
+{
+    Scanner * scanner = malloc(sizeof(Scanner));
+    if (scanner == NULL) return NULL;
+    scanner->Buffer = malloc(SCANNER_BLOCK + 1);
+    if (scanner->Buffer == NULL)
+    {
+        free(scanner);
+        return NULL;
+    }
+    scanner->File = file;
+    scanner->Next = scanner->End = scanner->Buffer;
+    *scanner->End = '\0';
+    scanner->Eof = false;
+    scanner->Bytes = 0;
+    return scanner;
+}
+
+/*
+ * destroyScanner() - frees the scanner, but leaves its file open
+ */
+void destroyScanner(Scanner * scanner)
+{
+    if (scanner == NULL) return;
+    free(scanner->Buffer);
+    free(scanner);
+}
+
+/*
+ * fillScanner() - moves the bytes not parsed yet to the front of the buffer and reads as many more as fit after
+ *                 them; false if nothing more could be read
+ */
+bool fillScanner(Scanner * scanner)
+{
+    if (scanner->Eof) return false;
+    size_t left = scanner->End - scanner->Next;
+    memmove(scanner->Buffer, scanner->Next, left); // at most a keyword's worth
+    size_t n = fread(scanner->Buffer + left, 1, SCANNER_BLOCK - left, scanner->File);
+    if (n < SCANNER_BLOCK - left) scanner->Eof = true;
+    scanner->Bytes += n;
+    scanner->Next = scanner->Buffer;
+    scanner->End = scanner->Buffer + left + n;
+    *scanner->End = '\0';
+    return n > 0;
+}
+
+/*
+ * skipSpace() - skips whitespace, reading on as needed; false if the file ends first
+ */
+bool skipSpace(Scanner * scanner)
+{
+    while (true)
+    {
+        char * p = scanner->Next;
+        while (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r' || *p == '\v' || *p == '\f') p++;
+        scanner->Next = p;
+        if (p < scanner->End) return true;
+        if (!fillScanner(scanner)) return false;
+    }
+}
+
+/*
+ * scanKeyword() - skips whitespace, then the given word if it comes next (like a literal in an fscanf format);
+ *                 true if it did
+ */
+bool scanKeyword(Scanner * scanner, const char * word)
+{
+    size_t length = strlen(word);
+    if (!skipSpace(scanner)) return false;
+    if ((size_t)(scanner->End - scanner->Next) < length) fillScanner(scanner);
+    if ((size_t)(scanner->End - scanner->Next) < length || memcmp(scanner->Next, word, length) != 0) return false;
+    scanner->Next += length;
+    return true;
+}
+
+/*
+ * scanInt() - skips whitespace, then reads a decimal number with an optional sign (like fscanf's %d)
+ *           - returns SCAN_OK, SCAN_END if the file ends first, or SCAN_BAD if what comes next isn't a number or
+ *             doesn't fit in an int, so that the end of a map can be told apart from a broken one
+ */
+int scanInt(Scanner * scanner, int * value)
+{
+    if (!skipSpace(scanner)) return SCAN_END;
+    if (scanner->End - scanner->Next < 2) fillScanner(scanner); // the sign and the first digit together
+    char * p = scanner->Next;
+    bool negative = (*p == '-');
+    if (*p == '-' || *p == '+') p++;
+    if (*p < '0' || *p > '9') return SCAN_BAD;
+    int64_t n = 0;
+    while (true)
+    {
+        while (*p >= '0' && *p <= '9')
+        {
+            n = n * 10 + (*p++ - '0');
+            if (n > (int64_t)INT_MAX + 1) return SCAN_BAD;
+        }
+        if (p < scanner->End) break;
+        // The number runs on into the next block
+        scanner->Next = p;
+        if (!fillScanner(scanner)) break;
+        p = scanner->Next;
+    }
+    if (negative) n = -n;
+    if (n > INT_MAX || n < INT_MIN) return SCAN_BAD;
+    scanner->Next = p;
+    *value = (int)n;
+    return SCAN_OK;
+}
@@ -0,0 +1,1268 @@
+#pragma once
+#include "line.h"
+#include "queue.h"
+#include "stack.h"
+#include "fringe.h"
+#include "arena.h"
+#include "grid.h"
+#include "jps.h"
+#include "alt.h"
+#include "hpa.h"
+#include "vis.h"
+#include "bitbfs.h"
+#include <limits.h> // INT_MAX
+
+// Tile states
+#define BLOCKED 1
+#define CURRENT 2
+#define EXPLORED 3
+#define QUEUED 4
+#define UNEXPLORED 5
+#define GOAL 6
+#define INSIDE_PATH 7
+
+// Search strategies
+#define STRAT_BFS 1
+#define STRAT_DFS 2
+#define STRAT_ASTAR 3
+#define STRAT_JPS 4 // Jump Point Search
+#define STRAT_JPS_PLUS 5 // Jump Point Search with precomputed jumps (JPS+)
+#define STRAT_BIBFS 6 // Bidirectional BFS
+#define STRAT_BIASTAR 7 // Bidirectional A*
+#define STRAT_ALT 8 // A* with the ALT landmark heuristic
+#define STRAT_HPA 9 // Hierarchical A* (HPA*); fast but not always optimal
+#define STRAT_VISIBILITY 10 // A* on the visibility graph of the polygons; any-angle waypoints instead of tiles
+
+// Halves of a bidirectional search
+#define SEARCH_FORWARD 0 // from the start, on Tiles, Pred and F
+#define SEARCH_BACKWARD 1 // from the goal, on BackTiles, BackPred and BackF
+
+// Predecessor directions, i.e., where the tile visited before a tile lies relative to it
+#define PRED_RIGHT 0 // (x + 1, y)
+#define PRED_LEFT 1 // (x - 1, y)
+#define PRED_UP 2 // (x, y - 1)
+#define PRED_DOWN 3 // (x, y + 1)
+
+// A tile keeps its state in the low TILE_STATE_BITS bits and the generation it was written in above them;
+// a tile written in an older generation is UNEXPLORED, so starting a new search is just a new generation
+#define TILE_STATE_BITS 3
+#define TILE_STATE_MASK 7
+#define TILE_GENERATIONS (1 << (16 - TILE_STATE_BITS)) // the tiles are wiped once every this many searches
+
+typedef struct
+{
+    Grid * Map; // shared obstacle map; never written by a search
+    uint16_t * Tiles; // Tiles[y * Width + x] = generation and status of tile (x,y); blocked tiles come from Map
+    unsigned int Generation; // generation of the current search; never 0, which is what a wiped tile holds
+    uint8_t * Pred; // 2-bit PRED_* direction per tile, 4 tiles per byte; meaningless for unvisited tiles
+    int * F; // F[y * Width + x] = f(n) of tile (x,y); NULL until reserveStrategy() is called (A* and JPS only)
+    int * Jump; // Jump[y * Width + x] = length of the run from the parent of jump point (x,y) to it (JPS only)
+    uint16_t * BackTiles; // same as Tiles, Pred and F for the backward half of a bidirectional search, where both
+    uint8_t * BackPred;   // F and BackF hold g(n) instead of f(n); NULL until reserveStrategy() is called
+    int * BackF;          // (bidirectional search only)
+    coordinate Origin; // the one tile with no predecessor, i.e., where the search started
+    const uint16_t * GoalLandmarks; // the goal's row of the map's ALT table during an ALT search, NULL otherwise
+    Arena * Pool; // the fringe and the path of the current search are drawn from here
+    Arena * Scratch; // A* fringes, kept and reused across searches since they index every tile
+    AstarFringe * Fringes[2][FRINGE_BUCKET]; // Fringes[side][type - 1] = A* fringe of that type for that SEARCH_* half,
+                                             // or NULL if not used yet
+    BitBoard * Reach; // the map's free tiles and the region last swept from a start, for maps whose regions aren't
+                      // labelled (see searchConnected()); NULL until the first search on such a map
+    uint64_t ReachChanges; // the map's Changes when Reach took its free tiles
+    bool ReachSwept; // whether Reach->Reached holds a region of those free tiles
+} SearchContext; // Everything one search writes to; one per concurrent query
+
+typedef struct
+{
+    bool Found; // true if the goal was reached
+    bool Unreachable; // true if the map's component labels ruled the goal out before anything was searched
+    int Expanded; // number of expanded nodes
+    unsigned int PeakFringe; // most nodes waiting in the fringe at once; both halves together for bidirectional search
+    coordinate Final; // where the search stopped; the goal if Found
+    Stack * Path; // Final and its predecessors back to the start, start on top; lives in the context's Pool
+} SearchResult;
+
+SearchContext * createSearchContext(Grid * map);
+void destroySearchContext(SearchContext * ctx);
+bool reserveStrategy(SearchContext * ctx, int strategy);
+void beginSearch(SearchContext * ctx, coordinate start, coordinate goal);
+void clearTiles(SearchContext * ctx);
+const char * strategyName(int strategy);
+double pathLength(Stack * path);
+AstarFringe * getAstarFringe(SearchContext * ctx, int fringeType, int side);
+SearchResult runSearch(SearchContext * ctx, int strategy, int fringeType, coordinate start, coordinate goal);
+bool searchConnected(SearchContext * ctx, coordinate start, coordinate goal);
+void setTile(SearchContext * ctx, unsigned int x, unsigned int y, unsigned int s);
+unsigned int getTile(SearchContext * ctx, unsigned int x, unsigned int y);
+void setTileIn(SearchContext * ctx, uint16_t * tiles, unsigned int x, unsigned int y, unsigned int s);
+unsigned int getTileIn(SearchContext * ctx, uint16_t * tiles, unsigned int x, unsigned int y);
+void setPred(SearchContext * ctx, unsigned int x, unsigned int y, unsigned int px, unsigned int py);
+coordinate getPred(SearchContext * ctx, unsigned int x, unsigned int y);
+void setPredIn(SearchContext * ctx, uint8_t * pred, unsigned int x, unsigned int y, unsigned int px, unsigned int py);
+coordinate getPredIn(SearchContext * ctx, uint8_t * pred, coordinate root, unsigned int x, unsigned int y);
+void setF(SearchContext * ctx, unsigned int x, unsigned int y, int f);
+int getF(SearchContext * ctx, unsigned int x, unsigned int y);
+coordinate teleport(SearchContext * ctx, coordinate current, coordinate target);
+void drawGrid(SearchContext * ctx);
+int absval(int x);
+void BFS(SearchContext * ctx, Queue * fringe, coordinate current);
+void DFS(SearchContext * ctx, Stack * fringe, coordinate current);
+int h(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
+int estimate(SearchContext * ctx, unsigned int x, unsigned int y, coordinate goal);
+void Astar(SearchContext * ctx, AstarFringe * fringe, coordinate current, unsigned int g, coordinate goal);
+void JPS(SearchContext * ctx, AstarFringe * fringe, coordinate current, int g, coordinate goal, bool precomputed);
+void jumpTo(SearchContext * ctx, AstarFringe * fringe, coordinate current, int g, coordinate goal, int direction, bool precomputed);
+void traceJumps(SearchContext * ctx, coordinate last, Stack * path);
+void tracePreds(SearchContext * ctx, coordinate last, Stack * path);
+coordinate biBFS(SearchContext * ctx, coordinate start, coordinate goal, int * expanded, unsigned int * peakFringe);
+coordinate biAstar(SearchContext * ctx, int fringeType, coordinate start, coordinate goal, int * expanded,
+    unsigned int * peakFringe);
+void traceMeeting(SearchContext * ctx, coordinate meet, coordinate start, coordinate goal, Stack * path);
+
+/*
+ * createSearchContext() - allocates the per-search state for searches on the given map
+ *                       - the map is only read, so any number of contexts can share it (one per thread)
+ *                       - returns NULL if there isn't enough memory
+ */
+SearchContext * createSearchContext(Grid * map)
+{
+    size_t cells = (size_t)map->Width * map->Height;
+    SearchContext * ctx = malloc(sizeof(SearchContext));
+    int i, side;
+    if (ctx == NULL) return NULL;
+    ctx->Map = map;
+    ctx->Origin.x = -1;
+    ctx->Origin.y = -1;
+    ctx->GoalLandmarks = NULL;
+    ctx->Tiles = AllocateAligned(cells * sizeof(uint16_t));
+    ctx->Generation = 0;
+    ctx->Pred = AllocateAligned((cells + 3) / 4);
+    ctx->F = NULL;
+    ctx->Jump = NULL;
+    ctx->BackTiles = NULL;
+    ctx->BackPred = NULL;
+    ctx->BackF = NULL;
+    ctx->Pool = CreateNewArena(ARENA_DEFAULT_BLOCK_SIZE);
+    ctx->Scratch = CreateNewArena(ARENA_DEFAULT_BLOCK_SIZE);
+    ctx->Reach = NULL;
+    ctx->ReachChanges = 0;
+    ctx->ReachSwept = false;
+    for (side = SEARCH_FORWARD; side <= SEARCH_BACKWARD; side++)
+    {
+        for (i = 0; i < FRINGE_BUCKET; i++)
+        {
+            ctx->Fringes[side][i] = NULL;
+        }
+    }
+    if (ctx->Tiles == NULL || ctx->Pred == NULL || ctx->Pool == NULL || ctx->Scratch == NULL)
+    {
+        destroySearchContext(ctx);
+        return NULL; // Not enough memory for a map this size
+    }
+    // The only full passes over the map a context ever makes (besides one every TILE_GENERATIONS searches)
+    memset(ctx->Tiles, 0, cells * sizeof(uint16_t));
+    memset(ctx->Pred, 0, (cells + 3) / 4); // keeps the read-modify-write in setPred() well-defined
+    return ctx;
+}
+
+/*
+ * destroySearchContext() - frees up the context and everything its searches allocated, but not the map
+ */
+void destroySearchContext(SearchContext * ctx)
+{
+    ArenaReset(ctx->Pool);
+    AnnihilateArena(ctx->Pool);
+    ArenaReset(ctx->Scratch); // takes the fringes with it
+    AnnihilateArena(ctx->Scratch);
+    free(ctx->Tiles);
+    free(ctx->Pred);
+    free(ctx->F);
+    free(ctx->Jump);
+    free(ctx->BackTiles);
+    free(ctx->BackPred);
+    free(ctx->BackF);
+    destroyBitBoard(ctx->Reach);
+    free(ctx);
+}
+
+/*
+ * reserveStrategy() - allocates the arrays the given strategy needs on top of the tiles and predecessors, if they
+ *                     aren't there yet; returns false if there isn't enough memory
+ *                   - JPS also needs the map's free-tile bits, JPS+ its jump table, ALT its landmarks, HPA* its
+ *                     abstract graph and the visibility strategy its visibility graph; see reserveOpenBits(),
+ *                     reserveJumpTable(), reserveLandmarks(), reserveHierarchy() and reserveVisibility()
+ *                   - bidirectional search gets a second set of tiles, predecessors and g(n) for its backward half
+ */
+bool reserveStrategy(SearchContext * ctx, int strategy)
+{
+    size_t cells = (size_t)ctx->Map->Width * ctx->Map->Height;
+    if (strategy == STRAT_BFS || strategy == STRAT_DFS) return true;
+    if (strategy == STRAT_VISIBILITY) return ctx->Map->Visibility != NULL; // Works on the polygons, not the tiles
+    if (ctx->F == NULL)
+    {
+        ctx->F = AllocateAligned(cells * sizeof(int));
+    }
+    if ((strategy == STRAT_JPS || strategy == STRAT_JPS_PLUS) && ctx->Jump == NULL)
+    {
+        ctx->Jump = AllocateAligned(cells * sizeof(int));
+        if (ctx->Jump == NULL) return false;
+    }
+    if (strategy == STRAT_JPS && ctx->Map->OpenBits == NULL) return false;
+    if (strategy == STRAT_JPS_PLUS && ctx->Map->Jumps == NULL) return false;
+    if (strategy == STRAT_ALT && ctx->Map->Landmarks == NULL) return false;
+    if (strategy == STRAT_HPA && ctx->Map->Hierarchy == NULL) return false;
+    if ((strategy == STRAT_BIBFS || strategy == STRAT_BIASTAR) && ctx->BackTiles == NULL)
+    {
+        ctx->BackTiles = AllocateAligned(cells * sizeof(uint16_t));
+        ctx->BackPred = AllocateAligned((cells + 3) / 4);
+        ctx->BackF = AllocateAligned(cells * sizeof(int));
+        if (ctx->BackTiles == NULL || ctx->BackPred == NULL || ctx->BackF == NULL)
+        {
+            free(ctx->BackTiles);
+            free(ctx->BackPred);
+            free(ctx->BackF);
+            ctx->BackTiles = NULL;
+            ctx->BackPred = NULL;
+            ctx->BackF = NULL;
+            return false;
+        }
+        // Same as in createSearchContext(); the backward tiles share the context's generation
+        memset(ctx->BackTiles, 0, cells * sizeof(uint16_t));
+        memset(ctx->BackPred, 0, (cells + 3) / 4);
+    }
+    return ctx->F != NULL;
+}
+
+/*
+ * beginSearch() - marks every tile unexplored except start and goal, and frees the previous search's path
+ *               - takes O(1) time no matter how big the map is
+ */
+void beginSearch(SearchContext * ctx, coordinate start, coordinate goal)
+{
+    // Predecessors and f(n) need no clearing; they are only read on tiles this search has reached
+    clearTiles(ctx);
+    ArenaReset(ctx->Pool);
+    setTile(ctx, start.x, start.y, CURRENT);
+    setTile(ctx, goal.x, goal.y, GOAL);
+    ctx->Origin = start; // Tracing back the path stops here
+}
+
+/*
+ * clearTiles() - marks every tile unexplored by starting a new generation
+ */
+void clearTiles(SearchContext * ctx)
+{
+    if (++ctx->Generation == TILE_GENERATIONS) // Out of generations; wipe the tiles and start over
+    {
+        memset(ctx->Tiles, 0, (size_t)ctx->Map->Width * ctx->Map->Height * sizeof(uint16_t));
+        if (ctx->BackTiles != NULL)
+        {
+            memset(ctx->BackTiles, 0, (size_t)ctx->Map->Width * ctx->Map->Height * sizeof(uint16_t));
+        }
+        ctx->Generation = 1;
+    }
+}
+
+/*
+ * strategyName() - short name of a strategy, as printed with its results
+ */
+const char * strategyName(int strategy)
+{
+    switch (strategy)
+    {
+        case STRAT_BFS:
+            return "BFS";
+        case STRAT_DFS:
+            return "DFS";
+        case STRAT_JPS:
+            return "JPS";
+        case STRAT_JPS_PLUS:
+            return "JPS+";
+        case STRAT_BIBFS:
+            return "BiBFS";
+        case STRAT_BIASTAR:
+            return "BiA*";
+        case STRAT_ALT:
+            return "ALT";
+        case STRAT_HPA:
+            return "HPA*";
+        case STRAT_VISIBILITY:
+            return "Visibility";
+        default:
+            return "A*";
+    }
+}
+
+/*
+ * pathLength() - length of a path, in straight lines from each entry to the next; for a path of tiles, that is just
+ *                the number of steps
+ */
+double pathLength(Stack * path)
+{
+    double length = 0;
+    unsigned int i;
+    for (i = 1; i < path->Depth; i++)
+    {
+        double dx = path->Data[i].x - path->Data[i - 1].x;
+        double dy = path->Data[i].y - path->Data[i - 1].y;
+        length += (dx == 0 || dy == 0) ? fabs(dx + dy) : sqrt(dx * dx + dy * dy);
+    }
+    return length;
+}
+
+/*
+ * getAstarFringe() - returns the context's empty A* fringe of the given type for the given SEARCH_* half,
+ *                    creating it the first time
+ *                  - unknown types get the bucket queue, like CreateNewAstarFringe()
+ */
+AstarFringe * getAstarFringe(SearchContext * ctx, int fringeType, int side)
+{
+    if (fringeType != FRINGE_LIST && fringeType != FRINGE_HEAP) fringeType = FRINGE_BUCKET;
+    if (ctx->Fringes[side][fringeType - 1] == NULL)
+    {
+        ctx->Fringes[side][fringeType - 1] = CreateNewAstarFringeInArena(ctx->Scratch, fringeType, ctx->Map->Width, ctx->Map->Height);
+    }
+    return ctx->Fringes[side][fringeType - 1];
+}
+
+/*
+ * runSearch() - searches for a path from start to goal with the given strategy (and fringe, for A*)
+ *             - every strategy but BFS and DFS needs reserveStrategy() to have succeeded on the context first
+ *             - a goal in another region is given up on with nothing expanded, instead of after exploring all the
+ *               start can reach: in O(1) if the map's regions are labelled (see LabelGridComponents()), and with a
+ *               bitboard sweep otherwise (see searchConnected())
+ *             - the result's path stays valid until the next search on the same context
+ */
+SearchResult runSearch(SearchContext * ctx, int strategy, int fringeType, coordinate start, coordinate goal)
+{
+    SearchResult result;
+    coordinate current = start;
+    result.Found = false;
+    result.Unreachable = false;
+    result.Expanded = 0; // Count expanded nodes
+    result.PeakFringe = 0;
+    beginSearch(ctx, start, goal);
+    // The visibility graph treats polygons as solid, so its idea of what is connected isn't the tiles'
+    if (strategy != STRAT_VISIBILITY && !searchConnected(ctx, start, goal))
+    {
+        result.Unreachable = true;
+        result.Final = start;
+        result.Path = CreateNewStackInArena(ctx->Pool);
+        PushToStack(result.Path, start.x, start.y);
+        return result;
+    }
+    if (strategy == STRAT_BFS)
+    {
+        // Create fringe queue (a BFS frontier on a grid rarely holds more than a few rows' worth of tiles)
+        Queue * fringe = CreateNewQueueInArena(ctx->Pool, 2 * (ctx->Map->Width + ctx->Map->Height));
+        do
+        {
+            // Check if we've found the goal
+            if (getTile(ctx, current.x, current.y) == GOAL)
+            {
+                result.Found = true;
+                break;
+            }
+            BFS(ctx, fringe, current);
+            result.Expanded++; // Expanded 1 more node
+            if (fringe->Count > result.PeakFringe) result.PeakFringe = fringe->Count;
+            // If fringe is nonempty, advance to next tile in the fringe queue
+            if (fringe->Count > 0)
+            {
+                // We're gonna move from current to the target tile
+                coordinate target = Dequeue(fringe);
+                PROFILE_COUNT(PROFILE_POPS);
+                current = teleport(ctx, current, target);
+            }
+            else
+            {
+                break; // No solution path
+            }
+        } while(1);
+    }
+    else if (strategy == STRAT_DFS)
+    {
+        // Create fringe stack
+        Stack * fringe = CreateNewStackInArena(ctx->Pool);
+        ReserveStack(fringe, ctx->Map->Width + ctx->Map->Height);
+        do
+        {
+            // Check if we've found the goal
+            if (getTile(ctx, current.x, current.y) == GOAL)
+            {
+                result.Found = true;
+                break;
+            }
+            DFS(ctx, fringe, current);
+            result.Expanded++; // Expanded 1 more node
+            if (fringe->Depth > result.PeakFringe) result.PeakFringe = fringe->Depth;
+            // If fringe is not empty, move to next node in stack
+            if (fringe->Depth > 0)
+            {
+                coordinate target = PopFromStack(fringe);
+                PROFILE_COUNT(PROFILE_POPS);
+                current = teleport(ctx, current, target);
+            }
+            else
+            {
+                break; // No solution path
+            }
+        } while(1);
+    }
+    else if (strategy == STRAT_BIBFS || strategy == STRAT_BIASTAR)
+    {
+        coordinate meet = {-1, -1};
+        // Like the other strategies, never reach a goal inside an obstacle; the backward half would start from it
+        if (getTile(ctx, goal.x, goal.y) != BLOCKED)
+        {
+            if (strategy == STRAT_BIBFS) meet = biBFS(ctx, start, goal, &result.Expanded, &result.PeakFringe);
+            else meet = biAstar(ctx, fringeType, start, goal, &result.Expanded, &result.PeakFringe);
+        }
+        result.Found = (meet.x != -1);
+        result.Final = result.Found ? goal : start;
+        result.Path = CreateNewStackInArena(ctx->Pool);
+        ReserveStack(result.Path, ctx->Map->Width + ctx->Map->Height);
+        PROFILE_START(traced);
+        if (result.Found) traceMeeting(ctx, meet, start, goal, result.Path); // Two half paths, joined where they met
+        else PushToStack(result.Path, start.x, start.y);
+        PROFILE_STOP(traced, PROFILE_PATH);
+        return result;
+    }
+    else if (strategy == STRAT_HPA)
+    {
+        result.Path = CreateNewStackInArena(ctx->Pool);
+        ReserveStack(result.Path, ctx->Map->Width + ctx->Map->Height);
+        result.Found = hierarchicalSearch(ctx->Map, ctx->Pool, fringeType, start, goal, result.Path, &result.Expanded,
+            &result.PeakFringe);
+        result.Final = result.Found ? goal : start;
+        if (!result.Found) PushToStack(result.Path, start.x, start.y);
+        return result;
+    }
+    else if (strategy == STRAT_VISIBILITY)
+    {
+        result.Path = CreateNewStackInArena(ctx->Pool);
+        result.Found = visibilitySearch(ctx->Map, ctx->Pool, start, goal, result.Path, &result.Expanded,
+            &result.PeakFringe) >= 0;
+        result.Final = result.Found ? goal : start;
+        if (!result.Found) PushToStack(result.Path, start.x, start.y);
+        return result; // The path is waypoints, with straight lines between them; see pathLength()
+    }
+    else // Use A* as default strategy; JPS is A* on jump points only, ALT is A* with a better h(n)
+    {
+        // Create fringe priority queue (sorted doubly linked list, heap or bucket queue)
+        AstarFringe * fringe = getAstarFringe(ctx, fringeType, SEARCH_FORWARD);
+        int g = 0; // g(n) of the current node
+        bool jps = (strategy == STRAT_JPS || strategy == STRAT_JPS_PLUS);
+        if (jps) setF(ctx, goal.x, goal.y, INT_MAX); // JPS only queues the goal again if it gets there cheaper
+        if (strategy == STRAT_ALT)
+        {
+            ctx->GoalLandmarks = ctx->Map->Landmarks + ((size_t)goal.y * ctx->Map->Width + goal.x) * ctx->Map->LandmarkCount;
+        }
+        do
+        {
+            // Check if we've found the goal
+            if (getTile(ctx, current.x, current.y) == GOAL)
+            {
+                result.Found = true;
+                break;
+            }
+            // Get A* search successors (automagically sorted)
+            if (jps) JPS(ctx, fringe, current, g, goal, strategy == STRAT_JPS_PLUS);
+            else Astar(ctx, fringe, current, g, goal);
+            result.Expanded++;
+            // If fringe is nonempty, advance to next tile in the fringe
+            #ifdef DEBUG
+                printf("\n\n$ Fringe: ");
+                PrintAstarFringe(fringe);
+            #endif
+
+            if (!IsAstarFringeEmpty(fringe))
+            {
+                // We're gonna move from current to the target tile
+                // Get new level along with the coordinates
+                coordinate target = PopFromAstarFringe(fringe, &g);
+                current = teleport(ctx, current, target);
+            }
+            else
+            {
+                break; // No solution path
+            }
+        } while(1);
+        result.PeakFringe = fringe->Peak;
+        ClearAstarFringe(fringe); // Ready for the next search
+        ctx->GoalLandmarks = NULL;
+    }
+    // The BFS and DFS fringes live in the context's arena and go away when the next search begins
+    result.Final = current;
+    // Build the path by tracing back our footsteps
+    result.Path = CreateNewStackInArena(ctx->Pool);
+    ReserveStack(result.Path, ctx->Map->Width + ctx->Map->Height); // enough for any shortest path; DFS paths double a few times at most
+    PROFILE_START(traced);
+    if (strategy == STRAT_JPS || strategy == STRAT_JPS_PLUS) traceJumps(ctx, current, result.Path); // Only jump points know their predecessor
+    else tracePreds(ctx, current, result.Path);
+    PROFILE_STOP(traced, PROFILE_PATH);
+    return result;
+}
+
+/*
+ * searchConnected() - false if no path leads from start to goal; the same answer as GridConnected(), which it is
+ *                     when the map's regions are labelled
+ *                   - without the labels, sweeps the region of the start into the context's bitboard (see
+ *                     bitReach()) and looks the goal up in it; the region is kept, so the next queries that start
+ *                     in it cost O(1) too, until the map changes (see SetGridCell()) or a start outside it comes
+ *                   - a blocked start is left to the search, as with the labels, and so is everything if there
+ *                     isn't enough memory for the bitboard
+ */
+bool searchConnected(SearchContext * ctx, coordinate start, coordinate goal)
+{
+    Grid * map = ctx->Map;
+    size_t root = (size_t)start.y * map->Width + start.x;
+    if (map->Components != NULL) return GridConnected(map, start, goal);
+    if (map->Blocked[root]) return true;
+    if (ctx->Reach == NULL)
+    {
+        ctx->Reach = createBitBoard(map);
+        if (ctx->Reach == NULL) return true;
+        ctx->ReachChanges = map->Changes;
+    }
+    if (ctx->ReachChanges != map->Changes) // Tiles were blocked or freed since; the region may be different now
+    {
+        bitSnapshot(ctx->Reach);
+        ctx->ReachChanges = map->Changes;
+        ctx->ReachSwept = false;
+    }
+    if (!ctx->ReachSwept || !bitReached(ctx->Reach, start.x, start.y))
+    {
+        bitReach(ctx->Reach, root);
+        ctx->ReachSwept = true;
+    }
+    return bitReached(ctx->Reach, goal.x, goal.y);
+}
+
+/*
+ * setTile() - Set coordinates (x,y) to status s
+ */
+void setTile(SearchContext * ctx, unsigned int x, unsigned int y, unsigned int s)
+{
+    setTileIn(ctx, ctx->Tiles, x, y, s);
+}
+
+/*
+ * getTile() - Get status of tile at coordinates (x,y)
+ */
+unsigned int getTile(SearchContext * ctx, unsigned int x, unsigned int y)
+{
+    return getTileIn(ctx, ctx->Tiles, x, y);
+}
+
+/*
+ * setTileIn() - same as setTile(), on the given tiles (Tiles or BackTiles) of the context
+ */
+void setTileIn(SearchContext * ctx, uint16_t * tiles, unsigned int x, unsigned int y, unsigned int s)
+{
+    tiles[y * ctx->Map->Width + x] = (ctx->Generation << TILE_STATE_BITS) | s;
+}
+
+/*
+ * getTileIn() - same as getTile(), on the given tiles (Tiles or BackTiles) of the context
+ */
+unsigned int getTileIn(SearchContext * ctx, uint16_t * tiles, unsigned int x, unsigned int y)
+{
+    unsigned int cell = y * ctx->Map->Width + x;
+    unsigned int tile = tiles[cell];
+    if (ctx->Map->Blocked[cell]) return BLOCKED;
+    return ((tile >> TILE_STATE_BITS) == ctx->Generation) ? (tile & TILE_STATE_MASK) : UNEXPLORED;
+}
+
+/*
+ * setPred() - Set the tile visited before, i.e., predecessor to a tile with coordinates (x,y)
+ *           - (px,py) must be one of the 4 neighbours of (x,y); only its direction is stored
+ */
+void setPred(SearchContext * ctx, unsigned int x, unsigned int y, unsigned int px, unsigned int py)
+{
+    setPredIn(ctx, ctx->Pred, x, y, px, py);
+}
+
+/*
+ * getPred() - Get the tile visited before, i.e., predecessor to a tile with coordinates (x,y)
+ *             Returns the coordinate, or (-1,-1) for the tile the search started from
+ */
+coordinate getPred(SearchContext * ctx, unsigned int x, unsigned int y)
+{
+    return getPredIn(ctx, ctx->Pred, ctx->Origin, x, y);
+}
+
+/*
+ * setPredIn() - same as setPred(), on the given predecessors (Pred or BackPred) of the context
+ */
+void setPredIn(SearchContext * ctx, uint8_t * pred, unsigned int x, unsigned int y, unsigned int px, unsigned int py)
+{
+    size_t cell = (size_t)y * ctx->Map->Width + x;
+    unsigned int shift = (cell & 3) * 2;
+    unsigned int direction;
+    if (px == x + 1) direction = PRED_RIGHT;
+    else if (px + 1 == x) direction = PRED_LEFT;
+    else if (py + 1 == y) direction = PRED_UP;
+    else direction = PRED_DOWN;
+    pred[cell >> 2] = (pred[cell >> 2] & ~(3u << shift)) | (direction << shift);
+}
+
+/*
+ * getPredIn() - same as getPred(), on the given predecessors (Pred or BackPred) of the context, for a search
+ *               that started from root
+ */
+coordinate getPredIn(SearchContext * ctx, uint8_t * pred, coordinate root, unsigned int x, unsigned int y)
+{
+    size_t cell = (size_t)y * ctx->Map->Width + x;
+    coordinate p;
+    p.x = x;
+    p.y = y;
+    if (p.x == root.x && p.y == root.y)
+    {
+        p.x = -1;
+        p.y = -1;
+        return p;
+    }
+    switch ((pred[cell >> 2] >> ((cell & 3) * 2)) & 3)
+    {
+        case PRED_RIGHT:
+            p.x++;
+            break;
+        case PRED_LEFT:
+            p.x--;
+            break;
+        case PRED_UP:
+            p.y--;
+            break;
+        default:
+            p.y++;
+    }
+    return p;
+}
+
+/*
+ * setF() - Set the f(n) value of a point/tile
+ */
+void setF(SearchContext * ctx, unsigned int x, unsigned int y, int f)
+{
+    ctx->F[y * ctx->Map->Width + x] = f;
+}
+
+/*
+ * getF() - Get f(n) of a point/tile
+ */
+int getF(SearchContext * ctx, unsigned int x, unsigned int y)
+{
+    return ctx->F[y * ctx->Map->Width + x];
+}
+
+/*
+ * teleport() - Move into the given coordinates (x,y)
+ *  returns new current coordinate
+ */
+coordinate teleport(SearchContext * ctx, coordinate current, coordinate target)
+{
+    setTile(ctx, current.x, current.y, EXPLORED);
+    if (getTile(ctx, target.x, target.y) != GOAL) // Status GOAL MUST supercede CURRENT
+    {
+        setTile(ctx, target.x, target.y, CURRENT);
+    }
+    return target;
+}
+
+/*
+ * drawGrid() - draw the grid with coordinates (Recommended only for maps about 40 tiles wide on most resolutions)
+ */
+void drawGrid(SearchContext * ctx)
+{
+    int i, j;
+    printf("\n");
+    for (i = 0; i < (int)ctx->Map->Height; i++)
+    {
+        for (j = 0; j < (int)ctx->Map->Width; j++)
+        {
+            switch(getTile(ctx, j, i))
+            {
+                case GOAL:
+                    printf("X");
+                    break;
+                case EXPLORED:
+                    printf(":");
+                    break;
+                case BLOCKED:
+                    printf("@");
+                    break;
+                case CURRENT:
+                    printf("^");
+                    break;
+                case QUEUED:
+                    printf(".");
+                    break;
+                case INSIDE_PATH:
+                    printf("+");
+                    break;
+                default:
+                    printf(" ");
+            }
+        }
+        printf("\n");
+    }
+}
+
+/*
+ * BFS() - "Breadth-First": Enqueue the BFS successors of the current coordinate
+ */
+void BFS(SearchContext * ctx, Queue * fringe, coordinate current)
+{
+    // Assume BFS relative order to be: Right, Left, Up, Down
+    // Check if RIGHT successor is viable
+    if (current.x < (int)ctx->Map->Width - 1 && getTile(ctx, current.x + 1, current.y) >= UNEXPLORED)
+    {
+        Enqueue(fringe, current.x + 1, current.y);
+        PROFILE_COUNT(PROFILE_PUSHES);
+        if(getTile(ctx, current.x + 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
+        {
+            setTile(ctx, current.x + 1, current.y, QUEUED);
+        }
+        // We MIGHT move from current tile to this tile
+        // Set tile's predecessor to the current tile
+        setPred(ctx, current.x + 1, current.y, current.x, current.y);
+    }
+    // Check LEFT
+    if (current.x > 0 && getTile(ctx, current.x - 1, current.y) >= UNEXPLORED)
+    {
+        Enqueue(fringe, current.x - 1, current.y);
+        PROFILE_COUNT(PROFILE_PUSHES);
+        if(getTile(ctx, current.x - 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
+        {
+            setTile(ctx, current.x - 1, current.y, QUEUED);
+        }
+        // Set tile's predecessor to the current tile
+        setPred(ctx, current.x - 1, current.y, current.x, current.y);
+    }
+    // Check UP (but remember, in our grid system, up means lower y)
+    if (current.y > 0 && getTile(ctx, current.x, current.y - 1) >= UNEXPLORED)
+    {
+        Enqueue(fringe, current.x, current.y - 1);
+        PROFILE_COUNT(PROFILE_PUSHES);
+        if(getTile(ctx, current.x, current.y - 1) != GOAL) // GOAL Must supercede other QUEUED
+        {
+            setTile(ctx, current.x, current.y - 1, QUEUED);
+        }
+        // Set tile's predecessor to the current tile
+        setPred(ctx, current.x, current.y - 1, current.x, current.y);
+    }
+    // Check DOWN
+    if (current.y < (int)ctx->Map->Height - 1 && getTile(ctx, current.x, current.y + 1) >= UNEXPLORED)
+    {
+        Enqueue(fringe, current.x, current.y + 1);
+        PROFILE_COUNT(PROFILE_PUSHES);
+        if(getTile(ctx, current.x, current.y + 1) != GOAL) // GOAL Must supercede other QUEUED
+        {
+            setTile(ctx, current.x, current.y + 1, QUEUED);
+        }
+        // Set tile's predecessor to the current tile
+        setPred(ctx, current.x, current.y + 1, current.x, current.y);
+    }
+    return;
+}
+
+/*
+ * DFS() - "Depth-First": Push into the stack the DFS successors of the current coordinate
+ */
+void DFS(SearchContext * ctx, Stack * fringe, coordinate current)
+{
+    // Assume DFS relative order to be: Right, Left, Up, Down
+    // But then we have to push them into the stack in reverse order (i.e., Down, up, left, right)
+    // Check DOWN successor
+    if (current.y < (int)ctx->Map->Height - 1 && getTile(ctx, current.x, current.y + 1) >= UNEXPLORED)
+    {
+        PushToStack(fringe, current.x, current.y + 1);
+        PROFILE_COUNT(PROFILE_PUSHES);
+        if(getTile(ctx, current.x, current.y + 1) != GOAL) // GOAL Must supercede other QUEUED
+        {
+            setTile(ctx, current.x, current.y + 1, QUEUED);
+        }
+        // We MIGHT move from current tile to this tile
+        // Set tile's predecessor to the current tile
+        setPred(ctx, current.x, current.y + 1, current.x, current.y);
+    }
+    // Check UP (but remember, in our grid system, up means lower y)
+    if (current.y > 0 && getTile(ctx, current.x, current.y - 1) >= UNEXPLORED)
+    {
+        PushToStack(fringe, current.x, current.y - 1);
+        PROFILE_COUNT(PROFILE_PUSHES);
+        if(getTile(ctx, current.x, current.y - 1) != GOAL) // GOAL Must supercede other QUEUED
+        {
+            setTile(ctx, current.x, current.y - 1, QUEUED);
+        }
+        // Set tile's predecessor to the current tile
+        setPred(ctx, current.x, current.y - 1, current.x, current.y);
+    }
+    // Check LEFT
+    if (current.x > 0 && getTile(ctx, current.x - 1, current.y) >= UNEXPLORED)
+    {
+        PushToStack(fringe, current.x - 1, current.y);
+        PROFILE_COUNT(PROFILE_PUSHES);
+        if(getTile(ctx, current.x - 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
+        {
+            setTile(ctx, current.x - 1, current.y, QUEUED);
+        }
+        // Set tile's predecessor to the current tile
+        setPred(ctx, current.x - 1, current.y, current.x, current.y);
+    }
+    // Check if RIGHT successor is viable
+    if (current.x < (int)ctx->Map->Width - 1 && getTile(ctx, current.x + 1, current.y) >= UNEXPLORED)
+    {
+        PushToStack(fringe, current.x + 1, current.y);
+        PROFILE_COUNT(PROFILE_PUSHES);
+        if(getTile(ctx, current.x + 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
+        {
+            setTile(ctx, current.x + 1, current.y, QUEUED);
+        }
+        // Set tile's predecessor to the current tile
+        setPred(ctx, current.x + 1, current.y, current.x, current.y);
+    }
+    return;
+}
+
+/*
+ * absval() - Returns the absolute value of a function
+ */
+int absval(int x)
+{
+    return (x < 0) ? -1 * x : x;
+}
+
+/*
+ * h() - Returns the estimated distance of a point alpha to the goal
+ *                      - Uses the (optimistic) Manhattan distance as the heuristic
+ */
+int h(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
+{
+    return absval(x2 - x1) + absval(y2 - y1);
+}
+
+/*
+ * estimate() - h(n) of A*: the Manhattan distance from (x,y) to the goal, or the ALT bound if that is larger
+ *              during an ALT search; both never overestimate, so neither does the larger one
+ */
+int estimate(SearchContext * ctx, unsigned int x, unsigned int y, coordinate goal)
+{
+    int manhattan = h(x, y, goal.x, goal.y);
+    if (ctx->GoalLandmarks == NULL) return manhattan;
+    int bound = landmarkBound(ctx->Map, ctx->GoalLandmarks, x, y);
+    return (bound > manhattan) ? bound : manhattan;
+}
+
+/*
+ * Astar() - "A* Search": Enqueue the A* successors of the current coordinate (sorted upon insertion)
+ *         - arguments: fringe (AstarFringe) to insert successors into, current position of robot, and g(n) or the current *           level - 1, goal (coordinate), which is needed to compute h(n)
+ */
+void Astar(SearchContext * ctx, AstarFringe * fringe, coordinate current, unsigned int g, coordinate goal)
+{
+    // Order doesn't matter
+    // Check if RIGHT successor is viable
+    bool cont = true;
+    if (current.x < (int)ctx->Map->Width - 1 && getTile(ctx, current.x + 1, current.y) >= QUEUED)
+    {
+        float f = g + estimate(ctx, current.x + 1, current.y, goal);
+        if (getTile(ctx, current.x + 1, current.y) == QUEUED)
+        {
+            // If queued, check to see if f from this current node is less than the stored f
+            // Find successor in List
+            if (getF(ctx, current.x + 1, current.y) <= f) cont = false;
+            else PROFILE_COUNT(PROFILE_REQUEUES); // Cheaper this way; queued again
+        }
+        if (cont)
+        {
+            InsertToAstarFringe(fringe, current.x + 1, current.y, f, g + 1);
+            setF(ctx, current.x + 1, current.y, f);
+            if(getTile(ctx, current.x + 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
+            {
+                setTile(ctx, current.x + 1, current.y, QUEUED);
+            }
+            // We MIGHT move from current tile to this tile
+            // Set tile's predecessor to the current tile
+            setPred(ctx, current.x + 1, current.y, current.x, current.y);
+        }
+    }
+    cont = true;
+    // Check LEFT
+    if (current.x > 0 && getTile(ctx, current.x - 1, current.y) >= QUEUED)
+    {
+        float f = g + estimate(ctx, current.x - 1, current.y, goal);
+        if (getTile(ctx, current.x - 1, current.y) == QUEUED)
+        {
+            // If queued, check to see if f from this current node is less than the stored f
+            // Find successor in List
+            if (getF(ctx, current.x - 1, current.y) <= f) cont = false;
+            else PROFILE_COUNT(PROFILE_REQUEUES); // Cheaper this way; queued again
+        }
+        if (cont)
+        {
+            InsertToAstarFringe(fringe, current.x - 1, current.y, f, g + 1);
+            setF(ctx, current.x - 1, current.y, f);
+            if(getTile(ctx, current.x - 1, current.y) != GOAL) // GOAL Must supercede other QUEUED
+            {
+                setTile(ctx, current.x - 1, current.y, QUEUED);
+            }
+            // We MIGHT move from current tile to this tile
+            // Set tile's predecessor to the current tile
+            setPred(ctx, current.x - 1, current.y, current.x, current.y);
+        }
+    }
+    cont = true;
+    // Check UP (but remember, in our grid system, up means lower y)
+    if (current.y > 0 && getTile(ctx, current.x, current.y - 1) >= QUEUED)
+    {
+        float f = g + estimate(ctx, current.x, current.y - 1, goal);
+        if (getTile(ctx, current.x, current.y - 1) == QUEUED)
+        {
+            // If queued, check to see if f from this current node is less than the stored f
+            // Find successor in List
+            if (getF(ctx, current.x, current.y - 1) <= f) cont = false;
+            else PROFILE_COUNT(PROFILE_REQUEUES); // Cheaper this way; queued again
+        }
+        if (cont)
+        {
+            InsertToAstarFringe(fringe, current.x, current.y - 1, f, g + 1);
+            setF(ctx, current.x, current.y - 1, f);
+            if(getTile(ctx, current.x, current.y - 1) != GOAL) // GOAL Must supercede other QUEUED
+            {
+                setTile(ctx, current.x, current.y - 1, QUEUED);
+            }
+            // We MIGHT move from current tile to this tile
+            // Set tile's predecessor to the current tile
+            setPred(ctx, current.x, current.y - 1, current.x, current.y);
+        }
+    }
+    // Check DOWN
+    cont = true;
+    if (current.y < (int)ctx->Map->Height - 1 && getTile(ctx, current.x, current.y + 1) >= QUEUED)
+    {
+        float f = g + estimate(ctx, current.x, current.y + 1, goal);
+        if (getTile(ctx, current.x, current.y + 1) == QUEUED)
+        {
+            // If queued, check to see if f from this current node is less than the stored f
+            // Find successor in List
+            if (getF(ctx, current.x, current.y + 1) <= f) cont = false;
+            else PROFILE_COUNT(PROFILE_REQUEUES); // Cheaper this way; queued again
+        }
+        if (cont)
+        {
+            InsertToAstarFringe(fringe, current.x, current.y + 1, f, g + 1);
+            setF(ctx, current.x, current.y + 1, f);
+            if(getTile(ctx, current.x, current.y + 1) != GOAL) // GOAL Must supercede other QUEUED
+            {
+                setTile(ctx, current.x, current.y + 1, QUEUED);
+            }
+            // We MIGHT move from current tile to this tile
+            // Set tile's predecessor to the current tile
+            setPred(ctx, current.x, current.y + 1, current.x, current.y);
+        }
+    }
+    return;
+}
+
+/*
+ * JPS() - "Jump Point Search": Enqueue the jump points reached from the current jump point (sorted upon insertion)
+ *       - a run only goes on in the directions a vertical-first shortest path through the current tile can take:
+ *         all 4 from the start; straight on or sideways after a vertical run; straight on or into a forced
+ *         neighbour after a horizontal run
+ *       - precomputed uses the map's JPS+ table instead of scanning tile by tile
+ */
+void JPS(SearchContext * ctx, AstarFringe * fringe, coordinate current, int g, coordinate goal, bool precomputed)
+{
+    if (current.x == ctx->Origin.x && current.y == ctx->Origin.y)
+    {
+        // Same relative order as BFS: Right, Left, Up, Down
+        jumpTo(ctx, fringe, current, g, goal, JUMP_RIGHT, precomputed);
+        jumpTo(ctx, fringe, current, g, goal, JUMP_LEFT, precomputed);
+        jumpTo(ctx, fringe, current, g, goal, JUMP_UP, precomputed);
+        jumpTo(ctx, fringe, current, g, goal, JUMP_DOWN, precomputed);
+        return;
+    }
+    coordinate p = getPred(ctx, current.x, current.y); // the tile we came through
+    int dx = current.x - p.x;
+    int dy = current.y - p.y;
+    if (dy == 0) // Came in horizontally
+    {
+        jumpTo(ctx, fringe, current, g, goal, (dx > 0) ? JUMP_RIGHT : JUMP_LEFT, precomputed);
+        if (isOpen(ctx->Map, current.x, current.y - 1) && !isOpen(ctx->Map, current.x - dx, current.y - 1))
+        {
+            jumpTo(ctx, fringe, current, g, goal, JUMP_UP, precomputed);
+        }
+        if (isOpen(ctx->Map, current.x, current.y + 1) && !isOpen(ctx->Map, current.x - dx, current.y + 1))
+        {
+            jumpTo(ctx, fringe, current, g, goal, JUMP_DOWN, precomputed);
+        }
+    }
+    else // Came in vertically
+    {
+        jumpTo(ctx, fringe, current, g, goal, JUMP_RIGHT, precomputed);
+        jumpTo(ctx, fringe, current, g, goal, JUMP_LEFT, precomputed);
+        jumpTo(ctx, fringe, current, g, goal, (dy > 0) ? JUMP_DOWN : JUMP_UP, precomputed);
+    }
+}
+
+/*
+ * jumpTo() - runs from the current jump point in the given JUMP_* direction and queues the jump point it stops at,
+ *            unless it has been explored or is already queued with a smaller or equal f(n)
+ */
+void jumpTo(SearchContext * ctx, AstarFringe * fringe, coordinate current, int g, coordinate goal, int direction, bool precomputed)
+{
+    int dx = (direction == JUMP_RIGHT) ? 1 : (direction == JUMP_LEFT) ? -1 : 0;
+    int dy = (direction == JUMP_DOWN) ? 1 : (direction == JUMP_UP) ? -1 : 0;
+    int steps;
+    if (precomputed) steps = jumpPrecomputed(ctx->Map, current.x, current.y, direction, goal);
+    else if (dx != 0) steps = jumpHorizontal(ctx->Map, current.x, current.y, dx, goal);
+    else steps = jumpVertical(ctx->Map, current.x, current.y, dy, goal);
+    if (steps == 0) return; // Ran into a wall
+    coordinate target;
+    target.x = current.x + steps * dx;
+    target.y = current.y + steps * dy;
+    unsigned int status = getTile(ctx, target.x, target.y);
+    if (status < QUEUED) return; // Explored already
+    int f = g + steps + h(target.x, target.y, goal.x, goal.y);
+    if ((status == QUEUED || status == GOAL) && getF(ctx, target.x, target.y) <= f) return;
+    InsertToAstarFringe(fringe, target.x, target.y, f, g + steps);
+    setF(ctx, target.x, target.y, f);
+    if (status != GOAL) // GOAL Must supercede other QUEUED
+    {
+        setTile(ctx, target.x, target.y, QUEUED);
+    }
+    // Only the first step back is stored; traceJumps() walks the rest of the run
+    setPred(ctx, target.x, target.y, target.x - dx, target.y - dy);
+    ctx->Jump[(size_t)target.y * ctx->Map->Width + target.x] = steps;
+}
+
+/*
+ * tracePreds() - pushes last and its predecessors back to the start of the search into path
+ */
+void tracePreds(SearchContext * ctx, coordinate last, Stack * path)
+{
+    // Push into the stack the final tile, which is the goal (also the current) tile
+    PushToStack(path, last.x, last.y);
+    while(1)
+    {
+        // Get predecessor of current top of stack
+        coordinate p = getPred(ctx, PeekStack(path)->x, PeekStack(path)->y);
+        if (p.x == -1 || p.y == -1) break;
+        PushToStack(path, p.x, p.y);
+    }
+}
+
+/*
+ * traceJumps() - pushes last and every tile back to the start of the search into path, walking each run between
+ *                two jump points tile by tile
+ *              - the tiles inside a run never get a predecessor of their own, since another run may have passed
+ *                over them first
+ */
+void traceJumps(SearchContext * ctx, coordinate last, Stack * path)
+{
+    coordinate c = last;
+    int t;
+    PushToStack(path, c.x, c.y);
+    while (c.x != ctx->Origin.x || c.y != ctx->Origin.y)
+    {
+        int steps = ctx->Jump[(size_t)c.y * ctx->Map->Width + c.x];
+        coordinate p = getPred(ctx, c.x, c.y);
+        int dx = p.x - c.x;
+        int dy = p.y - c.y;
+        for (t = 1; t <= steps; t++)
+        {
+            PushToStack(path, c.x + t * dx, c.y + t * dy);
+        }
+        c.x += steps * dx; // On to the parent jump point
+        c.y += steps * dy;
+    }
+}
+
+/*
+ * biBFS() - "Bidirectional BFS": grows one BFS from the start and one from the goal, a whole level at a time and
+ *           always on the side with the smaller frontier, until a tile is reached from both sides
+ *         - every tile within the levels done so far on both sides would have been reached by both already, so
+ *           the first tile found by both lies on a shortest path
+ *         - returns that tile, or (-1,-1) if a frontier runs out first; expanded nodes are added to expanded, and
+ *           peakFringe is raised to the most tiles both frontiers held at once if that's more
+ *         - it pays off when both frontiers can grow round: over random queries on input/1-6 it expands about a
+ *           quarter fewer tiles than BFS(); where walls channel both frontiers through the same corridors, the two
+ *           halves together cover as much as BFS() alone, or slightly more (input/6.txt's own query: 327182 vs
+ *           323173, input/2.txt's: 40686 vs 40397)
+ */
+coordinate biBFS(SearchContext * ctx, coordinate start, coordinate goal, int * expanded, unsigned int * peakFringe)
+{
+    // Same relative order as BFS: Right, Left, Up, Down
+    static const int dx[4] = {1, -1, 0, 0};
+    static const int dy[4] = {0, 0, -1, 1};
+    uint16_t * tiles[2] = {ctx->Tiles, ctx->BackTiles};
+    uint8_t * pred[2] = {ctx->Pred, ctx->BackPred};
+    int * g[2] = {ctx->F, ctx->BackF};
+    Queue * fringe[2];
+    coordinate root[2] = {start, goal};
+    coordinate meet = {-1, -1};
+    unsigned int W = ctx->Map->Width;
+    int side, level, d;
+    for (side = SEARCH_FORWARD; side <= SEARCH_BACKWARD; side++)
+    {
+        fringe[side] = CreateNewQueueInArena(ctx->Pool, 2 * (ctx->Map->Width + ctx->Map->Height));
+        setTileIn(ctx, tiles[side], root[side].x, root[side].y, QUEUED);
+        g[side][root[side].y * W + root[side].x] = 0;
+        Enqueue(fringe[side], root[side].x, root[side].y);
+        PROFILE_COUNT(PROFILE_PUSHES);
+    }
+    if (start.x == goal.x && start.y == goal.y) return start;
+    while (fringe[SEARCH_FORWARD]->Count > 0 && fringe[SEARCH_BACKWARD]->Count > 0)
+    {
+        unsigned int size = fringe[SEARCH_FORWARD]->Count + fringe[SEARCH_BACKWARD]->Count; // Largest between levels
+        if (size > *peakFringe) *peakFringe = size;
+        side = (fringe[SEARCH_BACKWARD]->Count < fringe[SEARCH_FORWARD]->Count) ? SEARCH_BACKWARD : SEARCH_FORWARD;
+        for (level = fringe[side]->Count; level > 0; level--)
+        {
+            coordinate u = Dequeue(fringe[side]);
+            PROFILE_COUNT(PROFILE_POPS);
+            setTileIn(ctx, tiles[side], u.x, u.y, EXPLORED);
+            (*expanded)++;
+            for (d = 0; d < 4; d++)
+            {
+                int x = u.x + dx[d];
+                int y = u.y + dy[d];
+                if (x < 0 || y < 0 || x >= (int)W || y >= (int)ctx->Map->Height) continue;
+                if (getTileIn(ctx, tiles[side], x, y) < UNEXPLORED) continue; // Blocked, or reached from this side already
+                setTileIn(ctx, tiles[side], x, y, QUEUED);
+                setPredIn(ctx, pred[side], x, y, u.x, u.y);
+                g[side][y * W + x] = g[side][u.y * W + u.x] + 1;
+                Enqueue(fringe[side], x, y);
+                PROFILE_COUNT(PROFILE_PUSHES);
+                unsigned int other = getTileIn(ctx, tiles[1 - side], x, y);
+                if (other == QUEUED || other == EXPLORED) // The frontiers touch
+                {
+                    meet.x = x;
+                    meet.y = y;
+                    return meet;
+                }
+            }
+        }
+    }
+    return meet; // No solution path
+}
+
+/*
+ * biAstar() - "Bidirectional A*": runs one A* from the start and one from the goal, each time expanding the side
+ *             whose fringe holds fewer tiles, and remembers the cheapest tile reached from both sides
+ *           - both sides share one balanced heuristic, half of h(n) to the goal minus h(n) to the start, so that
+ *             the two searches meet in the middle; with separate heuristics each side would cover most of what
+ *             plain A* covers before the stopping rule kicks in
+ *           - keys are doubled to stay integers: 2 g(n) + h(n, goal) - h(n, start) + h(start, goal) forward, and
+ *             the same with goal and start swapped backward; the search stops once the two smallest keys add up
+ *             to twice the cost of the cheapest path found plus h(start, goal), as nothing left can beat it then
+ *           - returns the tile where the cheapest path found crosses over, or (-1,-1) if there is none; expanded
+ *             nodes are added to expanded, and peakFringe is raised to the most tiles both fringes held at once if
+ *             that's more
+ *           - it usually expands more tiles than Astar(), not fewer: Astar() only expands tiles whose f(n) is below
+ *             the cost of the path, but this has to expand every tile that either balanced key puts below it, and
+ *             the balanced heuristic is weaker than h(n) anywhere off the straight line between start and goal.
+ *             It wins only when most of A*'s work is spent around the goal (input/3.txt's own query: 12873 vs
+ *             13835); elsewhere it expands 10-85% more (input/2.txt: 14231 vs 7766, input/6.txt: 304716 vs
+ *             267249, and half again as many over random queries on input/1-6)
+ */
+coordinate biAstar(SearchContext * ctx, int fringeType, coordinate start, coordinate goal, int * expanded,
+    unsigned int * peakFringe)
+{
+    // Same relative order as Astar(): Right, Left, Up, Down
+    static const int dx[4] = {1, -1, 0, 0};
+    static const int dy[4] = {0, 0, -1, 1};
+    uint16_t * tiles[2] = {ctx->Tiles, ctx->BackTiles};
+    uint8_t * pred[2] = {ctx->Pred, ctx->BackPred};
+    int * g[2] = {ctx->F, ctx->BackF}; // g(n) here, not f(n)
+    AstarFringe * fringe[2];
+    coordinate root[2] = {start, goal};
+    coordinate target[2] = {goal, start}; // what each side heads for
+    coordinate meet = {-1, -1};
+    unsigned int W = ctx->Map->Width;
+    int span = h(start.x, start.y, goal.x, goal.y); // keeps every key >= 0, by the triangle inequality
+    int best = INT_MAX; // cost of the cheapest path found so far
+    int side, d, gu;
+    for (side = SEARCH_FORWARD; side <= SEARCH_BACKWARD; side++)
+    {
+        fringe[side] = getAstarFringe(ctx, fringeType, side);
+        setTileIn(ctx, tiles[side], root[side].x, root[side].y, QUEUED);
+        g[side][root[side].y * W + root[side].x] = 0;
+        InsertToAstarFringe(fringe[side], root[side].x, root[side].y, 2 * span, 0);
+    }
+    if (start.x == goal.x && start.y == goal.y)
+    {
+        best = 0;
+        meet = start;
+    }
+    while (!IsAstarFringeEmpty(fringe[SEARCH_FORWARD]) && !IsAstarFringeEmpty(fringe[SEARCH_BACKWARD]))
+    {
+        int topForward = PeekAstarFringe(fringe[SEARCH_FORWARD]);
+        int topBackward = PeekAstarFringe(fringe[SEARCH_BACKWARD]);
+        if (best != INT_MAX && topForward + topBackward >= 2 * (best + span)) break; // Nothing left can beat it
+        // The side with fewer tiles queued; both keys are below the cost of any path that can still beat the best
+        side = (AstarFringeSize(fringe[SEARCH_BACKWARD]) < AstarFringeSize(fringe[SEARCH_FORWARD])) ? SEARCH_BACKWARD : SEARCH_FORWARD;
+        coordinate u = PopFromAstarFringe(fringe[side], &gu);
+        // The sorted list keeps stale duplicates around; skip them
+        if (getTileIn(ctx, tiles[side], u.x, u.y) == EXPLORED || gu > g[side][u.y * W + u.x]) continue;
+        setTileIn(ctx, tiles[side], u.x, u.y, EXPLORED);
+        (*expanded)++;
+        for (d = 0; d < 4; d++)
+        {
+            int x = u.x + dx[d];
+            int y = u.y + dy[d];
+            int ng = gu + 1;
+            if (x < 0 || y < 0 || x >= (int)W || y >= (int)ctx->Map->Height) continue;
+            unsigned int status = getTileIn(ctx, tiles[side], x, y);
+            if (status == BLOCKED || status == EXPLORED) continue;
+            if (status == QUEUED && g[side][y * W + x] <= ng) continue; // Already queued at least as cheaply
+            g[side][y * W + x] = ng;
+            setTileIn(ctx, tiles[side], x, y, QUEUED);
+            setPredIn(ctx, pred[side], x, y, u.x, u.y);
+            int key = 2 * ng + h(x, y, target[side].x, target[side].y) - h(x, y, root[side].x, root[side].y) + span;
+            InsertToAstarFringe(fringe[side], x, y, key, ng);
+            unsigned int size = AstarFringeSize(fringe[SEARCH_FORWARD]) + AstarFringeSize(fringe[SEARCH_BACKWARD]);
+            if (size > *peakFringe) *peakFringe = size;
+            unsigned int other = getTileIn(ctx, tiles[1 - side], x, y);
+            if ((other == QUEUED || other == EXPLORED) && ng + g[1 - side][y * W + x] < best)
+            {
+                best = ng + g[1 - side][y * W + x];
+                meet.x = x;
+                meet.y = y;
+            }
+        }
+    }
+    ClearAstarFringe(fringe[SEARCH_FORWARD]); // Ready for the next search
+    ClearAstarFringe(fringe[SEARCH_BACKWARD]);
+    return meet;
+}
+
+/*
+ * traceMeeting() - pushes the path of a bidirectional search into path, goal first and start on top: the backward
+ *                  half from the goal to meet, then meet, then the forward half back to the start
+ */
+void traceMeeting(SearchContext * ctx, coordinate meet, coordinate start, coordinate goal, Stack * path)
+{
+    Stack * back = CreateNewStackInArena(ctx->Pool); // the backward half, which comes out meet first
+    coordinate c = meet;
+    while (1)
+    {
+        c = getPredIn(ctx, ctx->BackPred, goal, c.x, c.y);
+        if (c.x == -1 || c.y == -1) break;
+        PushToStack(back, c.x, c.y);
+    }
+    while (back->Depth > 0)
+    {
+        c = PopFromStack(back);
+        PushToStack(path, c.x, c.y);
+    }
+    c = meet;
+    PushToStack(path, c.x, c.y);
+    while (1)
+    {
+        c = getPredIn(ctx, ctx->Pred, start, c.x, c.y);
+        if (c.x == -1 || c.y == -1) break;
+        PushToStack(path, c.x, c.y);
+    }
+}
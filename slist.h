@@ -6,6 +6,7 @@
 
 #pragma once
 #include "line.h"
+#include "arena.h"
 
 typedef struct Node
 {
@@ -20,11 +21,16 @@ typedef struct
 {
 	Node * Head;
 	Node * Tail;
+	Node * Spare; // popped nodes kept for reuse when the list lives in an Arena
+	unsigned int Count; // number of Nodes in the List, stale duplicates included
+	Arena * Pool; // where nodes and the List itself come from; NULL means malloc
 } SortedList;
 
 
 SortedList * CreateNewSortedList();
+SortedList * CreateNewSortedListInArena(Arena * pool);
 void AnnihilateSortedList(SortedList * targetList);
+void ClearSortedList(SortedList * targetList);
 Node * InsertToSortedList(SortedList * targetList, unsigned int x, unsigned int y, int f, int g);
 coordinate PopFromSortedList(SortedList * targetList);
 void SortedListUnderflow();
@@ -36,10 +42,23 @@ void SortedListUnderflow();
 // </summary>
 SortedList * CreateNewSortedList()
 {
-	SortedList * n = malloc(sizeof(SortedList));
+	return CreateNewSortedListInArena(NULL);
+}
+
+// <summary>
+// CreateNewSortedListInArena - same as CreateNewSortedList, but all nodes are drawn from the given Arena
+//                            - popped nodes are recycled, so the List never holds more than its peak size
+//                            - resetting the Arena frees the List; AnnihilateSortedList is then unnecessary
+// </summary>
+SortedList * CreateNewSortedListInArena(Arena * pool)
+{
+	SortedList * n = ArenaAlloc(pool, sizeof(SortedList));
 	// Initialize as empty
 	n->Head = NULL;
 	n->Tail = NULL;
+	n->Spare = NULL;
+	n->Count = 0;
+	n->Pool = pool;
 	return n;
 }
 
@@ -55,7 +74,20 @@ void AnnihilateSortedList(SortedList * targetList)
 		(void)PopFromSortedList(targetList); // Pop each node and discard data returned
 		// freeing up of memory used for each node is handled by the PopFromSortedList function
 	}
-	free(targetList);	// free up the empty list
+	ArenaFree(targetList->Pool, targetList);	// free up the empty list (spare nodes go with the Arena)
+	return;
+}
+
+// <summary>
+// ClearSortedList - pops every Node in the List, leaving it empty but still usable
+// </summary>
+void ClearSortedList(SortedList * targetList)
+{
+	while (targetList->Head != NULL)
+	{
+		(void)PopFromSortedList(targetList); // nodes go to Spare if the List lives in an Arena
+	}
+	targetList->Tail = NULL;
 	return;
 }
 
@@ -64,13 +96,22 @@ void AnnihilateSortedList(SortedList * targetList)
 // </summary>
 Node * InsertToSortedList(SortedList * targetList, unsigned int x, unsigned int y, int f, int g)
 {
-	Node * newNode = malloc(sizeof(Node)); // request space for new node
+	Node * newNode = targetList->Spare; // request space for new node, reusing a popped one if possible
+	if (newNode != NULL)
+	{
+		targetList->Spare = newNode->Next;
+	}
+	else
+	{
+		newNode = ArenaAlloc(targetList->Pool, sizeof(Node));
+	}
 	newNode->Data.x = x;
 	newNode->Data.y = y;
 	newNode->f = f;
 	newNode->g = g;
 	newNode->Prev = NULL;
 	newNode->Next = NULL;
+	targetList->Count++;
 	// find where to insert (look for a node with larger f)
 	if (targetList->Head == NULL)
 	{
@@ -132,7 +173,16 @@ coordinate PopFromSortedList(SortedList * targetList)
 		{
 			targetList->Head->Prev = NULL;
 		}
-		free(node);	// Free up memory
+		targetList->Count--;
+		if (targetList->Pool != NULL) // Free up memory
+		{
+			node->Next = targetList->Spare;
+			targetList->Spare = node;
+		}
+		else
+		{
+			free(node);
+		}
 		return data; // Return the 'salvaged Data'
 	}
 }
@@ -6,90 +6,117 @@
 
 #pragma once
 #include "line.h"
-
-typedef struct StackNode
-{
-	coordinate Data;
-	struct StackNode * Next;
-} StackNode;
+#include "arena.h"
 
 typedef struct
 {
-	StackNode * Top;
-	unsigned int Depth;
+	coordinate * Data; // contiguous array; Data[Depth - 1] is the top of the Stack
+	unsigned int Depth; // number of elements in the Stack
+	unsigned int Capacity; // number of slots allocated for Data
+	Arena * Pool; // where Data and the Stack itself come from; NULL means malloc
 } Stack;
 
+#define STACK_DEFAULT_CAPACITY 64
+
 
 Stack * CreateNewStack();
+Stack * CreateNewStackInArena(Arena * pool);
 void AnnihilateStack(Stack * targetStack);
-StackNode * PushToStack(Stack * targetStack, unsigned int x, unsigned int y);
+void ReserveStack(Stack * targetStack, unsigned int capacity);
+coordinate * PushToStack(Stack * targetStack, unsigned int x, unsigned int y);
 coordinate PopFromStack(Stack * targetStack);
+coordinate * PeekStack(Stack * targetStack);
 void StackUnderflow();
 void PrintStack(Stack * targetStack);
 
 // <summary>
 // CreateNewStack - allocates space for a new empty Stack and returns a pointer to that Stack
 //                - the pointer DOES NOT point to the top of the Stack
-//                - Members: Top - Top of Stack
+//                - Members: Data - elements, bottom first; Depth - number of elements
 //				  - The creator of the Stack has the implicit responsibility of freeing up the stack later
 // </summary>
 Stack * CreateNewStack()
 {
-	Stack * thenewstack = malloc(sizeof(Stack));
-	thenewstack->Top = NULL; // Initialize Stack as empty
-	thenewstack->Depth = 0;
+	return CreateNewStackInArena(NULL);
+}
+
+// <summary>
+// CreateNewStackInArena - same as CreateNewStack, but all memory is drawn from the given Arena
+//                       - resetting the Arena frees the Stack; AnnihilateStack is then unnecessary
+// </summary>
+Stack * CreateNewStackInArena(Arena * pool)
+{
+	Stack * thenewstack = ArenaAlloc(pool, sizeof(Stack));
+	thenewstack->Pool = pool;
+	thenewstack->Data = ArenaAlloc(pool, STACK_DEFAULT_CAPACITY * sizeof(coordinate));
+	thenewstack->Capacity = STACK_DEFAULT_CAPACITY;
+	thenewstack->Depth = 0; // Initialize Stack as empty
 	return thenewstack;
 }
 
 // <summary>
-// AnnihilateStack - goes through each Node in the Stack and pops them
-//                 - DOES NOT return the data in a Node; purely destructive
-//                 - also frees up the memory allocated for the stack itself
+// AnnihilateStack - frees up the element array and the memory allocated for the stack itself
+//                 - DOES NOT return the data in the Stack; purely destructive
 // </summary>
 void AnnihilateStack(Stack * targetStack)
 {
-	while (targetStack->Top != NULL) // Do while stack is not empty
-	{
-		(void)PopFromStack(targetStack); // Pop each node and discard data returned
-		// freeing up of memory used for each node is handled by the PopFromStack function
-	}
-	free(targetStack);	// free up the empty stack
+	ArenaFree(targetStack->Pool, targetStack->Data); // elements are stored inline, so there are no nodes to pop
+	ArenaFree(targetStack->Pool, targetStack);	// free up the stack
 	return;
 }
 
 // <summary>
-// PushToStack - inserts a new StackNode at the top of the Stack and moves the Top pointer
-//                accordingly.
+// ReserveStack - makes sure the Stack can hold at least 'capacity' elements without reallocating
 // </summary>
-StackNode * PushToStack(Stack * targetStack, unsigned int x, unsigned int y)
+void ReserveStack(Stack * targetStack, unsigned int capacity)
 {
-	StackNode * newNode = malloc(sizeof(StackNode)); // request space for new node
-	newNode->Data.x = x;
-	newNode->Data.y = y;
-	newNode->Next = targetStack->Top; // The new node points to the previous top and
-	targetStack->Top = newNode;      // becomes the new top
-	targetStack->Depth++; // Increment Depth
+	if (capacity <= targetStack->Capacity) return;
+	targetStack->Data = ArenaGrow(targetStack->Pool, targetStack->Data, targetStack->Capacity * sizeof(coordinate), capacity * sizeof(coordinate));
+	targetStack->Capacity = capacity;
 }
 
 // <summary>
-// PopFromStack - free ups a the topmost node and returns its contents
+// PushToStack - stores a new element at the top of the Stack, doubling the capacity if it is full
+//             - returns a pointer to the new element (valid until the next Push)
 // </summary>
-coordinate PopFromStack(Stack * targetStack)
+coordinate * PushToStack(Stack * targetStack, unsigned int x, unsigned int y)
 {
-	if (targetStack->Top == NULL)
+	if (targetStack->Depth == targetStack->Capacity)
 	{
-		StackUnderflow(); // Stack is empty; Call UNDERFLOW
+		ReserveStack(targetStack, targetStack->Capacity * 2);
 	}
-	else
+	coordinate * newNode = &(targetStack->Data[targetStack->Depth]);
+	newNode->x = x;
+	newNode->y = y;
+	targetStack->Depth++; // Increment Depth; the new element becomes the new top
+	return newNode;
+}
+
+// <summary>
+// PopFromStack - removes the topmost element and returns its contents
+// </summary>
+coordinate PopFromStack(Stack * targetStack)
+{
+	coordinate data;
+	if (targetStack->Depth == 0)
 	{
-		StackNode * node = targetStack->Top; // Get the Top node
-		coordinate data = node->Data; // Salvage Data
-		targetStack->Top = node->Next;	 // Get Next node, which becomes the new top
-										// if Next == NULL, then the Stack is automatically empty
-		free(node);	// Free up memory
-		targetStack->Depth--; // Decrement depth
-		return data; // Return the 'salvaged Data'
+		StackUnderflow(); // Stack is empty; Call UNDERFLOW
+		data.x = -1;
+		data.y = -1;
+		return data;
 	}
+	targetStack->Depth--; // Decrement depth
+	data = targetStack->Data[targetStack->Depth]; // Salvage Data
+	return data; // Return the 'salvaged Data'
+}
+
+// <summary>
+// PeekStack - returns a pointer to the topmost element w/out popping it, or NULL if the Stack is empty
+// </summary>
+coordinate * PeekStack(Stack * targetStack)
+{
+	if (targetStack->Depth == 0) return NULL;
+	return &(targetStack->Data[targetStack->Depth - 1]);
 }
 
 // <summary>
@@ -104,15 +131,15 @@ void StackUnderflow()
 }
 
 // <summary>
-// PrintStack - goes through every node in the Stack, starting from the Top, and prints the contents of each
+// PrintStack - goes through every element in the Stack, starting from the Top, and prints each one
 // </summary>
 void PrintStack(Stack * targetStack)
 {
-	StackNode * node = targetStack->Top;
-	while (node != NULL)
+	unsigned int i = targetStack->Depth;
+	while (i > 0)
 	{
-		printf("(%d, %d) ", node->Data.x, node->Data.y); // Each character is separated by a <space>
-		node = node->Next;
+		i--;
+		printf("(%d, %d) ", targetStack->Data[i].x, targetStack->Data[i].y); // Each character is separated by a <space>
 	}
 	return;
 }
@@ -0,0 +1,514 @@
+#pragma once
+#include "line.h"
+#include "grid.h"
+#include "arena.h"
+#include "stack.h"
+#include "fringe.h"
+
+/*  VISIBILITY GRAPH OVER THE POLYGONS' CORNERS
+ *  Without the grid, a shortest path between two points among polygons is a chain of straight lines that
+ *  only bends at convex corners of the polygons, and only where the line wraps around the corner (is tangent
+ *  to it). So the corners are the nodes of a graph, two of them are joined if they see each other along a line
+ *  tangent to both, and a query joins the start and the goal to the corners they see and runs A* over a few
+ *  hundred nodes instead of every tile. The result is a list of waypoints at any angle, not a chain of tiles.
+ *  Whether a line is clear is decided on the exact polygons: it may touch them and run along their edges but
+ *  never cross an edge or pass through the inside of a polygon. Only the edges that share a cell of a coarse
+ *  spatial index with the line are tested, so a test costs about the number of edges near the line.
+ */
+
+#define VIS_CELL 32 // side of a cell of the spatial index, in tiles
+#define VIS_SCALE 1024 // A* keys are f(n) in 1/VIS_SCALE of a tile, which bounds how far from shortest a path is
+
+struct VisibilityGraph
+{
+    unsigned int VertexCount; // every corner of every polygon
+    unsigned int NodeCount; // corners a shortest path may bend at: convex, and inside the map
+    unsigned int EdgeCount;
+    unsigned int IndexWidth; // cells of the spatial index across
+    unsigned int IndexHeight; // cells of the spatial index down
+    coordinate * Vertex; // same order as the Grid's Vertices; polygon edge v runs from Vertex[v] to Vertex[Next[v]]
+    int32_t * Prev; // the corners before and after each corner, oriented so that the inside of the polygon is
+    int32_t * Next; // on the left going from Prev[v] through v to Next[v]
+    int32_t * NodeVertex; // NodeVertex[node] = corner of that node
+    int32_t * EdgeFirst; // edges of node n are EdgeFirst[n] .. EdgeFirst[n + 1] - 1
+    int32_t * EdgeTo; // node at the other end of each edge
+    float * EdgeLength; // straight-line length of each edge
+    int32_t * CellFirst; // polygon edges near index cell c are CellEdge[CellFirst[c]] .. CellEdge[CellFirst[c + 1] - 1]
+    int32_t * CellEdge;
+    uint8_t * Solid; // Solid[v] = 1 if the polygon of corner v has an inside, 0 if it is flat (a wall)
+}; // The visibility graph; one block of memory, so free() on it frees everything
+typedef struct VisibilityGraph VisibilityGraph;
+
+bool reserveVisibility(Grid * grid);
+double visibilitySearch(Grid * grid, Arena * pool, coordinate start, coordinate goal, Stack * path, int * expanded,
+    unsigned int * peakFringe);
+bool visible(VisibilityGraph * vis, coordinate p, coordinate q, int pv, int qv, uint32_t * seen, uint32_t stamp, int32_t * cover);
+unsigned int coverCells(VisibilityGraph * vis, coordinate p, coordinate q, int32_t * cover);
+bool between(coordinate a, coordinate b, coordinate c);
+bool insideCorner(VisibilityGraph * vis, int v, long long dx, long long dy);
+bool tangentAt(VisibilityGraph * vis, int v, long long dx, long long dy);
+long long orientation(coordinate a, coordinate b, coordinate c);
+double straightDistance(coordinate a, coordinate b);
+void relaxVisible(AstarFringe * fringe, double * g, int * parent, uint8_t * closed, int u, int v, double ng, double hv);
+
+/*
+ * reserveVisibility() - builds the visibility graph of the grid's polygons if it isn't there yet; returns false if
+ *                       there isn't enough memory
+ *                     - one visibility test per pair of nodes that could be tangent at both ends, so
+ *                       O(nodes^2 * edges near a line)
+ */
+bool reserveVisibility(Grid * grid)
+{
+    unsigned int V = grid->PolygonCount > 0 ? grid->PolygonEnds[grid->PolygonCount - 1] : 0;
+    unsigned int IW = (grid->Width + VIS_CELL - 1) / VIS_CELL;
+    unsigned int IH = (grid->Height + VIS_CELL - 1) / VIS_CELL;
+    unsigned int p, v, c, i, j, k, first, nodes = 0;
+    size_t covered = 0, edges = 0, capacity = 1024;
+    if (grid->Visibility != NULL) return true;
+    // Everything but the edges and the index can be sized from the corners; those are counted first, into a
+    // scratch graph that points at temporary arrays, and copied into the final block at the end
+    VisibilityGraph scratch;
+    scratch.VertexCount = V;
+    scratch.IndexWidth = IW;
+    scratch.IndexHeight = IH;
+    scratch.Vertex = grid->Vertices;
+    scratch.Prev = malloc((V + 1) * sizeof(int32_t));
+    scratch.Next = malloc((V + 1) * sizeof(int32_t));
+    scratch.Solid = malloc(V + 1);
+    scratch.NodeVertex = malloc((V + 1) * sizeof(int32_t));
+    scratch.CellFirst = calloc((size_t)IW * IH + 1, sizeof(int32_t));
+    int32_t * cover = malloc(((size_t)IW * IH + 1) * sizeof(int32_t));
+    uint32_t * seen = calloc(V + 1, sizeof(uint32_t));
+    int32_t * pairs = malloc(capacity * 2 * sizeof(int32_t)); // both ends of every edge found
+    if (scratch.Prev == NULL || scratch.Next == NULL || scratch.Solid == NULL || scratch.NodeVertex == NULL
+        || scratch.CellFirst == NULL || cover == NULL || seen == NULL || pairs == NULL)
+    {
+        free(scratch.Prev);
+        free(scratch.Next);
+        free(scratch.Solid);
+        free(scratch.NodeVertex);
+        free(scratch.CellFirst);
+        free(cover);
+        free(seen);
+        free(pairs);
+        return false;
+    }
+    // Orient every polygon so that its inside is on the left, and pick the corners a path can bend at
+    for (p = 0, first = 0; p < grid->PolygonCount; first = grid->PolygonEnds[p++])
+    {
+        unsigned int end = grid->PolygonEnds[p];
+        long long area = 0;
+        for (v = first; v < end; v++)
+        {
+            coordinate a = grid->Vertices[v];
+            coordinate b = grid->Vertices[(v + 1 < end) ? v + 1 : first];
+            area += (long long)a.x * b.y - (long long)b.x * a.y;
+        }
+        for (v = first; v < end; v++)
+        {
+            int32_t before = (v > first) ? v - 1 : end - 1;
+            int32_t after = (v + 1 < end) ? v + 1 : first;
+            scratch.Prev[v] = (area >= 0) ? before : after;
+            scratch.Next[v] = (area >= 0) ? after : before;
+            scratch.Solid[v] = (area != 0);
+        }
+        for (v = first; v < end; v++)
+        {
+            coordinate a = grid->Vertices[scratch.Prev[v]], b = grid->Vertices[scratch.Next[v]], o = grid->Vertices[v];
+            long long turn = orientation(a, o, b);
+            if (o.x < 0 || o.y < 0 || o.x >= (int)grid->Width || o.y >= (int)grid->Height) continue;
+            if (scratch.Solid[v] && turn <= 0) continue; // A path never bends around a flat or reflex corner
+            scratch.NodeVertex[nodes++] = v;
+        }
+    }
+    scratch.NodeCount = nodes;
+    // Spatial index: count the edges near each cell, turn the counts into offsets, then fill them in
+    for (v = 0; v < V; v++)
+    {
+        unsigned int n = coverCells(&scratch, grid->Vertices[v], grid->Vertices[scratch.Next[v]], cover);
+        for (c = 0; c < n; c++)
+        {
+            scratch.CellFirst[cover[c] + 1]++;
+        }
+        covered += n;
+    }
+    for (c = 0; c < IW * IH; c++)
+    {
+        scratch.CellFirst[c + 1] += scratch.CellFirst[c];
+    }
+    scratch.CellEdge = malloc((covered + 1) * sizeof(int32_t));
+    int32_t * fill = malloc(((size_t)IW * IH + 1) * sizeof(int32_t));
+    if (scratch.CellEdge != NULL && fill != NULL)
+    {
+        memcpy(fill, scratch.CellFirst, ((size_t)IW * IH + 1) * sizeof(int32_t));
+        for (v = 0; v < V; v++)
+        {
+            unsigned int n = coverCells(&scratch, grid->Vertices[v], grid->Vertices[scratch.Next[v]], cover);
+            for (c = 0; c < n; c++)
+            {
+                scratch.CellEdge[fill[cover[c]]++] = v;
+            }
+        }
+    }
+    free(fill);
+    // Edges: every pair of nodes that is tangent at both ends and can see each other
+    uint32_t stamp = 0;
+    for (i = 0; i < nodes && scratch.CellEdge != NULL && pairs != NULL; i++)
+    {
+        int a = scratch.NodeVertex[i];
+        for (j = i + 1; j < nodes; j++)
+        {
+            int b = scratch.NodeVertex[j];
+            long long dx = grid->Vertices[b].x - grid->Vertices[a].x;
+            long long dy = grid->Vertices[b].y - grid->Vertices[a].y;
+            if (!tangentAt(&scratch, a, dx, dy) || !tangentAt(&scratch, b, dx, dy)) continue;
+            if (!visible(&scratch, grid->Vertices[a], grid->Vertices[b], a, b, seen, ++stamp, cover)) continue;
+            if (edges == capacity)
+            {
+                capacity *= 2;
+                int32_t * grown = realloc(pairs, capacity * 2 * sizeof(int32_t));
+                if (grown == NULL) free(pairs);
+                pairs = grown;
+                if (pairs == NULL) break;
+            }
+            pairs[2 * edges] = i;
+            pairs[2 * edges + 1] = j;
+            edges++;
+        }
+    }
+    // Pack it all into one block: the corners and edges first, then the index, the flags last
+    VisibilityGraph * vis = NULL;
+    if (scratch.CellEdge != NULL && pairs != NULL)
+    {
+        size_t bytes = sizeof(VisibilityGraph) + V * sizeof(coordinate)
+            + (2 * V + nodes + (nodes + 1) + 4 * edges + ((size_t)IW * IH + 1) + covered) * sizeof(int32_t) + V;
+        vis = AllocateAligned(bytes);
+    }
+    if (vis != NULL)
+    {
+        *vis = scratch;
+        vis->EdgeCount = 2 * edges; // each pair goes both ways
+        vis->Vertex = (coordinate *)(vis + 1);
+        vis->Prev = (int32_t *)(vis->Vertex + V);
+        vis->Next = vis->Prev + V;
+        vis->NodeVertex = vis->Next + V;
+        vis->EdgeFirst = vis->NodeVertex + nodes;
+        vis->EdgeTo = vis->EdgeFirst + nodes + 1;
+        vis->EdgeLength = (float *)(vis->EdgeTo + 2 * edges);
+        vis->CellFirst = (int32_t *)(vis->EdgeLength + 2 * edges);
+        vis->CellEdge = vis->CellFirst + IW * IH + 1;
+        vis->Solid = (uint8_t *)(vis->CellEdge + covered);
+        if (V > 0)
+        {
+            memcpy(vis->Vertex, grid->Vertices, V * sizeof(coordinate));
+            memcpy(vis->Prev, scratch.Prev, V * sizeof(int32_t));
+            memcpy(vis->Next, scratch.Next, V * sizeof(int32_t));
+            memcpy(vis->Solid, scratch.Solid, V);
+        }
+        if (nodes > 0) memcpy(vis->NodeVertex, scratch.NodeVertex, nodes * sizeof(int32_t));
+        memcpy(vis->CellFirst, scratch.CellFirst, ((size_t)IW * IH + 1) * sizeof(int32_t));
+        if (covered > 0) memcpy(vis->CellEdge, scratch.CellEdge, covered * sizeof(int32_t));
+        // Edges by node: count, turn the counts into offsets, then fill them in both ways
+        for (i = 0; i <= nodes; i++)
+        {
+            vis->EdgeFirst[i] = 0;
+        }
+        for (k = 0; k < edges; k++)
+        {
+            vis->EdgeFirst[pairs[2 * k] + 1]++;
+            vis->EdgeFirst[pairs[2 * k + 1] + 1]++;
+        }
+        for (i = 0; i < nodes; i++)
+        {
+            vis->EdgeFirst[i + 1] += vis->EdgeFirst[i];
+        }
+        int32_t * slot = cover; // next free edge of each node; the cover buffer does if it is big enough
+        if ((size_t)IW * IH + 1 < nodes) slot = malloc(nodes * sizeof(int32_t));
+        if (slot != NULL)
+        {
+            for (i = 0; i < nodes; i++)
+            {
+                slot[i] = vis->EdgeFirst[i];
+            }
+            for (k = 0; k < edges; k++)
+            {
+                int a = pairs[2 * k], b = pairs[2 * k + 1];
+                float length = straightDistance(vis->Vertex[vis->NodeVertex[a]], vis->Vertex[vis->NodeVertex[b]]);
+                vis->EdgeTo[slot[a]] = b;
+                vis->EdgeLength[slot[a]++] = length;
+                vis->EdgeTo[slot[b]] = a;
+                vis->EdgeLength[slot[b]++] = length;
+            }
+            if (slot != cover) free(slot);
+        }
+        else
+        {
+            free(vis);
+            vis = NULL;
+        }
+    }
+    free(scratch.Prev);
+    free(scratch.Next);
+    free(scratch.Solid);
+    free(scratch.NodeVertex);
+    free(scratch.CellFirst);
+    free(scratch.CellEdge);
+    free(cover);
+    free(seen);
+    free(pairs);
+    grid->Visibility = vis;
+    return vis != NULL;
+}
+
+/*
+ * visibilitySearch() - answers a query with the grid's visibility graph (see reserveVisibility()) and pushes the
+ *                      waypoints into path, goal first and start on top; returns the length of the path, or -1,
+ *                      leaving path as it was, if there is none
+ *                    - the start is joined to every node it sees, and a node to the goal once it is expanded
+ *                    - like the other strategies, a goal on a blocked tile is never reached
+ *                    - polygons are solid here, while the grid only blocks their outlines; a start or goal inside a
+ *                      polygon can only be joined to a point inside the same polygon, in a straight line, so from
+ *                      anywhere else (its outline included) there is no path to it
+ *                    - scratch memory comes from pool, and expanded nodes are added to expanded; peakFringe is
+ *                      raised to the most nodes the fringe held at once if that's more
+ */
+double visibilitySearch(Grid * grid, Arena * pool, coordinate start, coordinate goal, Stack * path, int * expanded,
+    unsigned int * peakFringe)
+{
+    VisibilityGraph * vis = grid->Visibility;
+    int N = vis->NodeCount;
+    int S = N; // the start and the goal join the graph as two extra nodes
+    int T = N + 1;
+    int i, e;
+    uint32_t stamp = 0;
+    if (grid->Blocked[(size_t)goal.y * grid->Width + goal.x]) return -1;
+    uint32_t * seen = ArenaAlloc(pool, (vis->VertexCount + 1) * sizeof(uint32_t));
+    int32_t * cover = ArenaAlloc(pool, ((size_t)vis->IndexWidth * vis->IndexHeight + 1) * sizeof(int32_t));
+    memset(seen, 0, (vis->VertexCount + 1) * sizeof(uint32_t));
+    if (start.x == goal.x && start.y == goal.y)
+    {
+        PushToStack(path, goal.x, goal.y);
+        return 0;
+    }
+    (*expanded)++;
+    if (visible(vis, start, goal, -1, -1, seen, ++stamp, cover)) // In plain sight; no need for the graph
+    {
+        PushToStack(path, goal.x, goal.y);
+        PushToStack(path, start.x, start.y);
+        return straightDistance(start, goal);
+    }
+
+    // A* on the visibility graph
+    double * g = ArenaAlloc(pool, (N + 2) * sizeof(double));
+    int * parent = ArenaAlloc(pool, (N + 2) * sizeof(int));
+    uint8_t * closed = ArenaAlloc(pool, N + 2);
+    for (i = 0; i < N + 2; i++)
+    {
+        g[i] = INFINITY;
+        closed[i] = 0;
+    }
+    // Keys are lengths in fixed point; a heap, since they are too spread out for buckets
+    AstarFringe * fringe = CreateNewAstarFringeInArena(pool, FRINGE_HEAP, N + 2, 1); // x is the node number
+    g[S] = 0;
+    closed[S] = 1;
+    for (i = 0; i < N; i++) // The start leads to every node it sees
+    {
+        int v = vis->NodeVertex[i];
+        coordinate q = vis->Vertex[v];
+        if (!tangentAt(vis, v, q.x - start.x, q.y - start.y)) continue;
+        if (!visible(vis, start, q, -1, v, seen, ++stamp, cover)) continue;
+        relaxVisible(fringe, g, parent, closed, S, i, straightDistance(start, q), straightDistance(q, goal));
+    }
+    bool found = false;
+    int ignored;
+    while (!IsAstarFringeEmpty(fringe))
+    {
+        int u = PopFromAstarFringe(fringe, &ignored).x;
+        if (closed[u]) continue;
+        closed[u] = 1;
+        (*expanded)++;
+        if (u == T)
+        {
+            found = true;
+            break;
+        }
+        int uv = vis->NodeVertex[u];
+        coordinate p = vis->Vertex[uv];
+        for (e = vis->EdgeFirst[u]; e < vis->EdgeFirst[u + 1]; e++)
+        {
+            int v = vis->EdgeTo[e];
+            relaxVisible(fringe, g, parent, closed, u, v, g[u] + vis->EdgeLength[e], straightDistance(vis->Vertex[vis->NodeVertex[v]], goal));
+        }
+        if (tangentAt(vis, uv, goal.x - p.x, goal.y - p.y) && visible(vis, p, goal, uv, -1, seen, ++stamp, cover))
+        {
+            relaxVisible(fringe, g, parent, closed, u, T, g[u] + straightDistance(p, goal), 0);
+        }
+    }
+    if (fringe->Peak > *peakFringe) *peakFringe = fringe->Peak;
+    if (!found) return -1; // No solution path
+    PROFILE_START(traced);
+    PushToStack(path, goal.x, goal.y);
+    for (i = parent[T]; i != S; i = parent[i])
+    {
+        coordinate q = vis->Vertex[vis->NodeVertex[i]];
+        PushToStack(path, q.x, q.y);
+    }
+    PushToStack(path, start.x, start.y);
+    PROFILE_STOP(traced, PROFILE_PATH);
+    return g[T];
+}
+
+/*
+ * relaxVisible() - offers node v a way through node u of length ng; if that is shorter than what v has, v takes it and
+ *                  is queued with f = ng + hv
+ */
+void relaxVisible(AstarFringe * fringe, double * g, int * parent, uint8_t * closed, int u, int v, double ng, double hv)
+{
+    if (closed[v] || ng >= g[v]) return;
+    g[v] = ng;
+    parent[v] = u;
+    InsertToAstarFringe(fringe, v, 0, (int)((ng + hv) * VIS_SCALE), 0);
+}
+
+/*
+ * visible() - true if the line from p to q stays clear of the inside of every polygon: it may touch them and run
+ *             along their edges, but not cross an edge, go into a polygon at a corner, or leave an edge it starts or
+ *             ends on (such as a corner of another polygon that sits on it) for the inside
+ *           - a line with both ends inside the same polygon may stay inside it; it can't get out without crossing
+ *           - pv and qv are the corners p and q are, or -1 for points that aren't corners
+ *           - seen and stamp keep an edge near several cells of the line from being tested more than once: an edge
+ *             is skipped if seen[edge] == stamp, so every test needs a new stamp; cover is scratch for coverCells()
+ */
+bool visible(VisibilityGraph * vis, coordinate p, coordinate q, int pv, int qv, uint32_t * seen, uint32_t stamp, int32_t * cover)
+{
+    unsigned int n, c;
+    int k;
+    if (p.x == q.x && p.y == q.y) return true; // Every point sees itself
+    if (pv >= 0 && insideCorner(vis, pv, q.x - p.x, q.y - p.y)) return false;
+    if (qv >= 0 && insideCorner(vis, qv, p.x - q.x, p.y - q.y)) return false;
+    n = coverCells(vis, p, q, cover);
+    for (c = 0; c < n; c++)
+    {
+        for (k = vis->CellFirst[cover[c]]; k < vis->CellFirst[cover[c] + 1]; k++)
+        {
+            int edge = vis->CellEdge[k];
+            if (seen[edge] == stamp) continue;
+            seen[edge] = stamp;
+            coordinate a = vis->Vertex[edge];
+            coordinate b = vis->Vertex[vis->Next[edge]];
+            long long o1 = orientation(p, q, a), o2 = orientation(p, q, b);
+            long long o3 = orientation(a, b, p), o4 = orientation(a, b, q);
+            if (((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0)) && ((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0))) return false;
+            // An end on the edge itself, between its corners: the first step from it must not be to the left,
+            // where the inside is
+            if (vis->Solid[edge] && o3 == 0 && o4 > 0 && between(a, b, p)) return false;
+            if (vis->Solid[edge] && o4 == 0 && o3 > 0 && between(a, b, q)) return false;
+            // The line may also pass through a corner, which is only fine if it stays outside on both sides of it
+            if (o1 == 0 && (a.x - p.x) * (long long)(q.x - p.x) + (a.y - p.y) * (long long)(q.y - p.y) >= 0
+                && (a.x - q.x) * (long long)(p.x - q.x) + (a.y - q.y) * (long long)(p.y - q.y) >= 0)
+            {
+                if ((a.x != p.x || a.y != p.y) && insideCorner(vis, edge, p.x - a.x, p.y - a.y)) return false;
+                if ((a.x != q.x || a.y != q.y) && insideCorner(vis, edge, q.x - a.x, q.y - a.y)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * coverCells() - writes the index cells the line from p to q may pass through into cover and returns how many
+ *                there are; every point of the line is inside one of them, and points outside the map count as
+ *                inside the nearest cell
+ *              - one column of cells at a time: the cells from the lowest to the highest y of the line in it
+ */
+unsigned int coverCells(VisibilityGraph * vis, coordinate p, coordinate q, int32_t * cover)
+{
+    int IW = vis->IndexWidth, IH = vis->IndexHeight;
+    double x0 = (p.x < q.x) ? p.x : q.x, x1 = (p.x < q.x) ? q.x : p.x;
+    int c0 = (int)floor(x0 / VIS_CELL), c1 = (int)floor(x1 / VIS_CELL);
+    int cx, cy;
+    unsigned int n = 0;
+    if (c0 < 0) c0 = 0;
+    if (c1 > IW - 1) c1 = IW - 1;
+    if (c0 > IW - 1) c0 = IW - 1; // All of it beyond the right edge
+    if (c1 < 0) c1 = 0; // ... or the left
+    for (cx = c0; cx <= c1; cx++)
+    {
+        // The part of the line inside this column (the first and last columns also take what is beyond the map)
+        double from = (cx == c0) ? x0 : cx * (double)VIS_CELL;
+        double to = (cx == c1) ? x1 : (cx + 1) * (double)VIS_CELL;
+        double ya, yb;
+        if (p.x == q.x)
+        {
+            ya = p.y;
+            yb = q.y;
+        }
+        else
+        {
+            ya = p.y + (from - p.x) * (q.y - p.y) / (q.x - p.x);
+            yb = p.y + (to - p.x) * (q.y - p.y) / (q.x - p.x);
+        }
+        // A little slack on both sides, so that rounding never drops the cell a point is in
+        int r0 = (int)floor(((ya < yb) ? ya : yb) / VIS_CELL - 1e-9);
+        int r1 = (int)floor(((ya < yb) ? yb : ya) / VIS_CELL + 1e-9);
+        if (r0 < 0) r0 = 0;
+        if (r1 > IH - 1) r1 = IH - 1;
+        if (r0 > IH - 1) r0 = IH - 1;
+        if (r1 < 0) r1 = 0;
+        for (cy = r0; cy <= r1; cy++)
+        {
+            cover[n++] = cy * IW + cx;
+        }
+    }
+    return n;
+}
+
+/*
+ * between() - true if c, on the line through a and b, lies strictly between them
+ */
+bool between(coordinate a, coordinate b, coordinate c)
+{
+    return (c.x - a.x) * (long long)(b.x - a.x) + (c.y - a.y) * (long long)(b.y - a.y) > 0
+        && (c.x - b.x) * (long long)(a.x - b.x) + (c.y - b.y) * (long long)(a.y - b.y) > 0;
+}
+
+/*
+ * insideCorner() - true if going from corner v in direction (dx,dy) leads straight into the inside of its polygon
+ */
+bool insideCorner(VisibilityGraph * vis, int v, long long dx, long long dy)
+{
+    if (!vis->Solid[v]) return false; // A flat polygon has no inside
+    coordinate a = vis->Vertex[vis->Prev[v]], o = vis->Vertex[v], b = vis->Vertex[vis->Next[v]];
+    long long left1 = (o.x - a.x) * dy - (o.y - a.y) * dx; // > 0 if (dx,dy) is left of the edge coming in
+    long long left2 = (b.x - o.x) * dy - (b.y - o.y) * dx; // > 0 if it is left of the edge going out
+    if (orientation(a, o, b) >= 0) return left1 > 0 && left2 > 0; // Convex corner: the inside is left of both
+    return left1 > 0 || left2 > 0; // Reflex corner: left of either
+}
+
+/*
+ * tangentAt() - true if the line through corner v in direction (dx,dy) has both of its neighbouring corners on the
+ *               same side, i.e., a path along it could bend at v without cutting into the polygon
+ */
+bool tangentAt(VisibilityGraph * vis, int v, long long dx, long long dy)
+{
+    coordinate a = vis->Vertex[vis->Prev[v]], o = vis->Vertex[v], b = vis->Vertex[vis->Next[v]];
+    long long sa = dx * (a.y - o.y) - dy * (a.x - o.x);
+    long long sb = dx * (b.y - o.y) - dy * (b.x - o.x);
+    return !((sa > 0 && sb < 0) || (sa < 0 && sb > 0));
+}
+
+/*
+ * orientation() - > 0 if a, b, c turn left, < 0 if they turn right, 0 if they are on one line; exact
+ */
+long long orientation(coordinate a, coordinate b, coordinate c)
+{
+    return (long long)(b.x - a.x) * (c.y - a.y) - (long long)(b.y - a.y) * (c.x - a.x);
+}
+
+/*
+ * straightDistance() - straight-line distance between two points
+ */
+double straightDistance(coordinate a, coordinate b)
+{
+    return sqrt((double)(b.x - a.x) * (b.x - a.x) + (double)(b.y - a.y) * (b.y - a.y));
+}